@@ -1,3 +1,8 @@
+// 每个线程运行自己的ImGuiContext，与imgui_ex_win32.h中的定义保持一致
+struct ImGuiContext;
+thread_local ImGuiContext* gs_imgui_context = nullptr;
+#define GImGui gs_imgui_context
+
 #include <imgui/imgui.cpp>
 #include <imgui/imgui_draw.cpp>
 #include <imgui/imgui_tables.cpp>
@@ -7,31 +12,119 @@
 #include <imgui/backends/imgui_impl_win32.cpp>
 
 #include <d3d11.h>
+#include <d3d11_4.h>
+#include <dxgi.h>
 #pragma comment(lib, "D3D11.lib")
 
 #define IMGUI_EX_CPP
 #include <imgui_ex/imgui_ex_win32.h>
 
+#include <memory>
+
+#ifdef IMGUI_EX_COUNT_NEW
+// 替换全局operator new并计数，供BenchmarkWidgetPool等零分配检查使用；IMGUI_EX_COUNT_NEW需要对整个程序定义
+void* operator new(size_t size)
+{
+    ImGuiEx::internal::NewCount()++;
+    if (void* ptr = malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+#endif
+
 // Dear ImGui: standalone example application for DirectX 11
 // If you are new to Dear ImGui, read documentation from the docs/ folder + read the top of imgui.cpp.
 // Read online: https://github.com/ocornut/imgui/tree/master/docs
 
 #include <tchar.h>
 
-static bool gs_exit_application = false;
+/*
+* 顶层界面
+* 每个Host拥有自己的窗口、交换链和ImGuiContext，帧循环运行在各自的线程中
+* 设备和字体图集在所有Host之间共享，立即上下文的使用由gs_render_mutex保护
+*/
+struct Host {
+    std::string name;
+    std::string ini_filename;
+    std::function<void()> init;
+    std::function<void()> update;
+    std::function<void()> exit;
+
+    HWND hwnd;
+    IDXGISwapChain* swap_chain;
+    ID3D11RenderTargetView* render_target_view;
+    UINT resize_width;
+    UINT resize_height;
+    ImGuiContext* context;
+    bool exit_application;
+
+    std::thread thread;
+};
+
+static std::vector<std::unique_ptr<Host>> gs_hosts;
+static std::mutex gs_hosts_mutex;
+static thread_local Host* gs_current_host = nullptr;
+static std::atomic<bool> gs_quit(false);
+
+static std::mutex gs_render_mutex;
+static ImFontAtlas* gs_font_atlas = nullptr;
+static ImTextureID gs_font_texture = nullptr;
+
+// 共享图集中init可能修改的部分，用于检查非主界面的init没有修改图集
+struct FontAtlasState {
+    int font_count;
+    int config_count;
+    int tex_width;
+    int tex_height;
+    ImTextureID tex_id;
+    const void* pixels;
+    ImFontAtlasFlags flags;
+
+    bool operator==(const FontAtlasState& other) const {
+        return font_count == other.font_count && config_count == other.config_count && tex_width == other.tex_width &&
+            tex_height == other.tex_height && tex_id == other.tex_id && pixels == other.pixels && flags == other.flags;
+    }
+};
 
 
 namespace ImGuiEx {
 
 void ExitApplication() {
-    gs_exit_application = true;
+    if (gs_current_host) {
+        gs_current_host->exit_application = true;
+    }
 }
 
 void SlowDown() {
     // �����d3d11��֡�ķ�������Sleep�Ȼ���
+    Clock* clock = CurrentClock();
+    if (clock) {
+        clock->Sleep(0.010);
+        return;
+    }
     Sleep(10);
 }
 
+void CreateHost(const std::string& name, std::function<void()> update, std::function<void()> init, std::function<void()> exit) {
+    auto host = std::make_unique<Host>();
+    host->name = name;
+    host->ini_filename = "imgui_" + name + ".ini";
+    host->init = init;
+    host->update = update;
+    host->exit = exit;
+    std::lock_guard<std::mutex> lock(gs_hosts_mutex);
+    gs_hosts.push_back(std::move(host));
+}
 
 } // namespace ImGuiEx
 
@@ -39,15 +132,79 @@ void SlowDown() {
 // Data
 static ID3D11Device* g_pd3dDevice = nullptr;
 static ID3D11DeviceContext* g_pd3dDeviceContext = nullptr;
-static IDXGISwapChain* g_pSwapChain = nullptr;
-static UINT                     g_ResizeWidth = 0, g_ResizeHeight = 0;
-static ID3D11RenderTargetView* g_mainRenderTargetView = nullptr;
+static HINSTANCE g_hInstance = nullptr;
+static const wchar_t* g_ClassName = L"ImGui Example";
+
+
+namespace ImGuiEx {
+
+class D3D11TextureRenderer : public TextureRenderer {
+public:
+    ImTextureID CreateTexture(const unsigned char* rgba, int width, int height) override {
+        D3D11_TEXTURE2D_DESC desc;
+        ZeroMemory(&desc, sizeof(desc));
+        desc.Width = width;
+        desc.Height = height;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        desc.CPUAccessFlags = 0;
+
+        D3D11_SUBRESOURCE_DATA sub_resource;
+        sub_resource.pSysMem = rgba;
+        sub_resource.SysMemPitch = desc.Width * 4;
+        sub_resource.SysMemSlicePitch = 0;
+
+        ID3D11Texture2D* texture = nullptr;
+        if (g_pd3dDevice->CreateTexture2D(&desc, &sub_resource, &texture) != S_OK) {
+            return nullptr;
+        }
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc;
+        ZeroMemory(&srv_desc, sizeof(srv_desc));
+        srv_desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        srv_desc.Texture2D.MipLevels = desc.MipLevels;
+        srv_desc.Texture2D.MostDetailedMip = 0;
+        ID3D11ShaderResourceView* view = nullptr;
+        g_pd3dDevice->CreateShaderResourceView(texture, &srv_desc, &view);
+        texture->Release();
+        return (ImTextureID)view;
+    }
+
+    void DestroyTexture(ImTextureID texture) override {
+        if (texture) {
+            ((ID3D11ShaderResourceView*)texture)->Release();
+        }
+    }
+};
+
+TextureRenderer* GetTextureRenderer() {
+    static D3D11TextureRenderer renderer;
+    return &renderer;
+}
+
+} // namespace ImGuiEx
+
 
 // Forward declarations of helper functions
-static bool CreateDeviceD3D(HWND hWnd);
+static bool CreateDeviceD3D();
 static void CleanupDeviceD3D();
-static void CreateRenderTarget();
-static void CleanupRenderTarget();
+static bool CreateSwapChain(Host* host);
+static void CleanupSwapChain(Host* host);
+static void CreateRenderTarget(Host* host);
+static void CleanupRenderTarget(Host* host);
+static bool InitHost(Host* host);
+static void RunHost(Host* host);
+static void UsePrivateFontAtlas(const std::function<void()>& fn);
+static FontAtlasState GetFontAtlasState(ImFontAtlas* atlas);
+static void RenderPlatformWindows();
+static void PresentPlatformWindows();
+static void ShutdownHost(Host* host);
+static void WaitForAnimation(ImGuiEx::Animator* animator);
 static LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
 // Main code
@@ -59,39 +216,132 @@ int WinMain(
 {
     // Create application window
     //ImGui_ImplWin32_EnableDpiAwareness();
-    WNDCLASSEXW wc = { sizeof(wc), CS_CLASSDC, WndProc, 0L, 0L, GetModuleHandle(nullptr), nullptr, nullptr, nullptr, nullptr, L"ImGui Example", nullptr };
+    g_hInstance = GetModuleHandle(nullptr);
+    WNDCLASSEXW wc = { sizeof(wc), CS_CLASSDC, WndProc, 0L, 0L, g_hInstance, nullptr, nullptr, nullptr, nullptr, g_ClassName, nullptr };
     ::RegisterClassExW(&wc);
+
+    // Initialize Direct3D
+    if (!CreateDeviceD3D())
+    {
+        CleanupDeviceD3D();
+        ::UnregisterClassW(wc.lpszClassName, wc.hInstance);
+        return 1;
+    }
+
+    // Load Fonts
+    // - If no fonts are loaded, dear imgui will use the default font. You can also load multiple fonts and use ImGui::PushFont()/PopFont() to select them.
+    // - AddFontFromFileTTF() will return the ImFont* so you can store it if you need to select the font among multiple.
+    // - If the file cannot be loaded, the function will return a nullptr. Please handle those errors in your application (e.g. use an assertion, or display an error and quit).
+    // - The fonts will be rasterized at a given size (w/ oversampling) and stored into a texture when calling ImFontAtlas::Build()/GetTexDataAsXXXX(), which ImGui_ImplXXXX_NewFrame below will call.
+    // - Use '#define IMGUI_ENABLE_FREETYPE' in your imconfig file to use Freetype for higher quality font rendering.
+    // - Read 'docs/FONTS.md' for more instructions and details.
+    // - Remember that in C/C++ if you want to include a backslash \ in a string literal you need to write a double backslash \\ !
+    // - The atlas is shared by every Host, add fonts only in the main ImGuiInit() through ImGui::GetIO().Fonts.
+    //   Hosts added with CreateHost initialize while the main host is already rendering with the atlas, so their init must not change it.
+    //io.Fonts->AddFontDefault();
+    //io.Fonts->AddFontFromFileTTF("c:\\Windows\\Fonts\\segoeui.ttf", 18.0f);
+    //io.Fonts->AddFontFromFileTTF("../../misc/fonts/DroidSans.ttf", 16.0f);
+    //io.Fonts->AddFontFromFileTTF("../../misc/fonts/Roboto-Medium.ttf", 16.0f);
+    //io.Fonts->AddFontFromFileTTF("../../misc/fonts/Cousine-Regular.ttf", 15.0f);
+    //ImFont* font = io.Fonts->AddFontFromFileTTF("c:\\Windows\\Fonts\\ArialUni.ttf", 18.0f, nullptr, io.Fonts->GetGlyphRangesJapanese());
+    //IM_ASSERT(font != nullptr);
+    gs_font_atlas = IM_NEW(ImFontAtlas)();
+
+    // 主界面运行在当前线程，ImGuiInit中通过CreateHost添加的界面在主界面初始化后各自启动线程
+    Host main_host;
+    main_host.name = "main";
+    main_host.init = ImGuiInit;
+    main_host.update = ImGuiUpdate;
+    main_host.exit = ImGuiExit;
+    if (!InitHost(&main_host))
+    {
+        CleanupDeviceD3D();
+        ::UnregisterClassW(wc.lpszClassName, wc.hInstance);
+        return 1;
+    }
+    gs_font_texture = gs_font_atlas->TexID;
+
+    {
+        std::lock_guard<std::mutex> lock(gs_hosts_mutex);
+        for (auto& host : gs_hosts) {
+            Host* ptr = host.get();
+            host->thread = std::thread([ptr]() {
+                if (InitHost(ptr)) {
+                    RunHost(ptr);
+                    ShutdownHost(ptr);
+                }
+            });
+        }
+    }
+
+    RunHost(&main_host);
+
+    // 主界面退出时通知其他界面一并退出
+    gs_quit = true;
+    {
+        std::lock_guard<std::mutex> lock(gs_hosts_mutex);
+        for (auto& host : gs_hosts) {
+            if (host->thread.joinable()) {
+                host->thread.join();
+            }
+        }
+        gs_hosts.clear();
+    }
+    gs_font_texture = nullptr;
+    ShutdownHost(&main_host);
+
+    IM_DELETE(gs_font_atlas);
+    gs_font_atlas = nullptr;
+    CleanupDeviceD3D();
+    ::UnregisterClassW(wc.lpszClassName, wc.hInstance);
+
+    return 0;
+}
+
+static bool InitHost(Host* host)
+{
+    gs_current_host = host;
+    host->swap_chain = nullptr;
+    host->render_target_view = nullptr;
+    host->resize_width = 0;
+    host->resize_height = 0;
+    host->context = nullptr;
+    host->exit_application = false;
+
     //HWND hwnd = ::CreateWindowW(wc.lpszClassName, L"Dear ImGui DirectX11 Example", WS_OVERLAPPEDWINDOW, 100, 100, 1280, 800, nullptr, nullptr, wc.hInstance, nullptr);
-    HWND hwnd = CreateWindowExW(WS_EX_TOOLWINDOW |
+    host->hwnd = CreateWindowExW(WS_EX_TOOLWINDOW |
         WS_EX_NOACTIVATE |
         WS_EX_TRANSPARENT |
         WS_EX_LAYERED |
         WS_EX_TOPMOST,
-        wc.lpszClassName,
+        g_ClassName,
         L"Dear ImGui DirectX11 Example",
         WS_POPUP,
         0, 0, 0, 0,
         nullptr,
         nullptr,
-        wc.hInstance,
+        g_hInstance,
         nullptr);
 
-    // Initialize Direct3D
-    if (!CreateDeviceD3D(hwnd))
+    if (!CreateSwapChain(host))
     {
-        CleanupDeviceD3D();
-        ::UnregisterClassW(wc.lpszClassName, wc.hInstance);
-        return 1;
+        CleanupSwapChain(host);
+        ::DestroyWindow(host->hwnd);
+        return false;
     }
 
     // Show the window
-    ::ShowWindow(hwnd, SW_SHOWDEFAULT);
-    ::UpdateWindow(hwnd);
+    ::ShowWindow(host->hwnd, SW_SHOWDEFAULT);
+    ::UpdateWindow(host->hwnd);
 
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
+    host->context = ImGui::CreateContext(gs_font_atlas);
+    ImGuiEx::internal::ContextCount()++;
+    ImGui::SetCurrentContext(host->context);
     ImGuiIO& io = ImGui::GetIO(); (void)io;
+    if (!host->ini_filename.empty())
+        io.IniFilename = host->ini_filename.c_str();
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;         // Enable Docking
@@ -109,7 +359,15 @@ int WinMain(
     ImGui::StyleColorsDark();
     //ImGui::StyleColorsLight();
 
-    ImGuiInit();
+    if (host->init) {
+        // 共享图集只能在主界面的init中修改，其他界面初始化时主界面可能正在使用图集
+        bool secondary = gs_font_texture != nullptr;
+        FontAtlasState before = GetFontAtlasState(gs_font_atlas);
+        host->init();
+        IM_ASSERT((!secondary || GetFontAtlasState(gs_font_atlas) == before) && "Only the main host's init may change the shared font atlas");
+        (void)secondary;
+        (void)before;
+    }
 
 
     // When viewports are enabled we tweak WindowRounding/WindowBg so platform windows can look identical to regular ones.
@@ -121,32 +379,94 @@ int WinMain(
     }
 
     // Setup Platform/Renderer backends
-    ImGui_ImplWin32_Init(hwnd);
-    ImGui_ImplDX11_Init(g_pd3dDevice, g_pd3dDeviceContext);
+    ImGui_ImplWin32_Init(host->hwnd);
+    {
+        // 字体纹理只由主界面创建并写入共享图集的TexID，其余界面直接使用
+        std::lock_guard<std::mutex> lock(gs_render_mutex);
+        ImGui_ImplDX11_Init(g_pd3dDevice, g_pd3dDeviceContext);
+        if (gs_font_texture)
+            UsePrivateFontAtlas([]() { ImGui_ImplDX11_CreateDeviceObjects(); });
+        else
+            ImGui_ImplDX11_CreateDeviceObjects();
+    }
+    return true;
+}
 
-    // Load Fonts
-    // - If no fonts are loaded, dear imgui will use the default font. You can also load multiple fonts and use ImGui::PushFont()/PopFont() to select them.
-    // - AddFontFromFileTTF() will return the ImFont* so you can store it if you need to select the font among multiple.
-    // - If the file cannot be loaded, the function will return a nullptr. Please handle those errors in your application (e.g. use an assertion, or display an error and quit).
-    // - The fonts will be rasterized at a given size (w/ oversampling) and stored into a texture when calling ImFontAtlas::Build()/GetTexDataAsXXXX(), which ImGui_ImplXXXX_NewFrame below will call.
-    // - Use '#define IMGUI_ENABLE_FREETYPE' in your imconfig file to use Freetype for higher quality font rendering.
-    // - Read 'docs/FONTS.md' for more instructions and details.
-    // - Remember that in C/C++ if you want to include a backslash \ in a string literal you need to write a double backslash \\ !
-    //io.Fonts->AddFontDefault();
-    //io.Fonts->AddFontFromFileTTF("c:\\Windows\\Fonts\\segoeui.ttf", 18.0f);
-    //io.Fonts->AddFontFromFileTTF("../../misc/fonts/DroidSans.ttf", 16.0f);
-    //io.Fonts->AddFontFromFileTTF("../../misc/fonts/Roboto-Medium.ttf", 16.0f);
-    //io.Fonts->AddFontFromFileTTF("../../misc/fonts/Cousine-Regular.ttf", 15.0f);
-    //ImFont* font = io.Fonts->AddFontFromFileTTF("c:\\Windows\\Fonts\\ArialUni.ttf", 18.0f, nullptr, io.Fonts->GetGlyphRangesJapanese());
-    //IM_ASSERT(font != nullptr);
+static FontAtlasState GetFontAtlasState(ImFontAtlas* atlas)
+{
+    FontAtlasState state;
+    state.font_count = atlas->Fonts.Size;
+    state.config_count = atlas->ConfigData.Size;
+    state.tex_width = atlas->TexWidth;
+    state.tex_height = atlas->TexHeight;
+    state.tex_id = atlas->TexID;
+    state.pixels = atlas->TexPixelsRGBA32 ? (const void*)atlas->TexPixelsRGBA32 : (const void*)atlas->TexPixelsAlpha8;
+    state.flags = atlas->Flags;
+    return state;
+}
+
+// DX11后端创建和销毁设备对象时会读取io.Fonts的像素并改写TexID，
+// 非主界面在此期间换用1x1像素的临时图集，其他线程正在使用的共享图集不被读写
+static void UsePrivateFontAtlas(const std::function<void()>& fn)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    ImFontAtlas* shared = io.Fonts;
+    ImFontAtlas atlas;
+    atlas.TexWidth = 1;
+    atlas.TexHeight = 1;
+    atlas.TexPixelsRGBA32 = (unsigned int*)IM_ALLOC(sizeof(unsigned int));
+    atlas.TexPixelsRGBA32[0] = 0xFFFFFFFF;
+    io.Fonts = &atlas;
+    fn();
+    io.Fonts = shared;
+}
+
+// 与RenderPlatformWindowsDefault相同，但绘制和Present分开进行，Present不占用gs_render_mutex
+static void RenderPlatformWindows()
+{
+    ImGuiPlatformIO& platform_io = ImGui::GetPlatformIO();
+    for (int i = 1; i < platform_io.Viewports.Size; i++)
+    {
+        ImGuiViewport* viewport = platform_io.Viewports[i];
+        if (viewport->Flags & ImGuiViewportFlags_IsMinimized)
+            continue;
+        if (platform_io.Platform_RenderWindow)
+            platform_io.Platform_RenderWindow(viewport, nullptr);
+        if (platform_io.Renderer_RenderWindow)
+            platform_io.Renderer_RenderWindow(viewport, nullptr);
+    }
+}
+
+static void PresentPlatformWindows()
+{
+    ImGuiPlatformIO& platform_io = ImGui::GetPlatformIO();
+    for (int i = 1; i < platform_io.Viewports.Size; i++)
+    {
+        ImGuiViewport* viewport = platform_io.Viewports[i];
+        if (viewport->Flags & ImGuiViewportFlags_IsMinimized)
+            continue;
+        if (platform_io.Platform_SwapBuffers)
+            platform_io.Platform_SwapBuffers(viewport, nullptr);
+        if (platform_io.Renderer_SwapBuffers)
+            platform_io.Renderer_SwapBuffers(viewport, nullptr);
+    }
+}
+
+static void RunHost(Host* host)
+{
+    gs_current_host = host;
+    ImGui::SetCurrentContext(host->context);
+    ImGuiIO& io = ImGui::GetIO();
 
     // Our state
-    bool show_demo_window = true;
-    bool show_another_window = false;
     ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
+    ImGuiEx::CommandQueue& commands = ImGuiEx::GetCommandQueue();
+    commands.SetWakeWindow(host->hwnd);
 
     // Main loop
     bool done = false;
+    // 收到消息后继续渲染的帧数，ImGui需要若干帧完成悬停、导航等状态过渡
+    int busy_frames = 0;
     while (!done)
     {
         // Poll and handle messages (inputs, window resize, etc.)
@@ -154,6 +474,7 @@ int WinMain(
         MSG msg;
         while (::PeekMessage(&msg, nullptr, 0U, 0U, PM_REMOVE))
         {
+            busy_frames = 3;
             ::TranslateMessage(&msg);
             ::DispatchMessage(&msg);
             if (msg.message == WM_QUIT)
@@ -163,64 +484,181 @@ int WinMain(
             break;
 
         // Handle window resize (we don't resize directly in the WM_SIZE handler)
-        if (g_ResizeWidth != 0 && g_ResizeHeight != 0)
+        if (host->resize_width != 0 && host->resize_height != 0)
         {
-            CleanupRenderTarget();
-            g_pSwapChain->ResizeBuffers(0, g_ResizeWidth, g_ResizeHeight, DXGI_FORMAT_UNKNOWN, 0);
-            g_ResizeWidth = g_ResizeHeight = 0;
-            CreateRenderTarget();
+            std::lock_guard<std::mutex> lock(gs_render_mutex);
+            CleanupRenderTarget(host);
+            host->swap_chain->ResizeBuffers(0, host->resize_width, host->resize_height, DXGI_FORMAT_UNKNOWN, 0);
+            host->resize_width = host->resize_height = 0;
+            CreateRenderTarget(host);
         }
 
         // Start the Dear ImGui frame
         ImGui_ImplDX11_NewFrame();
         ImGui_ImplWin32_NewFrame();
+        ImGuiEx::RemotePublisher* publisher = ImGuiEx::CurrentRemotePublisher();
+        if (publisher)
+            publisher->PollInput();
+        ImGuiEx::InputRecorder* recorder = ImGuiEx::CurrentInputRecorder();
+        if (recorder)
+            recorder->Record();
         ImGui::NewFrame();
+        commands.Drain();
+#ifdef IMGUI_EX_COROUTINE
+        ImGuiEx::internal::DrainResumeQueue();
+#endif
+        ImGuiEx::Animator* animator = ImGuiEx::CurrentAnimator();
+        if (animator)
+            animator->Update();
+        ImGuiEx::LatencyTracker* tracker = ImGuiEx::CurrentLatencyTracker();
+        if (tracker)
+            tracker->NewFrame();
 
 
-        ImGuiUpdate();
+        host->update();
+        ImGuiEx::ReleaseExpiredContents();
 
 
         // Rendering
 
         ImGui::Render();
-        const float clear_color_with_alpha[4] = { clear_color.x * clear_color.w, clear_color.y * clear_color.w, clear_color.z * clear_color.w, clear_color.w };
-        g_pd3dDeviceContext->OMSetRenderTargets(1, &g_mainRenderTargetView, nullptr);
-        g_pd3dDeviceContext->ClearRenderTargetView(g_mainRenderTargetView, clear_color_with_alpha);
-        ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
-
-        // Update and Render additional Platform Windows
-        if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+        ImGuiEx::ClipCuller* culler = ImGuiEx::CurrentClipCuller();
+        if (culler)
+            culler->Process();
+        ImGuiEx::DrawCoalescer* coalescer = ImGuiEx::CurrentDrawCoalescer();
+        if (coalescer)
+            coalescer->Process();
+        if (publisher)
+            publisher->Publish();
+        if (tracker)
+            tracker->Render();
+        if (!publisher || publisher->IsLocalRender())
         {
+            {
+                std::lock_guard<std::mutex> lock(gs_render_mutex);
+                const float clear_color_with_alpha[4] = { clear_color.x * clear_color.w, clear_color.y * clear_color.w, clear_color.z * clear_color.w, clear_color.w };
+                g_pd3dDeviceContext->OMSetRenderTargets(1, &host->render_target_view, nullptr);
+                g_pd3dDeviceContext->ClearRenderTargetView(host->render_target_view, clear_color_with_alpha);
+                ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+
+                // Update and Render additional Platform Windows
+                if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+                {
+                    ImGui::UpdatePlatformWindows();
+                    RenderPlatformWindows();
+                }
+            }
+
+            // 等待垂直同步时不持有gs_render_mutex，各Host的Present互不阻塞
+            if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+                PresentPlatformWindows();
+            host->swap_chain->Present(1, 0); // Present with vsync
+            //host->swap_chain->Present(0, 0); // Present without vsync
+        }
+        else if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+        {
+            // 不在本地渲染时仍要更新平台窗口，否则视口不会创建、移动和销毁
+            std::lock_guard<std::mutex> lock(gs_render_mutex);
             ImGui::UpdatePlatformWindows();
-            ImGui::RenderPlatformWindowsDefault();
         }
+        if (tracker)
+            tracker->Present();
 
-        g_pSwapChain->Present(1, 0); // Present with vsync
-        //g_pSwapChain->Present(0, 0); // Present without vsync
+        ImGuiEx::MemoryTracker* memory = ImGuiEx::CurrentMemoryTracker();
+        if (memory)
+            memory->Update();
 
-        if (gs_exit_application) {
+        if (host->exit_application || gs_quit) {
             break;
         }
 
-        ImGuiEx::SlowDown();
+        // 远程输入不经过消息队列，不能阻塞等待；不在本地呈现时没有垂直同步限速，按发布端帧率等待
+        if (publisher && !publisher->IsLocalRender())
+            publisher->WaitFrame();
+        else if (animator && animator->IsIdleEnabled() && busy_frames == 0 && !io.WantTextInput && !publisher)
+            WaitForAnimation(animator);
+        else
+            ImGuiEx::SlowDown();
+        if (busy_frames > 0)
+            busy_frames--;
     }
+}
 
-    ImGuiExit();
+// 没有输入和动画时阻塞到下一个动画时间点或有新消息到达
+static void WaitForAnimation(ImGuiEx::Animator* animator)
+{
+    // 悬停提示框、加载占位等由ImGui计时器驱动的变化没有消息唤醒，等待不能超过其剩余时间
+    double timeout = std::min(animator->GetIdleTimeout(), ImGuiEx::GetTimerTimeout());
+    ImGuiEx::Clock* clock = ImGuiEx::CurrentClock();
+    if (clock)
+    {
+        // 假时钟下没有真实消息可等，直接推进时间
+        clock->Sleep(std::isinf(timeout) ? 0.010 : timeout);
+        return;
+    }
+    DWORD ms = std::isinf(timeout) ? INFINITE : (DWORD)std::ceil(timeout * 1000.0);
+    if (ms > 0)
+        ::MsgWaitForMultipleObjects(0, nullptr, FALSE, ms, QS_ALLINPUT);
+}
+
+static void ShutdownHost(Host* host)
+{
+    gs_current_host = host;
+    ImGui::SetCurrentContext(host->context);
+    if (host->exit) {
+        host->exit();
+    }
 
     // Cleanup
-    ImGui_ImplDX11_Shutdown();
+    {
+        std::lock_guard<std::mutex> lock(gs_render_mutex);
+        if (gs_font_texture)
+            UsePrivateFontAtlas([]() { ImGui_ImplDX11_Shutdown(); });
+        else
+            ImGui_ImplDX11_Shutdown();
+    }
     ImGui_ImplWin32_Shutdown();
-    ImGui::DestroyContext();
+    ImGui::DestroyContext(host->context);
+    ImGuiEx::internal::ContextCount()--;
+    host->context = nullptr;
 
-    CleanupDeviceD3D();
-    ::DestroyWindow(hwnd);
-    ::UnregisterClassW(wc.lpszClassName, wc.hInstance);
-
-    return 0;
+    {
+        std::lock_guard<std::mutex> lock(gs_render_mutex);
+        CleanupSwapChain(host);
+    }
+    ::DestroyWindow(host->hwnd);
 }
 
 // Helper functions
-static bool CreateDeviceD3D(HWND hWnd)
+static bool CreateDeviceD3D()
+{
+    UINT createDeviceFlags = 0;
+    //createDeviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
+    D3D_FEATURE_LEVEL featureLevel;
+    const D3D_FEATURE_LEVEL featureLevelArray[2] = { D3D_FEATURE_LEVEL_11_0, D3D_FEATURE_LEVEL_10_0, };
+    HRESULT res = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, createDeviceFlags, featureLevelArray, 2, D3D11_SDK_VERSION, &g_pd3dDevice, &featureLevel, &g_pd3dDeviceContext);
+    if (res == DXGI_ERROR_UNSUPPORTED) // Try high-performance WARP software driver if hardware is not available.
+        res = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_WARP, nullptr, createDeviceFlags, featureLevelArray, 2, D3D11_SDK_VERSION, &g_pd3dDevice, &featureLevel, &g_pd3dDeviceContext);
+    if (res != S_OK)
+        return false;
+
+    // 各Host在gs_render_mutex之外Present，Present内部会使用立即上下文，需要开启运行时的多线程保护
+    ID3D11Multithread* multithread = nullptr;
+    if (g_pd3dDeviceContext->QueryInterface(IID_PPV_ARGS(&multithread)) == S_OK)
+    {
+        multithread->SetMultithreadProtected(TRUE);
+        multithread->Release();
+    }
+    return true;
+}
+
+static void CleanupDeviceD3D()
+{
+    if (g_pd3dDeviceContext) { g_pd3dDeviceContext->Release(); g_pd3dDeviceContext = nullptr; }
+    if (g_pd3dDevice) { g_pd3dDevice->Release(); g_pd3dDevice = nullptr; }
+}
+
+static bool CreateSwapChain(Host* host)
 {
     // Setup swap chain
     DXGI_SWAP_CHAIN_DESC sd;
@@ -233,45 +671,53 @@ static bool CreateDeviceD3D(HWND hWnd)
     sd.BufferDesc.RefreshRate.Denominator = 1;
     sd.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
     sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-    sd.OutputWindow = hWnd;
+    sd.OutputWindow = host->hwnd;
     sd.SampleDesc.Count = 1;
     sd.SampleDesc.Quality = 0;
     sd.Windowed = TRUE;
     sd.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
 
-    UINT createDeviceFlags = 0;
-    //createDeviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
-    D3D_FEATURE_LEVEL featureLevel;
-    const D3D_FEATURE_LEVEL featureLevelArray[2] = { D3D_FEATURE_LEVEL_11_0, D3D_FEATURE_LEVEL_10_0, };
-    HRESULT res = D3D11CreateDeviceAndSwapChain(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, createDeviceFlags, featureLevelArray, 2, D3D11_SDK_VERSION, &sd, &g_pSwapChain, &g_pd3dDevice, &featureLevel, &g_pd3dDeviceContext);
-    if (res == DXGI_ERROR_UNSUPPORTED) // Try high-performance WARP software driver if hardware is not available.
-        res = D3D11CreateDeviceAndSwapChain(nullptr, D3D_DRIVER_TYPE_WARP, nullptr, createDeviceFlags, featureLevelArray, 2, D3D11_SDK_VERSION, &sd, &g_pSwapChain, &g_pd3dDevice, &featureLevel, &g_pd3dDeviceContext);
+    IDXGIDevice* dxgi_device = nullptr;
+    IDXGIAdapter* dxgi_adapter = nullptr;
+    IDXGIFactory* dxgi_factory = nullptr;
+    HRESULT res = g_pd3dDevice->QueryInterface(IID_PPV_ARGS(&dxgi_device));
+    if (res == S_OK)
+        res = dxgi_device->GetParent(IID_PPV_ARGS(&dxgi_adapter));
+    if (res == S_OK)
+        res = dxgi_adapter->GetParent(IID_PPV_ARGS(&dxgi_factory));
+    if (res == S_OK)
+    {
+        std::lock_guard<std::mutex> lock(gs_render_mutex);
+        res = dxgi_factory->CreateSwapChain(g_pd3dDevice, &sd, &host->swap_chain);
+    }
+    if (dxgi_factory) dxgi_factory->Release();
+    if (dxgi_adapter) dxgi_adapter->Release();
+    if (dxgi_device) dxgi_device->Release();
     if (res != S_OK)
         return false;
 
-    CreateRenderTarget();
+    std::lock_guard<std::mutex> lock(gs_render_mutex);
+    CreateRenderTarget(host);
     return true;
 }
 
-static void CleanupDeviceD3D()
+static void CleanupSwapChain(Host* host)
 {
-    CleanupRenderTarget();
-    if (g_pSwapChain) { g_pSwapChain->Release(); g_pSwapChain = nullptr; }
-    if (g_pd3dDeviceContext) { g_pd3dDeviceContext->Release(); g_pd3dDeviceContext = nullptr; }
-    if (g_pd3dDevice) { g_pd3dDevice->Release(); g_pd3dDevice = nullptr; }
+    CleanupRenderTarget(host);
+    if (host->swap_chain) { host->swap_chain->Release(); host->swap_chain = nullptr; }
 }
 
-static void CreateRenderTarget()
+static void CreateRenderTarget(Host* host)
 {
     ID3D11Texture2D* pBackBuffer;
-    g_pSwapChain->GetBuffer(0, IID_PPV_ARGS(&pBackBuffer));
-    g_pd3dDevice->CreateRenderTargetView(pBackBuffer, nullptr, &g_mainRenderTargetView);
+    host->swap_chain->GetBuffer(0, IID_PPV_ARGS(&pBackBuffer));
+    g_pd3dDevice->CreateRenderTargetView(pBackBuffer, nullptr, &host->render_target_view);
     pBackBuffer->Release();
 }
 
-static void CleanupRenderTarget()
+static void CleanupRenderTarget(Host* host)
 {
-    if (g_mainRenderTargetView) { g_mainRenderTargetView->Release(); g_mainRenderTargetView = nullptr; }
+    if (host->render_target_view) { host->render_target_view->Release(); host->render_target_view = nullptr; }
 }
 
 #ifndef WM_DPICHANGED
@@ -281,13 +727,51 @@ static void CleanupRenderTarget()
 // Forward declare message handler from imgui_impl_win32.cpp
 extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
+// 记录输入消息的到达时间，用于统计输入到Present的延迟
+static void TrackInputLatency(UINT msg)
+{
+    ImGuiEx::LatencyTracker* tracker = ImGuiEx::CurrentLatencyTracker();
+    if (tracker == nullptr)
+        return;
+    switch (msg)
+    {
+    case WM_MOUSEMOVE:
+    case WM_NCMOUSEMOVE:
+        tracker->Input(ImGuiEx::InputType::kMouseMove);
+        break;
+    case WM_LBUTTONDOWN: case WM_LBUTTONDBLCLK: case WM_LBUTTONUP:
+    case WM_RBUTTONDOWN: case WM_RBUTTONDBLCLK: case WM_RBUTTONUP:
+    case WM_MBUTTONDOWN: case WM_MBUTTONDBLCLK: case WM_MBUTTONUP:
+    case WM_XBUTTONDOWN: case WM_XBUTTONDBLCLK: case WM_XBUTTONUP:
+        tracker->Input(ImGuiEx::InputType::kMouseButton);
+        break;
+    case WM_MOUSEWHEEL:
+    case WM_MOUSEHWHEEL:
+        tracker->Input(ImGuiEx::InputType::kMouseWheel);
+        break;
+    case WM_KEYDOWN: case WM_KEYUP:
+    case WM_SYSKEYDOWN: case WM_SYSKEYUP:
+        tracker->Input(ImGuiEx::InputType::kKey);
+        break;
+    case WM_CHAR:
+        tracker->Input(ImGuiEx::InputType::kChar);
+        break;
+    case WM_SETFOCUS:
+    case WM_KILLFOCUS:
+        tracker->Input(ImGuiEx::InputType::kFocus);
+        break;
+    }
+}
+
 // Win32 message handler
 // You can read the io.WantCaptureMouse, io.WantCaptureKeyboard flags to tell if dear imgui wants to use your inputs.
 // - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite your copy of the mouse data.
 // - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application, or clear/overwrite your copy of the keyboard data.
 // Generally you may always pass all inputs to dear imgui, and hide them from your application based on those two flags.
+// 窗口属于创建它的线程，消息总在该线程派发，gs_current_host即为窗口所属的Host
 static LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
+    TrackInputLatency(msg);
     if (ImGui_ImplWin32_WndProcHandler(hWnd, msg, wParam, lParam))
         return true;
 
@@ -296,8 +780,11 @@ static LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
     case WM_SIZE:
         if (wParam == SIZE_MINIMIZED)
             return 0;
-        g_ResizeWidth = (UINT)LOWORD(lParam); // Queue resize
-        g_ResizeHeight = (UINT)HIWORD(lParam);
+        if (gs_current_host && gs_current_host->hwnd == hWnd)
+        {
+            gs_current_host->resize_width = (UINT)LOWORD(lParam); // Queue resize
+            gs_current_host->resize_height = (UINT)HIWORD(lParam);
+        }
         return 0;
     case WM_SYSCOMMAND:
         if ((wParam & 0xfff0) == SC_KEYMENU) // Disable ALT application menu
@@ -307,7 +794,7 @@ static LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
         ::PostQuitMessage(0);
         return 0;
     case WM_DPICHANGED:
-        if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_DpiEnableScaleViewports)
+        if (ImGui::GetCurrentContext() && ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_DpiEnableScaleViewports)
         {
             //const int dpi = HIWORD(wParam);
             //printf("WM_DPICHANGED to %d (%.0f%%)\n", dpi, (float)dpi / 96.0f * 100.0f);
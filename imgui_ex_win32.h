@@ -3,10 +3,51 @@
 
 #include <unordered_map>
 #include <string>
+#include <vector>
 #include <exception>
 #include <functional>
+#include <algorithm>
+#include <fstream>
+#include <list>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <limits>
+#include <cctype>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <new>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMGUI_EX_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define IMGUI_EX_COROUTINE
+#include <coroutine>
+#include <optional>
+#endif
+#endif
 
 #ifndef IMGUI_EX_CPP
+// ÿ߳ԼImGuiContextimgui_ex_win32.cpp
+#ifndef GImGui
+struct ImGuiContext;
+extern thread_local ImGuiContext* gs_imgui_context;
+#define GImGui gs_imgui_context
+#endif
+
 #include <imgui/imgui.h>
 #include <imgui/imconfig.h>
 #include <imgui/imgui_internal.h>
@@ -27,6 +68,10 @@ namespace ImGuiEx {
 void ExitApplication();
 void SlowDown();
 
+// һӵжImGuiContextĶ棬ImGuiInitеãʼɺ߳
+// ͼ湲ҪImGuiInit
+void CreateHost(const std::string& name, std::function<void()> update, std::function<void()> init = nullptr, std::function<void()> exit = nullptr);
+
 namespace internal {
 static HWND GetWindowHwnd(ImGuiWindow* window) {
     if (window == nullptr) return NULL;
@@ -54,911 +99,11180 @@ static bool SetWindowTop(ImGuiWindow* window, bool top) {
 } // namespace internal
 
 
-class Expandable {
+namespace internal {
+// Property汾ŵԴPropertyʱñÿգƶPropertyʱ֮ת
+class VersionRef {
 public:
-    Expandable() {
-        end_expand_ = false;
-        expand_ = false;
+    VersionRef() {
     }
 
-    void ExpandUpdate(std::function<void()> update) {
-        if (expand_ == true) { 
-            update(); 
-        }
+    VersionRef(const VersionRef&) {
     }
 
-    void CollapsingUpdate(std::function<void()> update) {
-        if (expand_ == false) {
-            update();
-        }
+    VersionRef& operator=(const VersionRef&) {
+        return *this;
     }
 
-    void ExpandEvent(std::function<void()> event) { \
-        if (expand_ == true && expand_ != end_expand_) {
-            event();
+    ~VersionRef() {
+        if (ref_) {
+            *ref_ = nullptr;
         }
     }
-    
-    void CollapsingEvent(std::function<void()> event) {
-        if (expand_ == false && expand_ != end_expand_) {
-            event();
+
+    // ״εʱŷ
+    const std::shared_ptr<const uint64_t*>& Get(const uint64_t* version) {
+        if (!ref_) {
+            ref_ = std::make_shared<const uint64_t*>(version);
         }
+        return ref_;
     }
 
-protected:
-    bool end_expand_;
-    bool expand_;
+private:
+    std::shared_ptr<const uint64_t*> ref_;
 };
-
-    
+} // namespace internal
 
 /*
-* Eventԭ
-* ǰ֡ControlлEventӰĳҪһܴ֡
+* 汾ŵֵÿʵ޸Ķʹ汾ŵ
+* ؼͨȽϰ汾ŵ֪󶨵ֵǷ仯
 */
-
-class Widget {
+template<class T>
+class Property {
 public:
-    Widget(const std::string& label) : label_(label) {
-        entry_disabled_ = false;
-        end_disabled_ = false;
-        disabled_ = false;
-        init_ = false;
+    Property() : value_() {
+        version_ = 0;
     }
 
-    void Begin() {
-        if (disabled_) {
-            ImGui::BeginDisabled();
-            entry_disabled_ = true;
-        }
-        else {
-            entry_disabled_ = false;
-        }
+    Property(const T& value) : value_(value) {
+        version_ = 0;
     }
 
-    void End() {
-        end_disabled_ = disabled_;
-        if (entry_disabled_) {
-            ImGui::EndDisabled();
-        }
+    const T& Get() const {
+        return value_;
     }
 
-
-    void InitEvent(std::function<void()> init) {
-        if (!init_) {
-            init_ = true;
-            init();
+    void Set(const T& value) {
+        if (value_ == value) {
+            return;
         }
+        value_ = value;
+        version_++;
     }
 
-    void DisableEvent(std::function<void()> event) {
-        if (disabled_ == true && disabled_ != end_disabled_) {
-            event();
-        }
+    uint64_t GetVersion() const {
+        return version_;
     }
 
-
-    void EnableEvent(std::function<void()> event) {
-        if (disabled_ == false && disabled_ != end_disabled_) {
-            event();
-        }
+    // ڲȷĹ۲߶ȡ汾ţPropertyõֵΪnullptr
+    const std::shared_ptr<const uint64_t*>& GetVersionRef() const {
+        return ref_.Get(&version_);
     }
 
+private:
+    T value_;
+    uint64_t version_;
+    mutable internal::VersionRef ref_;
+};
 
-    std::string GetLabel() {
-        return label_;
-    }
-
-    void SetLabel(const std::string& label) {
-        label_ = label;
+/*
+* ۲PropertyPollʱֻ԰汾ŷ仯Propertyص
+*/
+class PropertyObserver {
+public:
+    template<class T, class Event>
+    void Observe(const Property<T>& property, Event event) {
+        const Property<T>* p = &property;
+        versions_.push_back(property.GetVersionRef());
+        seen_.push_back(property.GetVersion());
+        events_.push_back([p, event]() { event(p->Get()); });
     }
 
-    void SetDisable(bool disabled) {
-        disabled_ = disabled;
+    // رδĻصPropertyڴʱƳౣֹ۲˳
+    size_t Poll() {
+        size_t fired = 0;
+        size_t count = 0;
+        for (size_t i = 0; i < versions_.size(); i++) {
+            const uint64_t* version = *versions_[i];
+            if (version == nullptr) {
+                continue;
+            }
+            if (*version != seen_[i]) {
+                seen_[i] = *version;
+                events_[i]();
+                fired++;
+                // صеClear
+                if (i >= versions_.size()) {
+                    return fired;
+                }
+            }
+            if (count != i) {
+                versions_[count] = std::move(versions_[i]);
+                seen_[count] = seen_[i];
+                events_[count] = std::move(events_[i]);
+            }
+            count++;
+        }
+        if (count < versions_.size()) {
+            versions_.resize(count);
+            seen_.resize(count);
+            events_.resize(count);
+        }
+        return fired;
     }
 
-    void Disable() {
-        SetDisable(true);
+    void Clear() {
+        versions_.clear();
+        seen_.clear();
+        events_.clear();
     }
 
-    void Enable() {
-        SetDisable(false);
+    size_t GetCount() {
+        return versions_.size();
     }
 
 private:
-    std::string label_;
+    std::vector<std::shared_ptr<const uint64_t*>> versions_;
+    std::vector<uint64_t> seen_;
+    std::vector<std::function<void()>> events_;
+};
 
-    bool init_;
+namespace internal {
+/*
+* WindowĿؼ
+* ؼBeginʱ¼ڵControlֻʹڴڵĻʧЧ
+* ¼ƻڼ䣬PullʱǼPropertyİ汾ţطǰκһ仯update
+*/
+struct ControlScope {
+    ControlScope() {
+        version = 0;
+        collecting = false;
+    }
 
-    bool entry_disabled_;
-    bool end_disabled_;
-    bool disabled_;
+    uint64_t version;
+    bool collecting;
+    std::vector<std::shared_ptr<const uint64_t*>> bound;
 };
 
+// ǰ߳ڻƵWindow򣬲WindowʱΪ
+inline std::shared_ptr<ControlScope>& CurrentControlScope() {
+    static thread_local std::shared_ptr<ControlScope> scope;
+    return scope;
+}
 
-
-class Window : public Widget,
-               public Expandable
-{
+/*
+* ؼProperty˫
+* PullPropertyⲿ޸ĺֵͬؼPushѿؼϵ޸дProperty
+*/
+template<class T>
+class Binding {
 public:
-    Window(const std::string& label, bool main = false, bool create = true, ImGuiWindowFlags flags = 0) : Widget(label) {
-        window_ = nullptr;
-        main_ = main;
-        end_top_ = true;
-        top_ = false;
-        control_create_ = false;
-        control_close_ = false;
-        end_create_ = false;
-        create_ = create;
-
-        entry_ = false;
-
-        end_flags_ = flags;
-        flags_ = flags;
+    Binding() {
+        property_ = nullptr;
+        version_ = 0;
+        synced_ = false;
     }
 
-    void Begin() {
-        Widget::Begin();
-        
-        if (window_ == nullptr) {
-            window_ = ImGui::FindWindowByName(GetLabel().c_str());
-        }
-
-        if (end_top_ != top_) {
-            if (internal::SetWindowTop(window_, top_)) {
-                end_top_ = top_;
-            }
-        }
-
-        if (control_create_) {
-            create_ = true;
-            control_create_ = false;
-        }
-        if (control_close_) {
-            create_ = false;
-            control_close_ = false;
-        }
+    void Bind(Property<T>* property) {
+        property_ = property;
+        synced_ = false;
+    }
 
-        if (create_) {
-            entry_ = true;
-            expand_ = ImGui::Begin(GetLabel().c_str(), &create_, flags_);
-        }
-        if (create_ == true && create_ != end_create_) {
-            // ÿ¿ڶҪtop״̬
-            end_top_ = !top_;
-        }
+    bool IsBound() {
+        return property_ != nullptr;
     }
 
-    void End() {
-        if (entry_) {
-            ImGui::End();
-            entry_ = false;
+    bool Pull(T& value) {
+        if (property_ == nullptr) {
+            return false;
         }
-        end_create_ = create_;
-        if (create_ == false) {
-            if (main_) {
-                ExitApplication();
-            }
+        ControlScope* scope = CurrentControlScope().get();
+        if (scope && scope->collecting) {
+            scope->bound.push_back(property_->GetVersionRef());
         }
-        end_expand_ = expand_;
-        Widget::End();
-    }
-
-    /*
-    * Update
-    */
-    void CreateUpdate(std::function<void()> event) {
-        if (create_) {
-            event();
+        if (synced_ && property_->GetVersion() == version_) {
+            return false;
         }
+        value = property_->Get();
+        version_ = property_->GetVersion();
+        synced_ = true;
+        return true;
     }
 
-    void CloseUpdate(std::function<void()> close) {
-        if (!create_) {
-            close();
+    void Push(const T& value) {
+        if (property_ == nullptr) {
+            return;
         }
+        property_->Set(value);
+        version_ = property_->GetVersion();
+        synced_ = true;
     }
 
+private:
+    Property<T>* property_;
+    uint64_t version_;
+    bool synced_;
+};
 
-    /*
-    * Event
-    */
-
-    void CreateEvent(std::function<void()> event) {
-        if (end_create_ == false && create_ == true) {
-            event();
-        }
+static uint64_t HashString64(const char* str, size_t len) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)str[i];
+        hash *= 1099511628211ull;
     }
+    return hash;
+}
 
-    void CloseEvent(std::function<void()> event) {
-        if (end_create_ == true && create_ == false) {
-            event();
-        }
+// 8ֽڴĿٹϣڱȽϴ
+static uint64_t HashBytes64(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t hash = seed ^ (size * 0x9E3779B97F4A7C15ull);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
     }
+    for (; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
 
+class SnapshotWriter {
+public:
+    template<class T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot value must be trivially copyable");
+        buffer_.append((const char*)&value, sizeof(T));
+    }
 
-    /*
-    * Control
-    */
-    void Create() {
-        control_create_ = true;
+    void WriteString(const std::string& str) {
+        Write((uint32_t)str.size());
+        buffer_.append(str);
     }
 
-    void Close() {
-        control_close_ = true;
+    std::string& GetBuffer() {
+        return buffer_;
     }
 
+private:
+    std::string buffer_;
+};
 
-    ImGuiWindowFlags GetFlags() {
-        return flags_;
+// Խʱкȡʧܣ÷ԭֵ
+class SnapshotReader {
+public:
+    SnapshotReader(const char* data, size_t size) {
+        cur_ = data;
+        end_ = data + size;
     }
 
-    void SetFlags(ImGuiWindowFlags flags) {
-        flags_ = flags;
+    template<class T>
+    bool Read(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot value must be trivially copyable");
+        if ((size_t)(end_ - cur_) < sizeof(T)) {
+            cur_ = end_;
+            return false;
+        }
+        memcpy(&value, cur_, sizeof(T));
+        cur_ += sizeof(T);
+        return true;
     }
 
-    void AddFlags(ImGuiWindowFlags flags) {
-        flags_ |= flags;
+    bool ReadString(std::string& str) {
+        uint32_t size;
+        if (!Read(size) || (size_t)(end_ - cur_) < size) {
+            cur_ = end_;
+            return false;
+        }
+        str.assign(cur_, size);
+        cur_ += size;
+        return true;
     }
 
-    void UnaddFlags(ImGuiWindowFlags flags) {
-        flags_ &= (~flags);;
-    }
+private:
+    const char* cur_;
+    const char* end_;
+};
 
+class MappedFile {
+public:
+    MappedFile() {
+        file_ = INVALID_HANDLE_VALUE;
+        mapping_ = NULL;
+        data_ = nullptr;
+        size_ = 0;
+    }
 
-    void SetTop(bool top) {
-        top_ = top;
+    ~MappedFile() {
+        Close();
     }
 
-    void SetDocking(bool enable){
-        if (enable) {
-            UnaddFlags(ImGuiWindowFlags_NoDocking);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path) {
+        Close();
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            return false;
         }
-        else {
-            AddFlags(ImGuiWindowFlags_NoDocking);
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) {
+            Close();
+            return false;
         }
-    }
-
-    void SetAlwaysAutoResize(bool enable) {
-        if (enable) {
-            AddFlags(ImGuiWindowFlags_AlwaysAutoResize);
+        mapping_ = CreateFileMappingA(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping_ == NULL) {
+            Close();
+            return false;
         }
-        else {
-            UnaddFlags(ImGuiWindowFlags_AlwaysAutoResize);
+        data_ = (const char*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+        if (data_ == nullptr) {
+            Close();
+            return false;
         }
+        size_ = (uint64_t)size.QuadPart;
+        return true;
     }
 
-    void SetMove(bool enable) {
-        if (enable) {
-            UnaddFlags(ImGuiWindowFlags_NoMove);
+    void Close() {
+        if (data_) {
+            UnmapViewOfFile(data_);
+            data_ = nullptr;
         }
-        else {
-            AddFlags(ImGuiWindowFlags_NoMove);
+        if (mapping_) {
+            CloseHandle(mapping_);
+            mapping_ = NULL;
         }
+        if (file_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(file_);
+            file_ = INVALID_HANDLE_VALUE;
+        }
+        size_ = 0;
     }
 
-    void SetCollapse(bool enable) {
-        if (enable) {
-            UnaddFlags(ImGuiWindowFlags_NoCollapse);
-        }
-        else {
-            AddFlags(ImGuiWindowFlags_NoCollapse);
-        }
+    const char* GetData() {
+        return data_;
+    }
+
+    uint64_t GetSize() {
+        return size_;
     }
 
 private:
-    ImGuiWindow* window_;
+    HANDLE file_;
+    HANDLE mapping_;
+    const char* data_;
+    uint64_t size_;
+};
 
-    bool main_;
-    bool entry_;
-    bool end_top_;
-    bool top_;
+template<class T>
+struct IsProperty : std::false_type {};
 
-    bool control_close_;
-    bool control_create_;
-    bool end_create_;
-    bool create_;
+template<class T>
+struct IsProperty<Property<T>> : std::true_type {};
 
-    ImGuiWindowFlags end_flags_;
-    ImGuiWindowFlags flags_;
+static const char* FormatValue(const std::string& value) {
+    return value.c_str();
+}
+
+template<class T>
+static const T& FormatValue(const T& value) {
+    return value;
+}
+
+// ֵͨ棬汾źΪ0
+template<class T>
+struct ValueArg {
+    T value;
+    uint64_t Version() const { return 0; }
+    decltype(FormatValue(std::declval<const T&>())) Value() const { return FormatValue(value); }
 };
 
-class Button : public Widget {
+// Propertyָֻ룬ʽʱȡǰֵ
+template<class T>
+struct PropertyArg {
+    const Property<T>* property;
+    uint64_t Version() const { return property->GetVersion(); }
+    decltype(FormatValue(std::declval<const T&>())) Value() const { return FormatValue(property->Get()); }
+};
+
+template<class T>
+static PropertyArg<T> BindArg(const Property<T>& property) {
+    return PropertyArg<T>{ &property };
+}
+
+template<class T, typename std::enable_if<!IsProperty<typename std::decay<T>::type>::value, int>::type = 0>
+static ValueArg<typename std::decay<T>::type> BindArg(T&& value) {
+    return ValueArg<typename std::decay<T>::type>{ std::forward<T>(value) };
+}
+
+/*
+* ĸʽı
+* ֻڰ󶨵Property汾ű仯ʱ¸ʽûвʱԭıе%ʽ
+*/
+class TextFormat {
 public:
-    Button(const std::string& label) : Widget(label) {
-        click_ = false;
-        control_click_ = false;
+    TextFormat() {
+        version_ = 0;
+        dirty_ = true;
     }
 
-    void Begin() {
-        Widget::Begin();
-        click_ = ImGui::Button(GetLabel().c_str());
-        if (control_click_) {
-            click_ = true;
-            control_click_ = false;
+    template<typename ... Args>
+    void Bind(const std::string& fmt, Args&&... args) {
+        fmt_ = fmt;
+        dirty_ = true;
+        // ûвʱʵʽ·UpdateֱӸı
+        if constexpr (sizeof...(Args) == 0) {
+            version_func_ = nullptr;
+            format_func_ = nullptr;
+        }
+        else {
+            auto bound = std::make_tuple(BindArg(std::forward<Args>(args))...);
+            version_func_ = [bound]() {
+                return std::apply([](const auto&... arg) { return (uint64_t(0) + ... + arg.Version()); }, bound);
+            };
+            format_func_ = [bound](const std::string& fmt, std::string& out) {
+                std::apply([&](const auto&... arg) { Format(out, fmt.c_str(), arg.Value()...); }, bound);
+            };
         }
     }
 
-    void End() {
-        Widget::End();
+    void Update() {
+        if (version_func_) {
+            uint64_t version = version_func_();
+            if (version != version_) {
+                version_ = version;
+                dirty_ = true;
+            }
+        }
+        if (!dirty_) {
+            return;
+        }
+        if (format_func_) {
+            format_func_(fmt_, text_);
+        }
+        else {
+            text_ = fmt_;
+        }
+        dirty_ = false;
     }
 
-    /*
-    * Event
-    */
-    void ClickEvent(std::function<void()> event) {
-        if (click_ == true) {
-            event();
+    const char* GetText() const {
+        return text_.c_str();
+    }
+
+    const char* GetTextEnd() const {
+        return text_.c_str() + text_.size();
+    }
+
+    const std::string& GetString() const {
+        return text_;
+    }
+
+private:
+    template<typename ... Values>
+    static void Format(std::string& out, const char* fmt, Values... values) {
+        int len = snprintf(nullptr, 0, fmt, values...);
+        if (len < 0) {
+            out.clear();
+            return;
+        }
+        out.resize((size_t)len + 1);
+        snprintf(&out[0], out.size(), fmt, values...);
+        out.resize((size_t)len);
+    }
+
+private:
+    std::string fmt_;
+    std::string text_;
+    uint64_t version_;
+    bool dirty_;
+
+    std::function<uint64_t()> version_func_;
+    std::function<void(const std::string&, std::string&)> format_func_;
+};
+} // namespace internal
+
+
+/*
+* ʱӽӿڣλΪ
+* FakeClockSleepֻƽʱ䣬޴ڻи֡ࣨSlowDownֱͬӳ
+*/
+class Clock {
+public:
+    virtual ~Clock() {}
+
+    virtual double Now() = 0;
+    virtual void Sleep(double seconds) = 0;
+};
+
+class SystemClock : public Clock {
+public:
+    double Now() override {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void Sleep(double seconds) override {
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    }
+};
+
+class FakeClock : public Clock {
+public:
+    FakeClock(double now = 0.0) {
+        now_ = now;
+    }
+
+    double Now() override {
+        return now_;
+    }
+
+    void Sleep(double seconds) override {
+        Advance(seconds);
+    }
+
+    void Advance(double seconds) {
+        if (seconds > 0.0) {
+            now_ += seconds;
+        }
+    }
+
+private:
+    double now_;
+};
+
+enum class InputType {
+    kMouseMove,
+    kMouseButton,
+    kMouseWheel,
+    kKey,
+    kChar,
+    kFocus,
+    kCount,
+};
+
+struct LatencyStats {
+    size_t count;
+    double min;
+    double mean;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+};
+
+/*
+* 뵽ֵӳͳ
+* InputյϢʱãNewFrameConsumeؼӦ룬Button::ClickEventRenderPresent
+* ֮֡յ붼һNewFrameʼ֡
+*/
+class LatencyTracker {
+public:
+    enum Stage {
+        kStageNewFrame,
+        kStageConsume,
+        kStageRender,
+        kStagePresent,
+        kStageCount,
+    };
+
+    LatencyTracker(Clock* clock = nullptr, size_t max_samples = 4096) {
+        clock_ = clock ? clock : &system_clock_;
+        max_samples_ = max_samples;
+        frame_consumed_ = false;
+        new_frame_time_ = 0.0;
+        consume_time_ = 0.0;
+        render_time_ = 0.0;
+    }
+
+    void SetClock(Clock* clock) {
+        clock_ = clock ? clock : &system_clock_;
+    }
+
+    Clock* GetClock() {
+        return clock_;
+    }
+
+    void Input(InputType type) {
+        Pending pending;
+        pending.type = type;
+        pending.time = clock_->Now();
+        pending_.push_back(pending);
+    }
+
+    void NewFrame() {
+        new_frame_time_ = clock_->Now();
+        frame_.swap(pending_);
+        pending_.clear();
+        frame_consumed_ = false;
+    }
+
+    void Consume() {
+        if (!frame_consumed_) {
+            frame_consumed_ = true;
+            consume_time_ = clock_->Now();
+        }
+    }
+
+    void Render() {
+        render_time_ = clock_->Now();
+    }
+
+    void Present() {
+        double present_time = clock_->Now();
+        for (const Pending& input : frame_) {
+            Samples& samples = samples_[(size_t)input.type];
+            Push(samples.stage[kStageNewFrame], new_frame_time_ - input.time);
+            if (frame_consumed_) {
+                Push(samples.stage[kStageConsume], consume_time_ - input.time);
+            }
+            Push(samples.stage[kStageRender], render_time_ - input.time);
+            Push(samples.stage[kStagePresent], present_time - input.time);
+        }
+        frame_.clear();
+    }
+
+    // 뵽Presentӳٷֲ
+    LatencyStats GetStats(InputType type) {
+        return GetStats(type, kStagePresent);
+    }
+
+    LatencyStats GetStats(InputType type, Stage stage) {
+        const std::vector<double>& values = samples_[(size_t)type].stage[stage];
+        LatencyStats stats = {};
+        if (values.empty()) {
+            return stats;
+        }
+        sorted_.assign(values.begin(), values.end());
+        std::sort(sorted_.begin(), sorted_.end());
+        double sum = 0.0;
+        for (double value : sorted_) {
+            sum += value;
+        }
+        stats.count = sorted_.size();
+        stats.min = sorted_.front();
+        stats.max = sorted_.back();
+        stats.mean = sum / sorted_.size();
+        stats.p50 = Percentile(0.50);
+        stats.p90 = Percentile(0.90);
+        stats.p99 = Percentile(0.99);
+        return stats;
+    }
+
+    void Clear() {
+        for (auto& samples : samples_) {
+            for (auto& stage : samples.stage) {
+                stage.clear();
+            }
+        }
+        pending_.clear();
+        frame_.clear();
+    }
+
+private:
+    struct Pending {
+        InputType type;
+        double time;
+    };
+
+    struct Samples {
+        std::vector<double> stage[kStageCount];
+    };
+
+    // ʱһ
+    void Push(std::vector<double>& values, double value) {
+        if (values.size() >= max_samples_) {
+            values.erase(values.begin(), values.begin() + values.size() / 2);
         }
+        values.push_back(value);
+    }
+
+    double Percentile(double p) {
+        size_t index = (size_t)(p * (sorted_.size() - 1) + 0.5);
+        return sorted_[index < sorted_.size() ? index : sorted_.size() - 1];
+    }
+
+private:
+    SystemClock system_clock_;
+    Clock* clock_;
+    size_t max_samples_;
+
+    std::vector<Pending> pending_;
+    std::vector<Pending> frame_;
+    bool frame_consumed_;
+    double new_frame_time_;
+    double consume_time_;
+    double render_time_;
+
+    Samples samples_[(size_t)InputType::kCount];
+    std::vector<double> sorted_;
+};
+
+// ǰ̵߳ӳͳƣδʱΪnullptr
+inline LatencyTracker*& CurrentLatencyTracker() {
+    static thread_local LatencyTracker* tracker = nullptr;
+    return tracker;
+}
+
+static void SetLatencyTracker(LatencyTracker* tracker) {
+    CurrentLatencyTracker() = tracker;
+}
+
+// ǰ߳ѭʹõʱӣSlowDownͨȴδʱʹϵͳʱ
+inline Clock*& CurrentClock() {
+    static thread_local Clock* clock = nullptr;
+    return clock;
+}
+
+static void SetClock(Clock* clock) {
+    CurrentClock() = clock;
+}
+
+enum class Ease {
+    kLinear,
+    kInQuad,
+    kOutQuad,
+    kInOutQuad,
+    kInOutCubic,
+    // 01ٻص0˸
+    kPulse,
+};
+
+namespace internal {
+static float ApplyEase(Ease ease, float t) {
+    switch (ease) {
+    case Ease::kInQuad:
+        return t * t;
+    case Ease::kOutQuad:
+        return t * (2.0f - t);
+    case Ease::kInOutQuad:
+        return t < 0.5f ? 2.0f * t * t : -1.0f + (4.0f - 2.0f * t) * t;
+    case Ease::kInOutCubic:
+        return t < 0.5f ? 4.0f * t * t * t : (t - 1.0f) * (2.0f * t - 2.0f) * (2.0f * t - 2.0f) + 1.0f;
+    case Ease::kPulse:
+        return 0.5f - 0.5f * cosf(t * 6.28318530718f);
+    default:
+        return t;
+    }
+}
+} // namespace internal
+
+/*
+* 
+* ؼעʱĶѭNewFrame֮Updateƽж֡ĩͨGetIdleTimeout֪һҪȾʱ
+* жʱSetFrameRate֡ȾֻʣӳĶʱȵ俪ʼȫѭеȴ
+* ʱ䶼ȡClockʹFakeClockʱȷ
+*/
+class Animator {
+public:
+    typedef uint64_t Id;
+
+    static constexpr int kRepeatForever = -1;
+
+    Animator(Clock* clock = nullptr) {
+        clock_ = clock ? clock : &system_clock_;
+        frame_interval_ = 1.0 / 60.0;
+        idle_enabled_ = false;
+        next_id_ = 1;
+        animating_ = false;
+        last_update_ = clock_->Now();
+        next_start_ = std::numeric_limits<double>::infinity();
+        updating_ = false;
+        update_count_ = 0;
+    }
+
+    void SetClock(Clock* clock) {
+        clock_ = clock ? clock : &system_clock_;
+    }
+
+    Clock* GetClock() {
+        return clock_;
+    }
+
+    void SetFrameRate(double frame_rate) {
+        frame_interval_ = frame_rate > 0.0 ? 1.0 / frame_rate : 0.0;
     }
 
+    // ΪtrueʱѭûжʱֹͣȾ
+    void SetIdleEnabled(bool enabled) {
+        idle_enabled_ = enabled;
+    }
+
+    bool IsIdleEnabled() {
+        return idle_enabled_;
+    }
 
     /*
-    * Control
+    * applyĲΪĽȣһΪduration
+    * repeatΪظalternateΪtrueʱڵ
     */
-    void Click() {
-        control_click_ = true;
+    Id Start(double duration, std::function<void(float)> apply, Ease ease = Ease::kLinear, int repeat = 0, bool alternate = false, double delay = 0.0) {
+        Animation animation;
+        animation.id = next_id_++;
+        animation.start = clock_->Now() + std::max(delay, 0.0);
+        animation.duration = std::max(duration, 1e-6);
+        animation.repeat = repeat;
+        animation.alternate = alternate;
+        animation.ease = ease;
+        animation.apply = std::move(apply);
+        animation.stopped = false;
+        animations_.push_back(std::move(animation));
+        if (!updating_) {
+            Refresh(clock_->Now());
+        }
+        return animations_.back().id;
+    }
+
+    // propertyĵǰֵɵtoStop֮ǰproperty뱣Ч
+    Id Animate(Property<float>& property, float to, double duration, Ease ease = Ease::kOutQuad, double delay = 0.0) {
+        Property<float>* target = &property;
+        float from = property.Get();
+        return Start(duration, [target, from, to](float t) {
+            target->Set(from + (to - from) * t);
+        }, ease, 0, false, delay);
+    }
+
+    // property01֮˸countΪ˸
+    Id Blink(Property<float>& property, double period, int count = kRepeatForever) {
+        Property<float>* target = &property;
+        return Start(period, [target](float t) {
+            target->Set(t);
+        }, Ease::kPulse, count == kRepeatForever ? kRepeatForever : std::max(count - 1, 0));
+    }
+
+    // finishΪtrueʱȰѶƽյ
+    void Stop(Id id, bool finish = false) {
+        for (auto& animation : animations_) {
+            if (animation.id == id && !animation.stopped) {
+                if (finish) {
+                    animation.apply(internal::ApplyEase(animation.ease, FinalPhase(animation)));
+                }
+                animation.stopped = true;
+            }
+        }
+        if (!updating_) {
+            Refresh(clock_->Now());
+        }
+    }
+
+    bool IsActive(Id id) {
+        for (auto& animation : animations_) {
+            if (animation.id == id) {
+                return !animation.stopped;
+            }
+        }
+        return false;
+    }
+
+    void Update() {
+        double now = clock_->Now();
+        updating_ = true;
+        // applyп¶ֻƽεǰѴڵĶ
+        size_t count = animations_.size();
+        for (size_t i = 0; i < count; i++) {
+            Animation& animation = animations_[i];
+            if (animation.stopped || now < animation.start) {
+                continue;
+            }
+            double elapsed = now - animation.start;
+            double cycle = std::floor(elapsed / animation.duration);
+            float phase;
+            if (animation.repeat != kRepeatForever && cycle > animation.repeat) {
+                phase = FinalPhase(animation);
+                animation.stopped = true;
+            }
+            else {
+                phase = (float)((elapsed - cycle * animation.duration) / animation.duration);
+                if (animation.alternate && ((int64_t)cycle & 1)) {
+                    phase = 1.0f - phase;
+                }
+            }
+            // applyʹanimations_ݣȸƻص
+            std::function<void(float)> apply = animations_[i].apply;
+            apply(internal::ApplyEase(animations_[i].ease, phase));
+        }
+        updating_ = false;
+        last_update_ = now;
+        update_count_++;
+        Refresh(now);
+    }
+
+    bool IsAnimating() {
+        return animating_;
+    }
+
+    size_t GetActiveCount() {
+        return animations_.size();
+    }
+
+    size_t GetUpdateCount() {
+        return update_count_;
+    }
+
+    // һҪȾʱ㣬ûжʱΪ
+    double GetNextDeadline() {
+        if (animating_) {
+            return last_update_ + frame_interval_;
+        }
+        return next_start_;
+    }
+
+    // һҪȾûжʱΪ
+    double GetIdleTimeout() {
+        double deadline = GetNextDeadline();
+        if (std::isinf(deadline)) {
+            return deadline;
+        }
+        return std::max(deadline - clock_->Now(), 0.0);
     }
 
 private:
-    bool control_click_;
-    bool click_;
+    struct Animation {
+        Id id;
+        double start;
+        double duration;
+        int repeat;
+        bool alternate;
+        Ease ease;
+        std::function<void(float)> apply;
+        bool stopped;
+    };
+
+    static float FinalPhase(const Animation& animation) {
+        if (animation.alternate && animation.repeat != kRepeatForever && (animation.repeat & 1)) {
+            return 0.0f;
+        }
+        return animation.ease == Ease::kPulse ? 0.0f : 1.0f;
+    }
+
+    void Refresh(double now) {
+        animations_.erase(std::remove_if(animations_.begin(), animations_.end(), [](const Animation& animation) {
+            return animation.stopped;
+        }), animations_.end());
+        animating_ = false;
+        next_start_ = std::numeric_limits<double>::infinity();
+        for (auto& animation : animations_) {
+            if (animation.start <= now) {
+                animating_ = true;
+            }
+            else {
+                next_start_ = std::min(next_start_, animation.start);
+            }
+        }
+    }
+
+private:
+    SystemClock system_clock_;
+    Clock* clock_;
+    double frame_interval_;
+    bool idle_enabled_;
+
+    Id next_id_;
+    std::vector<Animation> animations_;
+    bool animating_;
+    double last_update_;
+    double next_start_;
+    bool updating_;
+    size_t update_count_;
 };
 
-template<class Element = std::string>
-class Combo : public Widget,
-              public Expandable
-{
-public:
-    Combo(const std::string& label) : Widget(label) {
-        end_select_index_ = -1;
-        select_index_ = -1;
+// ǰ߳ѭʹõĶȣδʱΪnullptr
+inline Animator*& CurrentAnimator() {
+    static thread_local Animator* animator = nullptr;
+    return animator;
+}
 
-        end_expand_ = false;
-        expand_ = false;
+static void SetAnimator(Animator* animator) {
+    CurrentAnimator() = animator;
+}
+
+namespace internal {
+// ؼڱ֡һȾʱ㣨ImGui::GetTimeֻԷĺ֡Ч
+struct RedrawRequest {
+    ImGuiContext* context;
+    int frame;
+    double time;
+};
+
+inline RedrawRequest& CurrentRedrawRequest() {
+    static thread_local RedrawRequest request = { nullptr, -1, 0.0 };
+    return request;
+}
+} // namespace internal
+
+// secondsȾһ֡ҪˢµĿؼеռλÿ֡
+static void RequestRedraw(double seconds = 0.0) {
+    ImGuiContext& g = *GImGui;
+    internal::RedrawRequest& request = internal::CurrentRedrawRequest();
+    double time = g.Time + std::max(seconds, 0.0);
+    if (request.context != &g || request.frame != g.FrameCount || time < request.time) {
+        request.context = &g;
+        request.frame = g.FrameCount;
+        request.time = time;
     }
+}
 
-    void Begin() {
-        Widget::Begin();
-        expand_ = ImGui::BeginCombo(GetLabel().c_str(), select_label_.c_str());
+/*
+* ImGui״̬һα仯֡ĩAnimator::GetIdleTimeoutȡСֵеȴ
+* Ŀؼͣӳ٣ʾ򣩡꾲ֹӳԼRequestRedraw󣬶ûʱΪ
+*/
+static double GetTimerTimeout() {
+    ImGuiContext& g = *GImGui;
+    if (g.ActiveId != 0) {
+        return 0.0;
+    }
+    double timeout = std::numeric_limits<double>::infinity();
+    if (g.HoverItemDelayId != 0) {
+        for (float delay : { g.Style.HoverDelayShort, g.Style.HoverDelayNormal }) {
+            if (g.HoverItemDelayTimer < delay) {
+                timeout = std::min(timeout, (double)(delay - g.HoverItemDelayTimer));
+            }
+        }
+    }
+    if (g.HoveredWindow != nullptr && g.MouseStationaryTimer < g.Style.HoverStationaryDelay) {
+        timeout = std::min(timeout, (double)(g.Style.HoverStationaryDelay - g.MouseStationaryTimer));
     }
+    internal::RedrawRequest& request = internal::CurrentRedrawRequest();
+    if (request.context == &g && request.frame == g.FrameCount) {
+        timeout = std::min(timeout, std::max(request.time - g.Time, 0.0));
+    }
+    return timeout;
+}
 
-    void End() {
-        if (expand_) {
-            ImGui::EndCombo();
+namespace internal {
+static void ConsumeInput() {
+    LatencyTracker* tracker = CurrentLatencyTracker();
+    if (tracker) {
+        tracker->Consume();
+    }
+}
+
+template<class T>
+static size_t HeapBytes(const T&) {
+    return 0;
+}
+
+static size_t HeapBytes(const std::string& str) {
+    return str.capacity() > 15 ? str.capacity() + 1 : 0;
+}
+
+template<class T>
+static size_t HeapBytes(const std::vector<T>& list) {
+    size_t bytes = list.capacity() * sizeof(T);
+    for (const T& element : list) {
+        bytes += HeapBytes(element);
+    }
+    return bytes;
+}
+} // namespace internal
+
+// ؼеĶڴ棬usedΪǰʵʹõĲ
+struct MemoryUsage {
+    const char* category;
+    size_t used;
+    size_t capacity;
+};
+
+
+namespace internal {
+// GetMemoryUsageʱֻ
+template<class T>
+static auto ContentBytes(T* content, int) -> decltype(content->GetMemoryUsage(), size_t()) {
+    return sizeof(T) + content->GetMemoryUsage().capacity;
+}
+
+template<class T>
+static size_t ContentBytes(T*, long) {
+    return sizeof(T);
+}
+} // namespace internal
+
+class Expandable;
+
+namespace internal {
+// ݵExpandableбͷʱǶ׵Expandableʹõݹ
+struct ResidentRegistry {
+    std::recursive_mutex mutex;
+    std::vector<Expandable*> contents;
+};
+
+// ǰ̳߳ݵExpandableǶĸڵлڴʱٵBeginReleaseExpiredContentsͳһʱ
+// ExpandableǼʱб߳ʱҲԭбƳ߳˳бԵǼǵExpandableִ
+inline std::shared_ptr<ResidentRegistry>& ResidentContents() {
+    static thread_local std::shared_ptr<ResidentRegistry> registry = std::make_shared<ResidentRegistry>();
+    return registry;
+}
+} // namespace internal
+
+class Expandable {
+public:
+    Expandable() {
+        end_expand_ = false;
+        expand_ = false;
+        release_delay_ = 0.0;
+        open_time_ = 0.0;
+        content_create_count_ = 0;
+        content_release_count_ = 0;
+    }
+
+    // ƳĶݣԵǼ
+    Expandable(const Expandable& other) {
+        *this = other;
+    }
+
+    Expandable& operator=(const Expandable& other) {
+        if (this == &other) {
+            return *this;
+        }
+        end_expand_ = other.end_expand_;
+        expand_ = other.expand_;
+        content_factory_ = other.content_factory_;
+        content_bytes_ = other.content_bytes_;
+        SetResident(other.content_);
+        release_delay_ = other.release_delay_;
+        open_time_ = other.open_time_;
+        content_create_count_ = other.content_create_count_;
+        content_release_count_ = other.content_release_count_;
+        return *this;
+    }
+
+    ~Expandable() {
+        SetResident(nullptr);
+    }
+
+    void ExpandUpdate(std::function<void()> update) {
+        if (expand_ == true) { 
+            update(); 
+        }
+    }
+
+    void CollapsingUpdate(std::function<void()> update) {
+        if (expand_ == false) {
+            update();
+        }
+    }
+
+    void ExpandEvent(std::function<void()> event) { \
+        if (expand_ == true && expand_ != end_expand_) {
+            event();
+        }
+    }
+    
+    void CollapsingEvent(std::function<void()> event) {
+        if (expand_ == false && expand_ != end_expand_) {
+            event();
+        }
+    }
+
+    /*
+    * Content
+    * factorystd::unique_ptr<T>״չʱ
+    * (Ϊر)release_delayͷݣٴչʱ¹
+    * ʱBeginReleaseExpiredContentsнУٵBegin(ڵ𡢴)ͬᱻͷ
+    */
+    template<class Factory>
+    void SetContentFactory(Factory factory, double release_delay = 30.0) {
+        typedef typename std::decay<decltype(factory())>::type::element_type T;
+        content_factory_ = [factory]() { return std::shared_ptr<void>(factory()); };
+        content_bytes_ = [](void* content) { return internal::ContentBytes((T*)content, 0); };
+        release_delay_ = release_delay;
+        SetResident(nullptr);
+    }
+
+    // δͷʱnullptr
+    template<class T>
+    T* GetContent() {
+        return static_cast<T*>(content_.get());
+    }
+
+    bool IsContentResident() {
+        return content_ != nullptr;
+    }
+
+    void ReleaseContent() {
+        if (content_) {
+            SetResident(nullptr);
+            content_release_count_++;
+        }
+    }
+
+    // release_delayûչʱͷ
+    void ExpireContent(double now) {
+        if (content_ && now - open_time_ >= release_delay_) {
+            ReleaseContent();
+        }
+    }
+
+    size_t GetContentBytes() {
+        return content_ ? content_bytes_(content_.get()) : 0;
+    }
+
+    MemoryUsage GetContentMemoryUsage() {
+        size_t bytes = GetContentBytes();
+        return MemoryUsage{ "content", bytes, bytes };
+    }
+
+    size_t GetContentCreateCount() {
+        return content_create_count_;
+    }
+
+    size_t GetContentReleaseCount() {
+        return content_release_count_;
+    }
+
+protected:
+    void UpdateContent(bool open) {
+        if (!content_factory_) {
+            return;
+        }
+        Clock* clock = CurrentClock();
+        double now = clock ? clock->Now() : SystemClock().Now();
+        if (open) {
+            open_time_ = now;
+            if (!content_) {
+                SetResident(content_factory_());
+                content_create_count_++;
+            }
+            return;
+        }
+        ExpireContent(now);
+    }
+
+    // ڴʱǰͷ
+    void TrimContent() {
+        if (!expand_) {
+            ReleaseContent();
+        }
+    }
+
+protected:
+    bool end_expand_;
+    bool expand_;
+
+private:
+    // ʱǼǵǰ̵߳ResidentContentsͷʱӵǼǵбƳ
+    void SetResident(std::shared_ptr<void> content) {
+        if (content_ && !content) {
+            std::shared_ptr<internal::ResidentRegistry> registry = std::move(registry_);
+            std::lock_guard<std::recursive_mutex> lock(registry->mutex);
+            auto iter = std::find(registry->contents.begin(), registry->contents.end(), this);
+            if (iter != registry->contents.end()) {
+                registry->contents.erase(iter);
+            }
+        }
+        else if (!content_ && content) {
+            registry_ = internal::ResidentContents();
+            std::lock_guard<std::recursive_mutex> lock(registry_->mutex);
+            registry_->contents.push_back(this);
+        }
+        content_ = std::move(content);
+    }
+
+private:
+    std::function<std::shared_ptr<void>()> content_factory_;
+    std::function<size_t(void*)> content_bytes_;
+    std::shared_ptr<void> content_;
+    // ʱǼڵб
+    std::shared_ptr<internal::ResidentRegistry> registry_;
+    double release_delay_;
+    // һչʱ
+    double open_time_;
+    size_t content_create_count_;
+    size_t content_release_count_;
+};
+
+// ѭÿ֡ãͷųʱδչ
+static void ReleaseExpiredContents() {
+    internal::ResidentRegistry& registry = *internal::ResidentContents();
+    std::lock_guard<std::recursive_mutex> lock(registry.mutex);
+    std::vector<Expandable*>& contents = registry.contents;
+    if (contents.empty()) {
+        return;
+    }
+    Clock* clock = CurrentClock();
+    double now = clock ? clock->Now() : SystemClock().Now();
+    // ͷʱбƳǶ׵Expandable֮ʱҲƳ
+    for (size_t i = contents.size(); i > 0; i--) {
+        if (i <= contents.size()) {
+            contents[i - 1]->ExpireContent(now);
+        }
+    }
+}
+
+    
+
+/*
+* ȡǣƺͬһ״̬
+*/
+class CancelToken {
+public:
+    CancelToken() : cancelled_(std::make_shared<std::atomic<bool>>(false)) {
+    }
+
+    void Cancel() {
+        cancelled_->store(true, std::memory_order_release);
+    }
+
+    bool IsCancelled() const {
+        return cancelled_->load(std::memory_order_acquire);
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+/*
+* ߳̿Уߵ(Vyukovʽ)
+* ߳ͨPostͶֻһԭӽȴ̣߳UI߳֡ʼʱDrainִ
+* дӿձΪǿʱѴͶWM_NULLʹеѭ
+* ִʱĿؼȻ
+* ؼ̰߳ȫģֻUI߳ʹãExpandable߳ƣӵǼʱ̵߳ResidentContentsƳ
+*/
+class CommandQueue {
+public:
+    CommandQueue() : head_(&stub_), wake_window_(nullptr), wake_pending_(false) {
+        stub_.next.store(nullptr, std::memory_order_relaxed);
+        tail_ = &stub_;
+        drain_count_ = 0;
+        last_drain_count_ = 0;
+    }
+
+    ~CommandQueue() {
+        while (Node* node = Pop()) {
+            node->destroy(node);
+        }
+    }
+
+    CommandQueue(const CommandQueue&) = delete;
+    CommandQueue& operator=(const CommandQueue&) = delete;
+
+    void SetWakeWindow(HWND hwnd) {
+        wake_window_.store(hwnd, std::memory_order_release);
+    }
+
+    HWND GetWakeWindow() {
+        return wake_window_.load(std::memory_order_acquire);
+    }
+
+    // UIִ߳ɵö
+    template<class Fn>
+    void Post(Fn&& fn) {
+        typedef CommandNode<typename std::decay<Fn>::type> Command;
+        Push(new Command(std::forward<Fn>(fn)));
+        Wake();
+    }
+
+    // UI̵߳ÿؼĿƷPost(window, &Window::Close)Post(check_box, &CheckBox::SetCheck, true)
+    template<class W, class C, class R, class... Params, class... Args>
+    void Post(W& widget, R (C::*method)(Params...), Args&&... args) {
+        C* target = &widget;
+        Post([target, method, params = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            std::apply([target, method](auto&... values) {
+                (target->*method)(values...);
+            }, params);
+        });
+    }
+
+    // رִеֻUI̵߳
+    size_t Drain() {
+        // ǣִڼͶݵٴλ
+        wake_pending_.store(false, std::memory_order_release);
+        size_t count = 0;
+        while (Node* node = Pop()) {
+            node->invoke(node);
+            node->destroy(node);
+            count++;
+        }
+        drain_count_ += count;
+        last_drain_count_ = count;
+        return count;
+    }
+
+    size_t GetDrainCount() {
+        return drain_count_;
+    }
+
+    size_t GetLastDrainCount() {
+        return last_drain_count_;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next;
+        void (*invoke)(Node*);
+        void (*destroy)(Node*);
+    };
+
+    template<class Fn>
+    struct CommandNode : Node {
+        CommandNode(Fn&& f) : fn(std::move(f)) {
+            Init();
+        }
+
+        CommandNode(const Fn& f) : fn(f) {
+            Init();
+        }
+
+        void Init() {
+            this->invoke = [](Node* node) { static_cast<CommandNode*>(node)->fn(); };
+            this->destroy = [](Node* node) { delete static_cast<CommandNode*>(node); };
+        }
+
+        Fn fn;
+    };
+
+    void Push(Node* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    Node* Pop() {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &stub_) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail_ = next;
+            return tail;
+        }
+        // ѽheadδnextһDrain
+        if (tail != head_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        Push(&stub_);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            tail_ = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+    void Wake() {
+        if (wake_pending_.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        HWND hwnd = wake_window_.load(std::memory_order_acquire);
+        if (hwnd) {
+            PostMessageW(hwnd, WM_NULL, 0, 0);
+        }
+    }
+
+private:
+    std::atomic<Node*> head_;
+    Node* tail_;
+    Node stub_;
+    std::atomic<HWND> wake_window_;
+    std::atomic<bool> wake_pending_;
+
+    size_t drain_count_;
+    size_t last_drain_count_;
+};
+
+// ǰUI̵߳УUI߳ȡú󽻸̨߳ʹ
+inline CommandQueue& GetCommandQueue() {
+    static thread_local CommandQueue queue;
+    return queue;
+}
+
+namespace internal {
+// ̨ɺѿеѭhwndͶʱUI߳ͨGetCommandQueue().GetWakeWindow()ȡ
+static void PostWake(HWND hwnd) {
+    if (hwnd) {
+        PostMessageW(hwnd, WM_NULL, 0, 0);
+    }
+}
+
+// ĺ̨̳߳أɺͶ̵߳ѭɿؼһ֡ȡ
+class WorkerPool {
+public:
+    WorkerPool(size_t thread_count) {
+        stop_ = false;
+        for (size_t i = 0; i < thread_count; i++) {
+            workers_.emplace_back([this]() { WorkerLoop(); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cond_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void Post(std::function<void()> job) {
+        HWND wake_window = GetCommandQueue().GetWakeWindow();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.push_back(Job{ std::move(job), wake_window });
+        }
+        cond_.notify_one();
+    }
+
+private:
+    struct Job {
+        std::function<void()> fn;
+        HWND wake_window;
+    };
+
+    void WorkerLoop() {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+                if (jobs_.empty()) {
+                    return;
+                }
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+            job.fn();
+            PostWake(job.wake_window);
+        }
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<Job> jobs_;
+    bool stop_;
+};
+
+inline WorkerPool& GetWorkerPool() {
+    static WorkerPool pool(std::max(2u, std::thread::hardware_concurrency()));
+    return pool;
+}
+} // namespace internal
+
+
+/*
+* ıߴ绺
+* (, ֺ, ַϣ, п)Ϊ̶зڴ
+* ͼؽȫŸıʱʧЧ
+*/
+class TextMetricsCache {
+public:
+    TextMetricsCache(size_t capacity = 4096) {
+        size_t size = 16;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        entries_.resize(size);
+        mask_ = size - 1;
+        atlas_ = nullptr;
+        tex_width_ = 0;
+        tex_height_ = 0;
+        font_count_ = 0;
+        global_scale_ = 0.0f;
+        hits_ = 0;
+        misses_ = 0;
+        Clear();
+    }
+
+    ImVec2 Measure(const char* text, const char* text_end = nullptr, float wrap_width = -1.0f) {
+        if (text_end == nullptr) {
+            text_end = text + strlen(text);
+        }
+        Validate();
+        ImFont* font = ImGui::GetFont();
+        float font_size = ImGui::GetFontSize();
+        uint64_t hash = internal::HashString64(text, text_end - text);
+        uint64_t key = hash ^ ((uint64_t)(uintptr_t)font * 0x9E3779B97F4A7C15ull);
+        uint32_t length = (uint32_t)(text_end - text);
+        size_t set = (size_t)(key ^ (key >> 29)) & mask_ & ~(size_t)(kWays - 1);
+        for (size_t i = 0; i < kWays; i++) {
+            Entry& entry = entries_[set + i];
+            if (entry.hash == hash && entry.length == length && entry.font == font && entry.font_size == font_size && entry.wrap_width == wrap_width) {
+                hits_++;
+                entry.tick = ++tick_;
+                return entry.size;
+            }
+        }
+        misses_++;
+        Entry* victim = &entries_[set];
+        for (size_t i = 1; i < kWays; i++) {
+            if (entries_[set + i].tick < victim->tick) {
+                victim = &entries_[set + i];
+            }
+        }
+        victim->hash = hash;
+        victim->length = length;
+        victim->font = font;
+        victim->font_size = font_size;
+        victim->wrap_width = wrap_width;
+        victim->size = ImGui::CalcTextSize(text, text_end, false, wrap_width);
+        victim->tick = ++tick_;
+        return victim->size;
+    }
+
+    void Clear() {
+        for (auto& entry : entries_) {
+            entry = Entry();
+        }
+        tick_ = 0;
+    }
+
+    size_t GetHitCount() {
+        return hits_;
+    }
+
+    size_t GetMissCount() {
+        return misses_;
+    }
+
+    float GetHitRate() {
+        size_t total = hits_ + misses_;
+        return total > 0 ? (float)hits_ / (float)total : 0.0f;
+    }
+
+    void ResetStats() {
+        hits_ = 0;
+        misses_ = 0;
+    }
+
+private:
+    static const size_t kWays = 4;
+
+    struct Entry {
+        Entry() {
+            hash = 0;
+            length = UINT32_MAX;
+            font = nullptr;
+            font_size = 0.0f;
+            wrap_width = 0.0f;
+            tick = 0;
+        }
+
+        uint64_t hash;
+        uint32_t length;
+        ImFont* font;
+        float font_size;
+        float wrap_width;
+        ImVec2 size;
+        uint64_t tick;
+    };
+
+    void Validate() {
+        ImGuiIO& io = ImGui::GetIO();
+        ImFontAtlas* atlas = io.Fonts;
+        if (atlas != atlas_ || atlas->TexWidth != tex_width_ || atlas->TexHeight != tex_height_ ||
+            atlas->Fonts.Size != font_count_ || io.FontGlobalScale != global_scale_) {
+            atlas_ = atlas;
+            tex_width_ = atlas->TexWidth;
+            tex_height_ = atlas->TexHeight;
+            font_count_ = atlas->Fonts.Size;
+            global_scale_ = io.FontGlobalScale;
+            Clear();
+        }
+    }
+
+private:
+    std::vector<Entry> entries_;
+    size_t mask_;
+    uint64_t tick_;
+
+    ImFontAtlas* atlas_;
+    int tex_width_;
+    int tex_height_;
+    int font_count_;
+    float global_scale_;
+
+    size_t hits_;
+    size_t misses_;
+};
+
+// ÿ߳(ÿ)һ
+inline TextMetricsCache& GetTextMetricsCache() {
+    static thread_local TextMetricsCache cache;
+    return cache;
+}
+
+namespace internal {
+// ûĳߴһпѡеıSelectableֻʹرǩ
+static bool CachedSelectable(int id, const char* text, const char* text_end, bool selected) {
+    // Selectableһ£ʾ"##"֮Ĳ
+    text_end = ImGui::FindRenderedTextEnd(text, text_end);
+    // SelectableıƵǰеĻߣItemSizeıȣԶСˮƽʾǩʱһ
+    ImVec2 pos = ImGui::GetCursorScreenPos();
+    pos.y += ImGui::GetCurrentWindow()->DC.CurrLineTextBaseOffset;
+    ImVec2 size = GetTextMetricsCache().Measure(text, text_end);
+    ImGui::PushID(id);
+    bool pressed = ImGui::Selectable("##row", selected, ImGuiSelectableFlags_SpanAvailWidth, size);
+    ImGui::PopID();
+    if (ImGui::IsRectVisible(pos, ImVec2(pos.x + size.x, pos.y + size.y))) {
+        ImGui::GetWindowDrawList()->AddText(pos, ImGui::GetColorU32(ImGuiCol_Text), text, text_end);
+    }
+    return pressed;
+}
+} // namespace internal
+
+
+/*
+* Eventԭ
+* ǰ֡ControlлEventӰĳҪһܴ֡
+*/
+
+class Widget;
+
+namespace internal {
+// δκWindowлƹĿؼControlü뱾߳WindowĻ汾
+inline uint64_t& ControlVersion() {
+    static thread_local uint64_t version = 0;
+    return version;
+}
+
+// ؼԴؼʱñÿգƶؼʱ֮ת
+class WidgetRef {
+public:
+    WidgetRef() {
+    }
+
+    WidgetRef(const WidgetRef&) {
+    }
+
+    WidgetRef& operator=(const WidgetRef&) {
+        return *this;
+    }
+
+    ~WidgetRef() {
+        if (ref_) {
+            *ref_ = nullptr;
+        }
+    }
+
+    // ״εʱŷ
+    const std::shared_ptr<Widget*>& Get(Widget* widget) {
+        if (!ref_) {
+            ref_ = std::make_shared<Widget*>(widget);
+        }
+        return ref_;
+    }
+
+private:
+    std::shared_ptr<Widget*> ref_;
+};
+} // namespace internal
+
+class Widget {
+public:
+    Widget(const std::string& label) : label_(label) {
+        entry_disabled_ = false;
+        end_disabled_ = false;
+        disabled_ = false;
+        init_ = false;
+    }
+
+    void Begin() {
+        const std::shared_ptr<internal::ControlScope>& scope = internal::CurrentControlScope();
+        if (scope_ != scope) {
+            scope_ = scope;
+        }
+        if (restore_) {
+            std::function<void()> restore = std::move(restore_);
+            restore_ = nullptr;
+            restore();
+        }
+        disabled_binding_.Pull(disabled_);
+        if (disabled_) {
+            ImGui::BeginDisabled();
+            entry_disabled_ = true;
+        }
+        else {
+            entry_disabled_ = false;
+        }
+    }
+
+    void End() {
+        end_disabled_ = disabled_;
+        if (entry_disabled_) {
+            ImGui::EndDisabled();
+        }
+    }
+
+
+    void InitEvent(std::function<void()> init) {
+        if (!init_) {
+            init_ = true;
+            init();
+        }
+    }
+
+    void DisableEvent(std::function<void()> event) {
+        if (disabled_ == true && disabled_ != end_disabled_) {
+            event();
+        }
+    }
+
+
+    void EnableEvent(std::function<void()> event) {
+        if (disabled_ == false && disabled_ != end_disabled_) {
+            event();
+        }
+    }
+
+
+    const std::string& GetLabel() {
+        return label_;
+    }
+
+    void SetLabel(const std::string& label) {
+        if (label_ != label) {
+            BumpControlVersion();
+            label_ = label;
+        }
+    }
+
+    void SetDisable(bool disabled) {
+        if (disabled_ != disabled) {
+            BumpControlVersion();
+        }
+        disabled_ = disabled;
+        disabled_binding_.Push(disabled);
+    }
+
+    void Disable() {
+        SetDisable(true);
+    }
+
+    void Enable() {
+        SetDisable(false);
+    }
+
+    void BindDisable(Property<bool>& disabled) {
+        disabled_binding_.Bind(&disabled);
+    }
+
+    // 첽жϿؼǷȻڣؼõֵΪnullptr
+    const std::shared_ptr<Widget*>& GetRef() {
+        return ref_.Get(this);
+    }
+
+    /*
+    * Snapshot
+    * restore״BeginʱִУӳٻָỰ״̬
+    */
+    void SetRestore(std::function<void()> restore) {
+        restore_ = std::move(restore);
+    }
+
+    void SaveState(internal::SnapshotWriter& writer) {
+        writer.Write(disabled_);
+    }
+
+    /*
+    * Memory
+    */
+    MemoryUsage GetMemoryUsage() {
+        size_t bytes = internal::HeapBytes(label_);
+        return MemoryUsage{ "label", bytes, bytes };
+    }
+
+    void TrimMemory() {
+    }
+
+    void LoadState(internal::SnapshotReader& reader) {
+        bool disabled;
+        if (reader.Read(disabled)) {
+            SetDisable(disabled);
+        }
+    }
+
+protected:
+    // Control޸˿ؼ״̬ʹWindowĻʧЧδƹĿؼʹ߳WindowĻʧЧ
+    void BumpControlVersion() {
+        if (scope_) {
+            scope_->version++;
+        }
+        else {
+            internal::ControlVersion()++;
+        }
+    }
+
+private:
+    std::string label_;
+    std::function<void()> restore_;
+    internal::WidgetRef ref_;
+    // һBeginʱWindow
+    std::shared_ptr<internal::ControlScope> scope_;
+
+    bool init_;
+
+    bool entry_disabled_;
+    bool end_disabled_;
+    bool disabled_;
+    internal::Binding<bool> disabled_binding_;
+};
+
+
+
+struct DrawCacheStats {
+    size_t hits;
+    size_t misses;
+    // ͣ޷ʱֱ
+    size_t bypasses;
+};
+
+namespace internal {
+/*
+* һλʱһ¼Ƶļ׷ӵǰбؼĸ
+* ֶα涥طʱ¼ַ16λΧʱPrimReserveлVtxOffset
+*/
+class DrawListCache {
+public:
+    DrawListCache() {
+        valid_ = false;
+        key_ = 0;
+        stats_ = {};
+    }
+
+    void Invalidate() {
+        valid_ = false;
+    }
+
+    // trueʾѻطţupdate
+    bool Replay(uint64_t key) {
+        if (!valid_ || key != key_) {
+            return false;
+        }
+        ImGuiWindow* window = ImGui::GetCurrentWindow();
+        ImDrawList* draw_list = window->DrawList;
+        for (auto& segment : segments_) {
+            draw_list->PushClipRect(ImVec2(segment.clip_rect.x, segment.clip_rect.y), ImVec2(segment.clip_rect.z, segment.clip_rect.w), false);
+            draw_list->PushTextureID(segment.texture);
+            draw_list->PrimReserve(segment.idx_count, segment.vtx_count);
+            unsigned int base = draw_list->_VtxCurrentIdx;
+            memcpy(draw_list->_VtxWritePtr, vtx_.data() + segment.vtx_first, segment.vtx_count * sizeof(ImDrawVert));
+            const uint16_t* idx = idx_.data() + segment.idx_first;
+            for (int i = 0; i < segment.idx_count; i++) {
+                draw_list->_IdxWritePtr[i] = (ImDrawIdx)(base + idx[i]);
+            }
+            draw_list->_VtxWritePtr += segment.vtx_count;
+            draw_list->_IdxWritePtr += segment.idx_count;
+            draw_list->_VtxCurrentIdx += segment.vtx_count;
+            draw_list->PopTextureID();
+            draw_list->PopClipRect();
+        }
+        // ָ֣ʹݳߴ硢ԶСʵʱһ
+        ImGuiWindowTempData& dc = window->DC;
+        dc.CursorPos = layout_.CursorPos;
+        dc.CursorPosPrevLine = layout_.CursorPosPrevLine;
+        dc.CursorMaxPos = ImMax(dc.CursorMaxPos, layout_.CursorMaxPos);
+        dc.IdealMaxPos = ImMax(dc.IdealMaxPos, layout_.IdealMaxPos);
+        dc.CurrLineSize = layout_.CurrLineSize;
+        dc.PrevLineSize = layout_.PrevLineSize;
+        dc.CurrLineTextBaseOffset = layout_.CurrLineTextBaseOffset;
+        dc.PrevLineTextBaseOffset = layout_.PrevLineTextBaseOffset;
+        stats_.hits++;
+        return true;
+    }
+
+    // update¼
+    void Record(uint64_t key, const std::function<void()>& update) {
+        ImGuiWindow* window = ImGui::GetCurrentWindow();
+        ImDrawList* draw_list = window->DrawList;
+        int cmd_start = draw_list->CmdBuffer.Size - 1;
+        unsigned int elem_start = draw_list->CmdBuffer.back().ElemCount;
+        int child_count = window->DC.ChildWindows.Size;
+        int channel = draw_list->_Splitter._Current;
+
+        update();
+
+        valid_ = false;
+        // Ӵں͵ԼĻбͨеУЩ
+        if (window->DrawList != draw_list || window->DC.ChildWindows.Size != child_count || draw_list->_Splitter._Current != channel) {
+            stats_.bypasses++;
+            return;
+        }
+        segments_.clear();
+        vtx_.clear();
+        idx_.clear();
+        for (int i = cmd_start; i < draw_list->CmdBuffer.Size; i++) {
+            const ImDrawCmd& cmd = draw_list->CmdBuffer[i];
+            if (cmd.UserCallback != nullptr) {
+                stats_.bypasses++;
+                return;
+            }
+            unsigned int begin = cmd.IdxOffset + (i == cmd_start ? elem_start : 0);
+            unsigned int end = cmd.IdxOffset + cmd.ElemCount;
+            if (begin >= end) {
+                continue;
+            }
+            unsigned int min_vtx = UINT32_MAX;
+            unsigned int max_vtx = 0;
+            for (unsigned int j = begin; j < end; j++) {
+                unsigned int v = draw_list->IdxBuffer[j];
+                min_vtx = std::min(min_vtx, v);
+                max_vtx = std::max(max_vtx, v);
+            }
+            if (max_vtx - min_vtx >= 0xFFFF) {
+                stats_.bypasses++;
+                return;
+            }
+            Segment segment;
+            segment.clip_rect = cmd.ClipRect;
+            segment.texture = cmd.GetTexID();
+            segment.vtx_first = (int)vtx_.size();
+            segment.vtx_count = (int)(max_vtx - min_vtx + 1);
+            segment.idx_first = (int)idx_.size();
+            segment.idx_count = (int)(end - begin);
+            const ImDrawVert* vtx = draw_list->VtxBuffer.Data + cmd.VtxOffset + min_vtx;
+            vtx_.insert(vtx_.end(), vtx, vtx + segment.vtx_count);
+            for (unsigned int j = begin; j < end; j++) {
+                idx_.push_back((uint16_t)(draw_list->IdxBuffer[j] - min_vtx));
+            }
+            segments_.push_back(segment);
+        }
+        ImGuiWindowTempData& dc = window->DC;
+        layout_.CursorPos = dc.CursorPos;
+        layout_.CursorPosPrevLine = dc.CursorPosPrevLine;
+        layout_.CursorMaxPos = dc.CursorMaxPos;
+        layout_.IdealMaxPos = dc.IdealMaxPos;
+        layout_.CurrLineSize = dc.CurrLineSize;
+        layout_.PrevLineSize = dc.PrevLineSize;
+        layout_.CurrLineTextBaseOffset = dc.CurrLineTextBaseOffset;
+        layout_.PrevLineTextBaseOffset = dc.PrevLineTextBaseOffset;
+        key_ = key;
+        valid_ = true;
+        stats_.misses++;
+    }
+
+    void Bypass(const std::function<void()>& update) {
+        valid_ = false;
+        stats_.bypasses++;
+        update();
+    }
+
+    const DrawCacheStats& GetStats() {
+        return stats_;
+    }
+
+    void Clear() {
+        valid_ = false;
+        std::vector<Segment>().swap(segments_);
+        std::vector<ImDrawVert>().swap(vtx_);
+        std::vector<uint16_t>().swap(idx_);
+    }
+
+    size_t GetMemoryBytes() {
+        return HeapBytes(segments_) + HeapBytes(vtx_) + HeapBytes(idx_);
+    }
+
+private:
+    struct Segment {
+        ImVec4 clip_rect;
+        ImTextureID texture;
+        int vtx_first;
+        int vtx_count;
+        int idx_first;
+        int idx_count;
+    };
+
+    struct Layout {
+        ImVec2 CursorPos;
+        ImVec2 CursorPosPrevLine;
+        ImVec2 CursorMaxPos;
+        ImVec2 IdealMaxPos;
+        ImVec2 CurrLineSize;
+        ImVec2 PrevLineSize;
+        float CurrLineTextBaseOffset;
+        float PrevLineTextBaseOffset;
+    };
+
+    bool valid_;
+    uint64_t key_;
+    std::vector<Segment> segments_;
+    std::vector<ImDrawVert> vtx_;
+    std::vector<uint16_t> idx_;
+    Layout layout_;
+
+    DrawCacheStats stats_;
+};
+} // namespace internal
+
+class Window : public Widget,
+               public Expandable
+{
+public:
+    Window(const std::string& label, bool main = false, bool create = true, ImGuiWindowFlags flags = 0) : Widget(label) {
+        window_ = nullptr;
+        main_ = main;
+        end_top_ = true;
+        top_ = false;
+        control_create_ = false;
+        control_close_ = false;
+        end_create_ = false;
+        create_ = create;
+
+        entry_ = false;
+
+        end_flags_ = flags;
+        flags_ = flags;
+
+        cacheable_ = false;
+        cache_version_ = 0;
+        scope_ = std::make_shared<internal::ControlScope>();
+    }
+
+    ~Window() {
+        cancel_.Cancel();
+    }
+
+    void Begin() {
+        Widget::Begin();
+        outer_scope_ = std::move(internal::CurrentControlScope());
+        internal::CurrentControlScope() = scope_;
+        
+        if (window_ == nullptr) {
+            window_ = ImGui::FindWindowByName(GetLabel().c_str());
+        }
+
+        if (end_top_ != top_) {
+            if (internal::SetWindowTop(window_, top_)) {
+                end_top_ = top_;
+            }
+        }
+
+        if (control_create_) {
+            create_ = true;
+            control_create_ = false;
+        }
+        if (control_close_) {
+            create_ = false;
+            control_close_ = false;
+        }
+
+        if (create_) {
+            entry_ = true;
+            expand_ = ImGui::Begin(GetLabel().c_str(), &create_, flags_);
+        }
+        if (create_ == true && create_ != end_create_) {
+            // ÿ¿ڶҪtop״̬
+            end_top_ = !top_;
+        }
+        UpdateContent(create_ && expand_);
+    }
+
+    void End() {
+        if (entry_) {
+            ImGui::End();
+            entry_ = false;
+        }
+        internal::CurrentControlScope() = std::move(outer_scope_);
+        if (end_create_ == true && create_ == false) {
+            // رʱȡ󶨵ڵЭ̶¿ʹµı
+            cancel_.Cancel();
+            cancel_ = CancelToken();
+        }
+        end_create_ = create_;
+        if (create_ == false) {
+            if (main_) {
+                ExitApplication();
+            }
+        }
+        end_expand_ = expand_;
+        Widget::End();
+    }
+
+    /*
+    * Update
+    */
+    void CreateUpdate(std::function<void()> event) {
+        if (create_) {
+            event();
+        }
+    }
+
+    void CloseUpdate(std::function<void()> close) {
+        if (!create_) {
+            close();
+        }
+    }
+
+    // ExpandUpdateͬ벻ʱطһ֡Ļupdate
+    void CacheUpdate(std::function<void()> update) {
+        if (!expand_) {
+            return;
+        }
+        if (!cacheable_) {
+            update();
+            return;
+        }
+        // ͣʱؼиʾ϶͵ڼؼ״̬֡仯ֱ
+        ImGuiContext& g = *GImGui;
+        ImGuiWindow* window = ImGui::GetCurrentWindow();
+        bool active = g.ActiveIdWindow != nullptr && g.ActiveIdWindow->RootWindow == window->RootWindow;
+        bool nav = g.NavWindow != nullptr && g.NavWindow->RootWindow == window->RootWindow;
+        if (active || nav || ImGui::IsWindowHovered(ImGuiHoveredFlags_ChildWindows)) {
+            cache_.Bypass(update);
+            return;
+        }
+        uint64_t key = CacheKey();
+        if (ContentVersion() == cache_version_ && cache_.Replay(key)) {
+            return;
+        }
+        scope_->bound.clear();
+        scope_->collecting = true;
+        cache_.Record(key, update);
+        scope_->collecting = false;
+        // update֮ȡ汾updateControlúдPropertyʹһ֡ĻʧЧ
+        cache_version_ = ContentVersion();
+    }
+
+
+    /*
+    * Event
+    */
+
+    void CreateEvent(std::function<void()> event) {
+        if (end_create_ == false && create_ == true) {
+            event();
+        }
+    }
+
+    void CloseEvent(std::function<void()> event) {
+        if (end_create_ == true && create_ == false) {
+            event();
+        }
+    }
+
+
+    /*
+    * Control
+    */
+    void Create() {
+        control_create_ = true;
+    }
+
+    void Close() {
+        control_close_ = true;
+    }
+
+    // ڹرջʱ
+    const CancelToken& GetCancelToken() {
+        return cancel_;
+    }
+
+
+    /*
+    * Cache
+    * λáСʽ塢ԼCacheDependǼǵPropertyİ汾
+    * ¼ƺ󱾴ڿؼControlá¼ʱȡİProperty޸ĶʹʧЧڲӰ
+    * δƹĿؼControlʹ߳дڵĻʧЧؼڲԴȡ״̬ҪCacheDependInvalidateCache
+    */
+    void SetCacheable(bool cacheable) {
+        cacheable_ = cacheable;
+        if (!cacheable) {
+            cache_.Clear();
+        }
+    }
+
+    // propertyڴڴڼ뱣Ч
+    template<class T>
+    void CacheDepend(const Property<T>& property) {
+        const Property<T>* p = &property;
+        cache_depends_.push_back([p]() { return p->GetVersion(); });
+    }
+
+    void InvalidateCache() {
+        cache_.Invalidate();
+    }
+
+    const DrawCacheStats& GetCacheStats() {
+        return cache_.GetStats();
+    }
+
+
+    /*
+    * Memory
+    */
+    MemoryUsage GetMemoryUsage() {
+        MemoryUsage usage = Widget::GetMemoryUsage();
+        size_t bytes = GetContentBytes() + cache_.GetMemoryBytes();
+        usage.used += bytes;
+        usage.capacity += bytes;
+        return usage;
+    }
+
+    void TrimMemory() {
+        TrimContent();
+    }
+
+
+    ImGuiWindowFlags GetFlags() {
+        return flags_;
+    }
+
+    void SetFlags(ImGuiWindowFlags flags) {
+        flags_ = flags;
+    }
+
+    void AddFlags(ImGuiWindowFlags flags) {
+        flags_ |= flags;
+    }
+
+    void UnaddFlags(ImGuiWindowFlags flags) {
+        flags_ &= (~flags);;
+    }
+
+
+    void SetTop(bool top) {
+        top_ = top;
+    }
+
+    void SetDocking(bool enable){
+        if (enable) {
+            UnaddFlags(ImGuiWindowFlags_NoDocking);
+        }
+        else {
+            AddFlags(ImGuiWindowFlags_NoDocking);
+        }
+    }
+
+    void SetAlwaysAutoResize(bool enable) {
+        if (enable) {
+            AddFlags(ImGuiWindowFlags_AlwaysAutoResize);
+        }
+        else {
+            UnaddFlags(ImGuiWindowFlags_AlwaysAutoResize);
+        }
+    }
+
+    void SetMove(bool enable) {
+        if (enable) {
+            UnaddFlags(ImGuiWindowFlags_NoMove);
+        }
+        else {
+            AddFlags(ImGuiWindowFlags_NoMove);
+        }
+    }
+
+    void SetCollapse(bool enable) {
+        if (enable) {
+            UnaddFlags(ImGuiWindowFlags_NoCollapse);
+        }
+        else {
+            AddFlags(ImGuiWindowFlags_NoCollapse);
+        }
+    }
+
+
+    /*
+    * Snapshot
+    */
+    void SaveState(internal::SnapshotWriter& writer) {
+        Widget::SaveState(writer);
+        writer.Write(create_);
+        writer.Write(top_);
+        writer.Write(flags_);
+    }
+
+    void LoadState(internal::SnapshotReader& reader) {
+        Widget::LoadState(reader);
+        reader.Read(create_);
+        reader.Read(top_);
+        reader.Read(flags_);
+    }
+
+private:
+    uint64_t CacheKey() {
+        struct State {
+            ImVec2 pos;
+            ImVec2 size;
+            ImVec2 scroll;
+            ImVec2 cursor;
+            ImFont* font;
+            float font_size;
+            ImTextureID atlas;
+            bool focused;
+        };
+        ImGuiWindow* window = ImGui::GetCurrentWindow();
+        State state;
+        memset(&state, 0, sizeof(state));
+        state.pos = window->Pos;
+        state.size = window->Size;
+        state.scroll = window->Scroll;
+        state.cursor = window->DC.CursorPos;
+        state.font = ImGui::GetFont();
+        state.font_size = ImGui::GetFontSize();
+        state.atlas = ImGui::GetIO().Fonts->TexID;
+        state.focused = ImGui::IsWindowFocused(ImGuiFocusedFlags_ChildWindows);
+        uint64_t key = internal::HashBytes64(&ImGui::GetStyle(), sizeof(ImGuiStyle), 0);
+        key = internal::HashBytes64(&state, sizeof(state), key);
+        for (auto& depend : cache_depends_) {
+            uint64_t version = depend();
+            key = internal::HashBytes64(&version, sizeof(version), key);
+        }
+        return key;
+    }
+
+    // ڿؼControlüδƹĿؼControlüԼ¼ʱǼǵİPropertyİ汾
+    uint64_t ContentVersion() {
+        uint64_t versions[2] = { scope_->version, internal::ControlVersion() };
+        uint64_t key = internal::HashBytes64(versions, sizeof(versions), 0);
+        for (auto& ref : scope_->bound) {
+            uint64_t version = *ref ? **ref : UINT64_MAX;
+            key = internal::HashBytes64(&version, sizeof(version), key);
+        }
+        return key;
+    }
+
+private:
+    ImGuiWindow* window_;
+
+    bool main_;
+    bool entry_;
+    bool end_top_;
+    bool top_;
+
+    bool control_close_;
+    bool control_create_;
+    bool end_create_;
+    bool create_;
+
+    ImGuiWindowFlags end_flags_;
+    ImGuiWindowFlags flags_;
+
+    CancelToken cancel_;
+
+    bool cacheable_;
+    internal::DrawListCache cache_;
+    std::vector<std::function<uint64_t()>> cache_depends_;
+    // ڿؼouter_scope_Begin֮ǰEndʱָ
+    std::shared_ptr<internal::ControlScope> scope_;
+    std::shared_ptr<internal::ControlScope> outer_scope_;
+    // ¼ʱݰ汾
+    uint64_t cache_version_;
+};
+
+class Button : public Widget {
+public:
+    Button(const std::string& label) : Widget(label) {
+        click_ = false;
+        control_click_ = false;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        click_ = ImGui::Button(GetLabel().c_str());
+        if (control_click_) {
+            click_ = true;
+            control_click_ = false;
+        }
+    }
+
+    void End() {
+        Widget::End();
+    }
+
+    /*
+    * Event
+    */
+    void ClickEvent(std::function<void()> event) {
+        if (click_ == true) {
+            internal::ConsumeInput();
+            event();
+        }
+    }
+
+
+    /*
+    * Control
+    */
+    void Click() {
+        BumpControlVersion();
+        control_click_ = true;
+    }
+
+private:
+    bool control_click_;
+    bool click_;
+};
+
+template<class Element = std::string>
+class Combo : public Widget,
+              public Expandable
+{
+public:
+    Combo(const std::string& label) : Widget(label) {
+        end_select_index_ = -1;
+        select_index_ = -1;
+        label_index_ = -1;
+
+        end_expand_ = false;
+        expand_ = false;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        select_binding_.Pull(select_index_);
+        if (label_index_ != select_index_) {
+            UpdateSelectLabel();
+        }
+        expand_ = ImGui::BeginCombo(GetLabel().c_str(), select_label_.c_str());
+        UpdateContent(expand_);
+    }
+
+    void End() {
+        if (expand_) {
+            ImGui::EndCombo();
+        }
+        end_expand_ = expand_;
+        end_select_index_ = select_index_;
+        Widget::End();
+    }
+
+    /*
+    * Update
+    */
+    void InsertUpdate(std::function<std::string(Element&)> insert) {
+        if (expand_ == false) {
+            return;
+        }
+        insert_ = insert;
+        for (int i = 0; i < list_.size(); i++) {
+            const bool is_selected = (select_index_ == i);
+            auto temp = insert(list_[i]);
+
+            if (temp.empty()) {
+                continue;
+            }
+
+            if (internal::CachedSelectable(i, temp.c_str(), temp.c_str() + temp.size(), is_selected)) {
+                select_index_ = i;
+                select_label_ = temp;
+                label_index_ = i;
+                select_binding_.Push(select_index_);
+            }
+
+            if (is_selected) {
+                if (select_label_ != temp) {
+                    select_label_ = temp;
+                }
+                label_index_ = i;
+                ImGui::SetItemDefaultFocus();
+            }
+        }
+        
+    }
+
+    /*
+    * Event
+    */
+    void SelectEvent(std::function<void()> event) {
+        if (end_select_index_ != select_index_) {
+            internal::ConsumeInput();
+            event();
+        }
+    }
+
+
+    /*
+    * Control
+    */
+    Element& GetSelectItem() {
+        return list_.at(select_index_);
+    }
+
+    int GetSelectIndex() {
+        return select_index_;
+    }
+
+    void SetSelectIndex(int select_index) {
+        BumpControlVersion();
+        select_index_ = select_index;
+        select_binding_.Push(select_index);
+    }
+
+    void BindSelectIndex(Property<int>& select_index) {
+        select_binding_.Bind(&select_index);
+    }
+
+    void SaveState(internal::SnapshotWriter& writer) {
+        Widget::SaveState(writer);
+        writer.Write(select_index_);
+    }
+
+    void LoadState(internal::SnapshotReader& reader) {
+        Widget::LoadState(reader);
+        int select_index;
+        if (reader.Read(select_index)) {
+            SetSelectIndex(select_index);
+        }
+    }
+
+    void SetList(std::vector<Element>&& list) {
+        BumpControlVersion();
+        list_ = std::move(list);
+        label_index_ = -2;
+    }
+
+    std::vector<Element>& GetList() {
+        return list_;
+    }
+
+    void ClearList() {
+        BumpControlVersion();
+        list_.clear();
+        label_index_ = -2;
+    }
+
+    /*
+    * Memory
+    */
+    MemoryUsage GetMemoryUsage() {
+        size_t capacity = internal::HeapBytes(list_);
+        size_t used = capacity - (list_.capacity() - list_.size()) * sizeof(Element);
+        size_t content = GetContentBytes();
+        return MemoryUsage{ "list", used + content, capacity + content };
+    }
+
+    void TrimMemory() {
+        list_.shrink_to_fit();
+        TrimContent();
+    }
+
+private:
+    // ѡⲿıʱһInsertUpdateĻصԤı
+    void UpdateSelectLabel() {
+        if (select_index_ >= 0 && select_index_ < (int)list_.size()) {
+            if (insert_) {
+                select_label_ = insert_(list_[select_index_]);
+            }
+            else if constexpr (std::is_convertible<const Element&, std::string>::value) {
+                select_label_ = list_[select_index_];
+            }
+            else {
+                return;
+            }
+        }
+        else {
+            select_label_.clear();
+        }
+        label_index_ = select_index_;
+    }
+
+private:
+    std::vector<Element> list_;
+    int end_select_index_;
+    int select_index_;
+    std::string select_label_;
+    // select_label_Ӧѡб滻Ϊ-2ǿˢ
+    int label_index_;
+    std::function<std::string(Element&)> insert_;
+    internal::Binding<int> select_binding_;
+
+};
+
+class InputText : public Widget {
+public:
+    InputText(const std::string& label, size_t text_size) : Widget(label), text_(text_size, '\0') {
+        end_input_ = false;
+        input_ = false;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        std::string text;
+        if (text_binding_.Pull(text)) {
+            WriteText(text);
+        }
+        if (ImGui::InputText(GetLabel().c_str(), (char*)text_.c_str(), text_.size())) {
+            input_ = true;
+            text_binding_.Push(GetText());
+        } else {
+            input_ = false;
+        }
+    }
+
+    void End() {
+        end_input_ = input_;
+        Widget::End();
+    }
+
+    /*
+    * Event
+    */
+    void InputEvent(std::function<void()> event) {
+        if (input_ == true && input_ != end_input_) {
+            internal::ConsumeInput();
+            event();
+        }
+    }
+
+    std::string GetText() {
+        return std::string(text_.c_str(), strlen(text_.c_str()));
+    }
+
+    void SetText(const std::string& text) {
+        BumpControlVersion();
+        WriteText(text);
+        text_binding_.Push(GetText());
+    }
+
+    void BindText(Property<std::string>& text) {
+        text_binding_.Bind(&text);
+    }
+
+private:
+    // ĩβ'\0'ֽض
+    void WriteText(const std::string& text) {
+        if (text_.empty()) {
+            return;
+        }
+        size_t len = text_.size() - 1 < text.size() ? text_.size() - 1 : text.size();
+        memcpy(&text_[0], text.c_str(), len);
+        memset(&text_[len], 0, text_.size() - len);
+    }
+
+private:
+    std::string text_;
+
+    bool end_input_;
+    bool input_;
+    internal::Binding<std::string> text_binding_;
+};
+
+class InputTextMultiline : public Widget {
+public:
+    InputTextMultiline(const std::string& label, const std::string& text = "", ImGuiInputTextFlags flags = 0) : Widget(label), size_(-FLT_MIN, -FLT_MIN) {
+        end_input_ = false;
+        input_ = false;
+
+        flags_ = flags | ImGuiInputTextFlags_CallbackResize;
+        SetText(text);
+    }
+
+    void Begin() {
+        if (text_.empty()) {
+            text_.push_back('\0');
+        }
+        Widget::Begin();
+        if (ImGui::InputTextMultiline(GetLabel().c_str(), text_.begin(), text_.size(), size_, flags_, ResizeCallback, &text_)) {
+            input_ = true;
+        }
+        else {
+            input_ = false;
+        }
+    }
+
+    void End() {
+        end_input_ = input_;
+        Widget::End();
+    }
+
+    /*
+    * Event
+    */
+    void InputEvent(std::function<void()> event) {
+        if (input_ == true && input_ != end_input_) {
+            internal::ConsumeInput();
+            event();
+        }
+    }
+
+    std::string GetText() {
+        return std::string(&text_[0], strlen(&text_[0]));
+    }
+
+    void SetText(const std::string& text) {
+        BumpControlVersion();
+        text_.clear();
+        text_.resize(text.size() + 1);
+        memcpy(&text_[0], &text[0], text.size() + 1);
+    }
+
+    void SetSize(const ImVec2& size) {
+        BumpControlVersion();
+        size_ = size;
+    }
+
+    ImVec2& GetSize() {
+        return size_;
+    }
+
+    void SetReadOnly(bool enable) {
+        BumpControlVersion();
+        if (enable) {
+            flags_ |= ImGuiInputTextFlags_ReadOnly;
+        }
+        else {
+            flags_ &= (~ImGuiInputTextFlags_ReadOnly);
+        }
+    }
+
+    /*
+    * Memory
+    */
+    MemoryUsage GetMemoryUsage() {
+        size_t used = text_.Size > 0 ? strlen(text_.Data) + 1 : 0;
+        return MemoryUsage{ "text", used, (size_t)text_.Capacity };
+    }
+
+    // ֻ֮֡֡
+    void TrimMemory() {
+        size_t used = text_.Size > 0 ? strlen(text_.Data) + 1 : 1;
+        if ((size_t)text_.Capacity <= used) {
+            return;
+        }
+        ImVector<char> text;
+        text.resize((int)used);
+        memcpy(text.Data, text_.Size > 0 ? text_.Data : "", used);
+        text_.swap(text);
+    }
+
+private:
+    static int ResizeCallback(ImGuiInputTextCallbackData* data) {
+        if (data->EventFlag == ImGuiInputTextFlags_CallbackResize) {
+            ImVector<char>* my_str = (ImVector<char>*)data->UserData;
+            IM_ASSERT(my_str->begin() == data->Buf);
+            my_str->resize(data->BufSize); // NB: On resizing calls, generally data->BufSize == data->BufTextLen + 1
+            data->Buf = my_str->begin();
+        }
+        return 0;
+    }
+
+private:
+    ImVector<char> text_;
+
+    bool end_input_;
+    bool input_;
+
+    ImVec2 size_;
+
+    ImGuiInputTextFlags flags_;
+};
+
+namespace internal {
+/*
+* ϶ͬһλøɾֻҪƶ϶
+*/
+template<class T>
+class GapBuffer {
+public:
+    GapBuffer() {
+        gap_begin_ = 0;
+        gap_end_ = 0;
+    }
+
+    size_t Size() const {
+        return buffer_.size() - (gap_end_ - gap_begin_);
+    }
+
+    T& operator[](size_t index) {
+        return index < gap_begin_ ? buffer_[index] : buffer_[index + (gap_end_ - gap_begin_)];
+    }
+
+    void Insert(size_t index, T value) {
+        MoveGap(index);
+        if (gap_begin_ == gap_end_) {
+            Grow(1);
+        }
+        buffer_[gap_begin_++] = std::move(value);
+    }
+
+    void Erase(size_t index, size_t count = 1) {
+        MoveGap(index);
+        for (size_t i = 0; i < count; i++) {
+            buffer_[gap_end_ + i] = T();
+        }
+        gap_end_ += count;
+    }
+
+    void Clear() {
+        buffer_.clear();
+        gap_begin_ = 0;
+        gap_end_ = 0;
+    }
+
+    void Reserve(size_t count) {
+        if (count > Size()) {
+            MoveGap(Size());
+            Grow(count - Size());
+        }
+    }
+
+    size_t Capacity() const {
+        return buffer_.capacity();
+    }
+
+    void ShrinkToFit() {
+        MoveGap(Size());
+        buffer_.resize(gap_begin_);
+        buffer_.shrink_to_fit();
+        gap_end_ = gap_begin_;
+    }
+
+private:
+    void MoveGap(size_t index) {
+        if (index < gap_begin_) {
+            size_t count = gap_begin_ - index;
+            std::move_backward(buffer_.begin() + index, buffer_.begin() + gap_begin_, buffer_.begin() + gap_end_);
+            gap_begin_ -= count;
+            gap_end_ -= count;
+        }
+        else if (index > gap_begin_) {
+            size_t count = index - gap_begin_;
+            std::move(buffer_.begin() + gap_end_, buffer_.begin() + gap_end_ + count, buffer_.begin() + gap_begin_);
+            gap_begin_ += count;
+            gap_end_ += count;
+        }
+    }
+
+    void Grow(size_t min_count) {
+        size_t old_size = buffer_.size();
+        size_t grow = std::max(min_count, std::max<size_t>(old_size / 2, 16));
+        size_t tail = old_size - gap_end_;
+        buffer_.resize(old_size + grow);
+        std::move_backward(buffer_.begin() + gap_end_, buffer_.begin() + old_size, buffer_.end());
+        gap_end_ = buffer_.size() - tail;
+    }
+
+private:
+    std::vector<T> buffer_;
+    size_t gap_begin_;
+    size_t gap_end_;
+};
+
+static int EncodeUtf8(unsigned int c, char out[4]) {
+    if (c < 0x80) {
+        out[0] = (char)c;
+        return 1;
+    }
+    if (c < 0x800) {
+        out[0] = (char)(0xC0 | (c >> 6));
+        out[1] = (char)(0x80 | (c & 0x3F));
+        return 2;
+    }
+    if (c < 0x10000) {
+        out[0] = (char)(0xE0 | (c >> 12));
+        out[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (c & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (c >> 18));
+    out[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (c & 0x3F));
+    return 4;
+}
+} // namespace internal
+
+/*
+* ༭
+* ĵбڼ϶УÿлǺԼסβķ״̬
+* ֻб޸ĵУԼ״̬˸ıĺл·ֻɼΧΪֹ
+* ֻƿɼУGetTextҪƴĵƵȡʱʹGetLine
+*/
+class CodeEditor : public Widget {
+public:
+    enum TokenKind : uint8_t {
+        kTokenDefault,
+        kTokenKeyword,
+        kTokenNumber,
+        kTokenString,
+        kTokenComment,
+        kTokenPreprocessor,
+        kTokenPunctuation,
+        kTokenCount,
+    };
+
+    struct Token {
+        uint32_t begin;
+        uint32_t length;
+        TokenKind kind;
+    };
+
+    // һıβ״̬ǺҪ˳򸲸
+    typedef std::function<uint32_t(const char* begin, const char* end, uint32_t state, std::vector<Token>& tokens)> Tokenizer;
+
+    CodeEditor(const std::string& label, const ImVec2& size = ImVec2(0, 0)) : Widget(label) {
+        size_ = size;
+        cursor_line_ = 0;
+        cursor_column_ = 0;
+        anchor_line_ = 0;
+        anchor_column_ = 0;
+        valid_until_ = 0;
+        retokenize_count_ = 0;
+        version_ = 0;
+        end_version_ = 0;
+        scroll_to_cursor_ = false;
+        read_only_ = false;
+        preferred_x_ = -1.0f;
+        preferred_line_ = 0;
+        preferred_column_ = 0;
+        palette_[kTokenDefault] = IM_COL32(220, 220, 220, 255);
+        palette_[kTokenKeyword] = IM_COL32(86, 156, 214, 255);
+        palette_[kTokenNumber] = IM_COL32(181, 206, 168, 255);
+        palette_[kTokenString] = IM_COL32(206, 145, 120, 255);
+        palette_[kTokenComment] = IM_COL32(106, 153, 85, 255);
+        palette_[kTokenPreprocessor] = IM_COL32(197, 134, 192, 255);
+        palette_[kTokenPunctuation] = IM_COL32(180, 180, 180, 255);
+        SetKeywords({ "auto", "break", "case", "char", "class", "const", "continue", "default", "do", "double", "else", "enum",
+            "false", "float", "for", "if", "int", "nullptr", "private", "public", "return", "static", "struct", "switch",
+            "template", "this", "true", "typedef", "unsigned", "void", "while" });
+        lines_.Insert(0, Line());
+    }
+
+    void Begin() {
+        Widget::Begin();
+        ImGui::PushStyleColor(ImGuiCol_ChildBg, ImGui::GetStyleColorVec4(ImGuiCol_FrameBg));
+        if (ImGui::BeginChild(GetLabel().c_str(), size_, true, ImGuiWindowFlags_HorizontalScrollbar | ImGuiWindowFlags_NoMove)) {
+            if (ImGui::IsWindowFocused()) {
+                HandleKeyboard();
+            }
+            HandleMouse();
+            Draw();
+        }
+        ImGui::EndChild();
+        ImGui::PopStyleColor();
+    }
+
+    void End() {
+        end_version_ = version_;
+        Widget::End();
+    }
+
+    /*
+    * Event
+    */
+    void ChangeEvent(std::function<void()> event) {
+        if (end_version_ != version_) {
+            internal::ConsumeInput();
+            event();
+        }
+    }
+
+    /*
+    * Control
+    */
+    void SetText(const std::string& text) {
+        BumpControlVersion();
+        lines_.Clear();
+        size_t begin = 0;
+        for (;;) {
+            size_t end = text.find('\n', begin);
+            Line line;
+            line.text.assign(text, begin, end == std::string::npos ? std::string::npos : end - begin);
+            if (!line.text.empty() && line.text.back() == '\r') {
+                line.text.pop_back();
+            }
+            lines_.Insert(lines_.Size(), std::move(line));
+            if (end == std::string::npos) {
+                break;
+            }
+            begin = end + 1;
+        }
+        cursor_line_ = cursor_column_ = 0;
+        anchor_line_ = anchor_column_ = 0;
+        preferred_x_ = -1.0f;
+        valid_until_ = 0;
+        version_++;
+    }
+
+    std::string GetText() {
+        std::string text;
+        size_t size = 0;
+        for (size_t i = 0; i < lines_.Size(); i++) {
+            size += lines_[i].text.size() + 1;
+        }
+        text.reserve(size);
+        for (size_t i = 0; i < lines_.Size(); i++) {
+            if (i > 0) {
+                text.push_back('\n');
+            }
+            text.append(lines_[i].text);
+        }
+        return text;
+    }
+
+    size_t GetLineCount() {
+        return lines_.Size();
+    }
+
+    const std::string& GetLine(size_t index) {
+        return lines_[index].text;
+    }
+
+    // ڹ괦ı滻ѡ
+    void Insert(const char* text, size_t length) {
+        BumpControlVersion();
+        if (HasSelection()) {
+            DeleteSelection();
+        }
+        const char* end = text + length;
+        const char* cur = text;
+        while (cur < end) {
+            const char* newline = (const char*)memchr(cur, '\n', end - cur);
+            const char* segment_end = newline ? newline : end;
+            size_t segment_length = segment_end - cur;
+            if (segment_length > 0 && cur[segment_length - 1] == '\r') {
+                segment_length--;
+            }
+            Line& line = lines_[cursor_line_];
+            line.text.insert(cursor_column_, cur, segment_length);
+            cursor_column_ += segment_length;
+            MarkDirty(cursor_line_);
+            if (newline == nullptr) {
+                break;
+            }
+            SplitLine();
+            cur = newline + 1;
+        }
+        anchor_line_ = cursor_line_;
+        anchor_column_ = cursor_column_;
+        scroll_to_cursor_ = true;
+        version_++;
+    }
+
+    void SetCursor(size_t line, size_t column) {
+        BumpControlVersion();
+        cursor_line_ = std::min(line, lines_.Size() - 1);
+        cursor_column_ = SnapColumn(lines_[cursor_line_].text, column);
+        anchor_line_ = cursor_line_;
+        anchor_column_ = cursor_column_;
+        scroll_to_cursor_ = true;
+    }
+
+    size_t GetCursorLine() {
+        return cursor_line_;
+    }
+
+    size_t GetCursorColumn() {
+        return cursor_column_;
+    }
+
+    void SetReadOnly(bool read_only) {
+        BumpControlVersion();
+        read_only_ = read_only;
+    }
+
+    void SetTokenizer(Tokenizer tokenizer) {
+        BumpControlVersion();
+        tokenizer_ = std::move(tokenizer);
+        valid_until_ = 0;
+        for (size_t i = 0; i < lines_.Size(); i++) {
+            lines_[i].dirty = true;
+        }
+    }
+
+    void SetKeywords(std::initializer_list<const char*> keywords) {
+        BumpControlVersion();
+        keywords_.clear();
+        for (const char* keyword : keywords) {
+            keywords_.push_back(keyword);
+        }
+        std::sort(keywords_.begin(), keywords_.end());
+        SetTokenizer(nullptr);
+    }
+
+    void SetColor(TokenKind kind, ImU32 color) {
+        BumpControlVersion();
+        palette_[kind] = color;
+    }
+
+    // ۼ·
+    size_t GetRetokenizeCount() {
+        return retokenize_count_;
+    }
+
+    /*
+    * Memory
+    */
+    MemoryUsage GetMemoryUsage() {
+        size_t used = 0;
+        size_t capacity = lines_.Capacity() * sizeof(Line);
+        for (size_t i = 0; i < lines_.Size(); i++) {
+            Line& line = lines_[i];
+            used += line.text.size() + line.tokens.size() * sizeof(Token);
+            capacity += internal::HeapBytes(line.text) + internal::HeapBytes(line.tokens);
+        }
+        used += lines_.Size() * sizeof(Line);
+        return MemoryUsage{ "text", used, capacity };
+    }
+
+    void TrimMemory() {
+        lines_.ShrinkToFit();
+    }
+
+private:
+    struct Line {
+        Line() {
+            state_in = 0;
+            state_out = 0;
+            dirty = true;
+        }
+
+        std::string text;
+        std::vector<Token> tokens;
+        uint32_t state_in;
+        uint32_t state_out;
+        bool dirty;
+    };
+
+    enum {
+        kStateNormal = 0,
+        kStateBlockComment = 1,
+    };
+
+    void MarkDirty(size_t line) {
+        lines_[line].dirty = true;
+        if (line < valid_until_) {
+            valid_until_ = line;
+        }
+    }
+
+    // ڹ괦ѵǰвУƶ
+    void SplitLine() {
+        Line next;
+        Line& line = lines_[cursor_line_];
+        next.text.assign(line.text, cursor_column_, std::string::npos);
+        line.text.resize(cursor_column_);
+        MarkDirty(cursor_line_);
+        lines_.Insert(cursor_line_ + 1, std::move(next));
+        cursor_line_++;
+        cursor_column_ = 0;
+    }
+
+    bool HasSelection() {
+        return cursor_line_ != anchor_line_ || cursor_column_ != anchor_column_;
+    }
+
+    void GetSelection(size_t& begin_line, size_t& begin_column, size_t& end_line, size_t& end_column) {
+        if (anchor_line_ < cursor_line_ || (anchor_line_ == cursor_line_ && anchor_column_ < cursor_column_)) {
+            begin_line = anchor_line_;
+            begin_column = anchor_column_;
+            end_line = cursor_line_;
+            end_column = cursor_column_;
+        }
+        else {
+            begin_line = cursor_line_;
+            begin_column = cursor_column_;
+            end_line = anchor_line_;
+            end_column = anchor_column_;
+        }
+    }
+
+    std::string GetSelectedText() {
+        size_t begin_line, begin_column, end_line, end_column;
+        GetSelection(begin_line, begin_column, end_line, end_column);
+        if (begin_line == end_line) {
+            return lines_[begin_line].text.substr(begin_column, end_column - begin_column);
+        }
+        std::string text = lines_[begin_line].text.substr(begin_column);
+        for (size_t i = begin_line + 1; i < end_line; i++) {
+            text.push_back('\n');
+            text.append(lines_[i].text);
+        }
+        text.push_back('\n');
+        text.append(lines_[end_line].text, 0, end_column);
+        return text;
+    }
+
+    void DeleteSelection() {
+        size_t begin_line, begin_column, end_line, end_column;
+        GetSelection(begin_line, begin_column, end_line, end_column);
+        Line& first = lines_[begin_line];
+        if (begin_line == end_line) {
+            first.text.erase(begin_column, end_column - begin_column);
+        }
+        else {
+            first.text.resize(begin_column);
+            first.text.append(lines_[end_line].text, end_column, std::string::npos);
+            lines_.Erase(begin_line + 1, end_line - begin_line);
+        }
+        MarkDirty(begin_line);
+        cursor_line_ = anchor_line_ = begin_line;
+        cursor_column_ = anchor_column_ = begin_column;
+        version_++;
+    }
+
+    void Backspace() {
+        if (HasSelection()) {
+            DeleteSelection();
+            return;
+        }
+        if (cursor_column_ > 0) {
+            size_t column = PrevColumn(lines_[cursor_line_].text, cursor_column_);
+            lines_[cursor_line_].text.erase(column, cursor_column_ - column);
+            cursor_column_ = column;
+            MarkDirty(cursor_line_);
+        }
+        else if (cursor_line_ > 0) {
+            std::string text = std::move(lines_[cursor_line_].text);
+            lines_.Erase(cursor_line_);
+            cursor_line_--;
+            cursor_column_ = lines_[cursor_line_].text.size();
+            lines_[cursor_line_].text.append(text);
+            MarkDirty(cursor_line_);
+        }
+        else {
+            return;
+        }
+        anchor_line_ = cursor_line_;
+        anchor_column_ = cursor_column_;
+        version_++;
+    }
+
+    void Delete() {
+        if (HasSelection()) {
+            DeleteSelection();
+            return;
+        }
+        Line& line = lines_[cursor_line_];
+        if (cursor_column_ < line.text.size()) {
+            line.text.erase(cursor_column_, NextColumn(line.text, cursor_column_) - cursor_column_);
+        }
+        else if (cursor_line_ + 1 < lines_.Size()) {
+            std::string text = std::move(lines_[cursor_line_ + 1].text);
+            lines_.Erase(cursor_line_ + 1);
+            lines_[cursor_line_].text.append(text);
+        }
+        else {
+            return;
+        }
+        MarkDirty(cursor_line_);
+        version_++;
+    }
+
+    static size_t PrevColumn(const std::string& text, size_t column) {
+        if (column == 0) {
+            return 0;
+        }
+        column--;
+        while (column > 0 && ((unsigned char)text[column] & 0xC0) == 0x80) {
+            column--;
+        }
+        return column;
+    }
+
+    static size_t NextColumn(const std::string& text, size_t column) {
+        if (column >= text.size()) {
+            return text.size();
+        }
+        column++;
+        while (column < text.size() && ((unsigned char)text[column] & 0xC0) == 0x80) {
+            column++;
+        }
+        return column;
+    }
+
+    // ֽڣ˻صUTF-8ַʼֽ
+    static size_t SnapColumn(const std::string& text, size_t column) {
+        column = std::min(column, text.size());
+        while (column > 0 && column < text.size() && ((unsigned char)text[column] & 0xC0) == 0x80) {
+            column--;
+        }
+        return column;
+    }
+
+    static float ColumnToX(const std::string& text, size_t column) {
+        return ImGui::GetFont()->CalcTextSizeA(ImGui::GetFontSize(), FLT_MAX, 0.0f, text.c_str(), text.c_str() + column).x;
+    }
+
+    // ۼοȣxַ߽
+    static size_t XToColumn(const std::string& text, float x) {
+        ImFont* font = ImGui::GetFont();
+        float font_size = ImGui::GetFontSize();
+        const char* begin = text.c_str();
+        size_t column = 0;
+        float left = 0.0f;
+        while (column < text.size()) {
+            size_t next = NextColumn(text, column);
+            float right = left + font->CalcTextSizeA(font_size, FLT_MAX, 0.0f, begin + column, begin + next).x;
+            if (x < (left + right) * 0.5f) {
+                break;
+            }
+            column = next;
+            left = right;
+        }
+        return column;
+    }
+
+    void MoveCursor(size_t line, size_t column, bool select) {
+        cursor_line_ = line;
+        cursor_column_ = SnapColumn(lines_[line].text, column);
+        if (!select) {
+            anchor_line_ = cursor_line_;
+            anchor_column_ = cursor_column_;
+        }
+        scroll_to_cursor_ = true;
+    }
+
+    // ƶʱˮƽλãƶкԻصԭx
+    void MoveCursorVertical(size_t line, bool select) {
+        float x = preferred_x_;
+        if (x < 0.0f || preferred_line_ != cursor_line_ || preferred_column_ != cursor_column_) {
+            x = ColumnToX(lines_[cursor_line_].text, cursor_column_);
+        }
+        MoveCursor(line, XToColumn(lines_[line].text, x), select);
+        preferred_x_ = x;
+        preferred_line_ = cursor_line_;
+        preferred_column_ = cursor_column_;
+    }
+
+    void HandleKeyboard() {
+        ImGuiIO& io = ImGui::GetIO();
+        bool shift = io.KeyShift;
+        bool ctrl = io.KeyCtrl;
+        int page = std::max(1, (int)(ImGui::GetWindowHeight() / ImGui::GetTextLineHeight()) - 1);
+        const std::string& text = lines_[cursor_line_].text;
+
+        if (ImGui::IsKeyPressed(ImGuiKey_LeftArrow)) {
+            if (cursor_column_ > 0) {
+                MoveCursor(cursor_line_, PrevColumn(text, cursor_column_), shift);
+            }
+            else if (cursor_line_ > 0) {
+                MoveCursor(cursor_line_ - 1, lines_[cursor_line_ - 1].text.size(), shift);
+            }
+        }
+        else if (ImGui::IsKeyPressed(ImGuiKey_RightArrow)) {
+            if (cursor_column_ < text.size()) {
+                MoveCursor(cursor_line_, NextColumn(text, cursor_column_), shift);
+            }
+            else if (cursor_line_ + 1 < lines_.Size()) {
+                MoveCursor(cursor_line_ + 1, 0, shift);
+            }
+        }
+        else if (ImGui::IsKeyPressed(ImGuiKey_UpArrow)) {
+            MoveCursorVertical(cursor_line_ > 0 ? cursor_line_ - 1 : 0, shift);
+        }
+        else if (ImGui::IsKeyPressed(ImGuiKey_DownArrow)) {
+            MoveCursorVertical(std::min(cursor_line_ + 1, lines_.Size() - 1), shift);
+        }
+        else if (ImGui::IsKeyPressed(ImGuiKey_PageUp)) {
+            MoveCursorVertical(cursor_line_ > (size_t)page ? cursor_line_ - page : 0, shift);
+        }
+        else if (ImGui::IsKeyPressed(ImGuiKey_PageDown)) {
+            MoveCursorVertical(std::min(cursor_line_ + page, lines_.Size() - 1), shift);
+        }
+        else if (ImGui::IsKeyPressed(ImGuiKey_Home)) {
+            MoveCursor(ctrl ? 0 : cursor_line_, 0, shift);
+        }
+        else if (ImGui::IsKeyPressed(ImGuiKey_End)) {
+            size_t line = ctrl ? lines_.Size() - 1 : cursor_line_;
+            MoveCursor(line, lines_[line].text.size(), shift);
+        }
+        else if (ctrl && ImGui::IsKeyPressed(ImGuiKey_A)) {
+            anchor_line_ = 0;
+            anchor_column_ = 0;
+            cursor_line_ = lines_.Size() - 1;
+            cursor_column_ = lines_[cursor_line_].text.size();
+        }
+        else if (ctrl && ImGui::IsKeyPressed(ImGuiKey_C)) {
+            if (HasSelection()) {
+                ImGui::SetClipboardText(GetSelectedText().c_str());
+            }
+        }
+
+        if (read_only_) {
+            return;
+        }
+        if (ctrl && ImGui::IsKeyPressed(ImGuiKey_X)) {
+            if (HasSelection()) {
+                ImGui::SetClipboardText(GetSelectedText().c_str());
+                DeleteSelection();
+            }
+        }
+        else if (ctrl && ImGui::IsKeyPressed(ImGuiKey_V)) {
+            const char* clipboard = ImGui::GetClipboardText();
+            if (clipboard) {
+                Insert(clipboard, strlen(clipboard));
+            }
+        }
+        else if (ImGui::IsKeyPressed(ImGuiKey_Backspace)) {
+            Backspace();
+        }
+        else if (ImGui::IsKeyPressed(ImGuiKey_Delete)) {
+            Delete();
+        }
+        else if (ImGui::IsKeyPressed(ImGuiKey_Enter) || ImGui::IsKeyPressed(ImGuiKey_KeypadEnter)) {
+            Insert("\n", 1);
+        }
+        else if (ImGui::IsKeyPressed(ImGuiKey_Tab)) {
+            Insert("    ", 4);
+        }
+
+        if (!ctrl && !io.KeyAlt && io.InputQueueCharacters.Size > 0) {
+            std::string input;
+            for (int i = 0; i < io.InputQueueCharacters.Size; i++) {
+                unsigned int c = io.InputQueueCharacters[i];
+                if (c >= 0x20 && c != 0x7F) {
+                    char buffer[4];
+                    input.append(buffer, internal::EncodeUtf8(c, buffer));
+                }
+            }
+            io.InputQueueCharacters.resize(0);
+            if (!input.empty()) {
+                Insert(input.data(), input.size());
+            }
+        }
+    }
+
+    void HandleMouse() {
+        if (!ImGui::IsWindowHovered()) {
+            return;
+        }
+        bool click = ImGui::IsMouseClicked(ImGuiMouseButton_Left);
+        bool drag = ImGui::IsMouseDragging(ImGuiMouseButton_Left) && ImGui::IsWindowFocused();
+        if (!click && !drag) {
+            return;
+        }
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        ImVec2 mouse = ImGui::GetMousePos();
+        float line_height = ImGui::GetTextLineHeight();
+        float y = mouse.y - origin.y;
+        size_t line = y <= 0.0f ? 0 : std::min((size_t)(y / line_height), lines_.Size() - 1);
+        MoveCursor(line, XToColumn(lines_[line].text, mouse.x - origin.x), drag || ImGui::GetIO().KeyShift);
+        scroll_to_cursor_ = false;
+    }
+
+    // end()Ϊֹ״̬δıδ޸ĵֱ
+    void Tokenize(size_t end) {
+        end = std::min(end, lines_.Size());
+        uint32_t state = valid_until_ > 0 ? lines_[valid_until_ - 1].state_out : kStateNormal;
+        for (size_t i = valid_until_; i < end; i++) {
+            Line& line = lines_[i];
+            if (line.dirty || line.state_in != state) {
+                line.state_in = state;
+                line.tokens.clear();
+                const char* begin = line.text.c_str();
+                line.state_out = tokenizer_ ? tokenizer_(begin, begin + line.text.size(), state, line.tokens) :
+                    DefaultTokenize(begin, begin + line.text.size(), state, line.tokens);
+                line.dirty = false;
+                retokenize_count_++;
+            }
+            state = line.state_out;
+        }
+        if (end > valid_until_) {
+            valid_until_ = end;
+        }
+    }
+
+    bool IsKeyword(const char* begin, const char* end) {
+        size_t length = end - begin;
+        auto iter = std::lower_bound(keywords_.begin(), keywords_.end(), begin, [length](const std::string& keyword, const char* value) {
+            return keyword.compare(0, std::string::npos, value, length) < 0;
+        });
+        return iter != keywords_.end() && iter->size() == length && memcmp(iter->data(), begin, length) == 0;
+    }
+
+    // CԵĬϷעַ֡͡ؼ֡Ԥָ
+    uint32_t DefaultTokenize(const char* begin, const char* end, uint32_t state, std::vector<Token>& tokens) {
+        const char* cur = begin;
+        auto push = [&](const char* token_begin, const char* token_end, TokenKind kind) {
+            if (!tokens.empty() && tokens.back().kind == kind && begin + tokens.back().begin + tokens.back().length == token_begin) {
+                tokens.back().length += (uint32_t)(token_end - token_begin);
+                return;
+            }
+            tokens.push_back(Token{ (uint32_t)(token_begin - begin), (uint32_t)(token_end - token_begin), kind });
+        };
+        if (state == kStateBlockComment) {
+            const char* close = cur;
+            while (close + 1 < end && !(close[0] == '*' && close[1] == '/')) {
+                close++;
+            }
+            if (close + 1 >= end) {
+                push(cur, end, kTokenComment);
+                return kStateBlockComment;
+            }
+            push(cur, close + 2, kTokenComment);
+            cur = close + 2;
+        }
+        const char* first = cur;
+        while (first < end && (*first == ' ' || *first == '\t')) {
+            first++;
+        }
+        if (first < end && *first == '#') {
+            push(cur, end, kTokenPreprocessor);
+            return kStateNormal;
+        }
+        while (cur < end) {
+            char c = *cur;
+            if (c == '/' && cur + 1 < end && cur[1] == '/') {
+                push(cur, end, kTokenComment);
+                return kStateNormal;
+            }
+            if (c == '/' && cur + 1 < end && cur[1] == '*') {
+                const char* close = cur + 2;
+                while (close + 1 < end && !(close[0] == '*' && close[1] == '/')) {
+                    close++;
+                }
+                if (close + 1 >= end) {
+                    push(cur, end, kTokenComment);
+                    return kStateBlockComment;
+                }
+                push(cur, close + 2, kTokenComment);
+                cur = close + 2;
+            }
+            else if (c == '"' || c == '\'') {
+                const char* close = cur + 1;
+                while (close < end && *close != c) {
+                    close += (*close == '\\' && close + 1 < end) ? 2 : 1;
+                }
+                close = std::min(close + 1, end);
+                push(cur, close, kTokenString);
+                cur = close;
+            }
+            else if (isdigit((unsigned char)c)) {
+                const char* token_end = cur + 1;
+                while (token_end < end && (isalnum((unsigned char)*token_end) || *token_end == '.' || *token_end == '_')) {
+                    token_end++;
+                }
+                push(cur, token_end, kTokenNumber);
+                cur = token_end;
+            }
+            else if (isalpha((unsigned char)c) || c == '_') {
+                const char* token_end = cur + 1;
+                while (token_end < end && (isalnum((unsigned char)*token_end) || *token_end == '_')) {
+                    token_end++;
+                }
+                push(cur, token_end, IsKeyword(cur, token_end) ? kTokenKeyword : kTokenDefault);
+                cur = token_end;
+            }
+            else if (ispunct((unsigned char)c)) {
+                push(cur, cur + 1, kTokenPunctuation);
+                cur++;
+            }
+            else {
+                push(cur, cur + 1, kTokenDefault);
+                cur++;
+            }
+        }
+        return kStateNormal;
+    }
+
+    void Draw() {
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        ImFont* font = ImGui::GetFont();
+        float font_size = ImGui::GetFontSize();
+        float line_height = ImGui::GetTextLineHeight();
+        bool focused = ImGui::IsWindowFocused();
+
+        if (scroll_to_cursor_) {
+            float cursor_y = cursor_line_ * line_height;
+            float scroll_y = ImGui::GetScrollY();
+            float height = ImGui::GetWindowHeight() - ImGui::GetStyle().WindowPadding.y * 2;
+            if (cursor_y < scroll_y) {
+                ImGui::SetScrollY(cursor_y);
+            }
+            else if (cursor_y + line_height > scroll_y + height) {
+                ImGui::SetScrollY(cursor_y + line_height - height);
+            }
+            scroll_to_cursor_ = false;
+        }
+
+        size_t select_begin_line, select_begin_column, select_end_line, select_end_column;
+        GetSelection(select_begin_line, select_begin_column, select_end_line, select_end_column);
+        bool selection = HasSelection();
+
+        // жʹImGui::Dummyռλи߹̶ΪGetTextLineHeight
+        ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(ImGui::GetStyle().ItemSpacing.x, 0.0f));
+        ImGuiListClipper clipper;
+        clipper.Begin((int)lines_.Size(), line_height);
+        while (clipper.Step()) {
+            Tokenize(clipper.DisplayEnd);
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                Line& line = lines_[i];
+                ImVec2 pos = ImGui::GetCursorScreenPos();
+                const char* text = line.text.c_str();
+
+                if (selection && (size_t)i >= select_begin_line && (size_t)i <= select_end_line) {
+                    size_t begin = (size_t)i == select_begin_line ? select_begin_column : 0;
+                    size_t end = (size_t)i == select_end_line ? select_end_column : line.text.size();
+                    float x0 = font->CalcTextSizeA(font_size, FLT_MAX, 0.0f, text, text + begin).x;
+                    float x1 = font->CalcTextSizeA(font_size, FLT_MAX, 0.0f, text, text + end).x;
+                    if ((size_t)i != select_end_line) {
+                        x1 += font_size * 0.5f;
+                    }
+                    draw_list->AddRectFilled(ImVec2(pos.x + x0, pos.y), ImVec2(pos.x + x1, pos.y + line_height), ImGui::GetColorU32(ImGuiCol_TextSelectedBg));
+                }
+
+                float x = pos.x;
+                for (auto& token : line.tokens) {
+                    const char* token_begin = text + token.begin;
+                    const char* token_end = token_begin + token.length;
+                    draw_list->AddText(font, font_size, ImVec2(x, pos.y), palette_[token.kind], token_begin, token_end);
+                    x += font->CalcTextSizeA(font_size, FLT_MAX, 0.0f, token_begin, token_end).x;
+                }
+
+                if (focused && (size_t)i == cursor_line_ && fmodf((float)ImGui::GetTime(), 1.0f) < 0.6f) {
+                    float cursor_x = pos.x + font->CalcTextSizeA(font_size, FLT_MAX, 0.0f, text, text + cursor_column_).x;
+                    draw_list->AddLine(ImVec2(cursor_x, pos.y), ImVec2(cursor_x, pos.y + line_height), palette_[kTokenDefault]);
+                }
+                ImGui::Dummy(ImVec2(x - pos.x + font_size, line_height));
+            }
+        }
+        ImGui::PopStyleVar();
+    }
+
+private:
+    internal::GapBuffer<Line> lines_;
+    ImVec2 size_;
+
+    size_t cursor_line_;
+    size_t cursor_column_;
+    size_t anchor_line_;
+    size_t anchor_column_;
+    bool scroll_to_cursor_;
+    bool read_only_;
+
+    // ƶĿxͣ(preferred_line_, preferred_column_)ʱЧ
+    float preferred_x_;
+    size_t preferred_line_;
+    size_t preferred_column_;
+
+    // Сvalid_until_еļǺŶµ
+    size_t valid_until_;
+    size_t retokenize_count_;
+    Tokenizer tokenizer_;
+    std::vector<std::string> keywords_;
+    ImU32 palette_[kTokenCount];
+
+    uint64_t end_version_;
+    uint64_t version_;
+};
+
+
+namespace internal {
+// [data, data + size)вpatternÿɨһһȡǲ½ȣδҵUINT64_MAX
+static uint64_t FindPattern(const uint8_t* data, uint64_t size, const uint8_t* pattern, size_t length,
+    const std::atomic<bool>& cancel, std::atomic<uint64_t>& progress) {
+    if (length == 0 || size < length) {
+        return UINT64_MAX;
+    }
+    const uint64_t last = size - length;
+    const uint64_t block = 1024 * 1024;
+    uint64_t pos = 0;
+    while (pos <= last) {
+        if (cancel.load(std::memory_order_relaxed)) {
+            return UINT64_MAX;
+        }
+        uint64_t block_end = std::min(last + 1, pos + block);
+#ifdef IMGUI_EX_SSE2
+        // βֽͬʱƥֽڱȽ
+        const __m128i first = _mm_set1_epi8((char)pattern[0]);
+        const __m128i tail = _mm_set1_epi8((char)pattern[length - 1]);
+        while (pos + 16 <= block_end) {
+            __m128i head_bytes = _mm_loadu_si128((const __m128i*)(data + pos));
+            __m128i tail_bytes = _mm_loadu_si128((const __m128i*)(data + pos + length - 1));
+            unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head_bytes, first), _mm_cmpeq_epi8(tail_bytes, tail)));
+            while (mask) {
+#if defined(_MSC_VER)
+                unsigned long bit;
+                _BitScanForward(&bit, mask);
+#else
+                unsigned int bit = __builtin_ctz(mask);
+#endif
+                if (memcmp(data + pos + bit, pattern, length) == 0) {
+                    return pos + bit;
+                }
+                mask &= mask - 1;
+            }
+            pos += 16;
+        }
+#endif
+        for (; pos < block_end; pos++) {
+            if (data[pos] == pattern[0] && memcmp(data + pos, pattern, length) == 0) {
+                return pos;
+            }
+        }
+        progress.store(pos, std::memory_order_relaxed);
+    }
+    return UINT64_MAX;
+}
+} // namespace internal
+
+/*
+* ʮƲ鿴
+* ӳļʹõ÷ṩڴ棬ÿֻ֡ʽɼУڴռļС޹
+* к64λ沢Իfloatλڴļʧȥ
+* ں̨߳нУFoundEventһ֡
+*/
+class HexView : public Widget {
+public:
+    HexView(const std::string& label, const ImVec2& size = ImVec2(0, 0), int bytes_per_row = 16) : Widget(label) {
+        size_ = size;
+        bytes_per_row_ = bytes_per_row > 0 ? bytes_per_row : 16;
+        data_ = nullptr;
+        data_size_ = 0;
+        top_row_ = 0;
+        selection_ = UINT64_MAX;
+        visible_rows_ = 1;
+        match_ = UINT64_MAX;
+        match_length_ = 0;
+        searching_ = false;
+        search_done_ = false;
+        search_cancel_ = false;
+        search_result_ = UINT64_MAX;
+        search_progress_ = 0;
+        search_size_ = 0;
+        end_search_done_ = false;
+        line_.resize(32 + bytes_per_row_ * 4);
+    }
+
+    ~HexView() {
+        CancelSearch();
+    }
+
+    bool Open(const std::string& path) {
+        CancelSearch();
+        if (!file_.Open(path)) {
+            SetData(nullptr, 0);
+            return false;
+        }
+        SetData(file_.GetData(), file_.GetSize());
+        return true;
+    }
+
+    // ÷ҪHexViewʹڼ䱣Ч
+    void SetData(const void* data, uint64_t size) {
+        BumpControlVersion();
+        CancelSearch();
+        data_ = (const uint8_t*)data;
+        data_size_ = data ? size : 0;
+        top_row_ = 0;
+        selection_ = UINT64_MAX;
+        match_ = UINT64_MAX;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        if (searching_ && search_done_.load(std::memory_order_acquire)) {
+            search_thread_.join();
+            searching_ = false;
+            match_ = search_result_;
+            match_length_ = pattern_.size();
+            if (match_ != UINT64_MAX) {
+                JumpTo(match_);
+            }
+        }
+
+        ImGuiWindowFlags flags = ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse | ImGuiWindowFlags_NoMove;
+        if (ImGui::BeginChild(GetLabel().c_str(), size_, true, flags)) {
+            Draw();
+        }
+        ImGui::EndChild();
+    }
+
+    void End() {
+        end_search_done_ = !searching_ && search_done_;
+        Widget::End();
+    }
+
+    /*
+    * Event
+    */
+    // ΪƥλãδҵʱΪUINT64_MAX
+    void FoundEvent(std::function<void(uint64_t)> event) {
+        if (!searching_ && search_done_ && !end_search_done_) {
+            event(match_);
+        }
+    }
+
+    /*
+    * Control
+    */
+    void JumpTo(uint64_t offset) {
+        BumpControlVersion();
+        if (data_size_ == 0) {
+            return;
+        }
+        offset = std::min(offset, data_size_ - 1);
+        selection_ = offset;
+        uint64_t row = offset / bytes_per_row_;
+        if (row < top_row_ || row >= top_row_ + visible_rows_) {
+            top_row_ = row > (uint64_t)visible_rows_ / 2 ? row - visible_rows_ / 2 : 0;
+        }
+        ClampTopRow();
+    }
+
+    // fromʼңᱻȡ
+    void Search(const std::vector<uint8_t>& pattern, uint64_t from = 0) {
+        BumpControlVersion();
+        CancelSearch();
+        if (pattern.empty() || data_ == nullptr || from >= data_size_) {
+            return;
+        }
+        pattern_ = pattern;
+        search_cancel_ = false;
+        search_done_ = false;
+        search_result_ = UINT64_MAX;
+        search_progress_ = 0;
+        search_size_ = data_size_ - from;
+        searching_ = true;
+        const uint8_t* data = data_ + from;
+        uint64_t size = data_size_ - from;
+        HWND wake_window = GetCommandQueue().GetWakeWindow();
+        search_thread_ = std::thread([this, data, size, from, wake_window]() {
+            uint64_t found = internal::FindPattern(data, size, pattern_.data(), pattern_.size(), search_cancel_, search_progress_);
+            search_result_ = found == UINT64_MAX ? UINT64_MAX : found + from;
+            search_done_.store(true, std::memory_order_release);
+            internal::PostWake(wake_window);
+        });
+    }
+
+    // ӵǰƥλ֮ͬһģʽ
+    void SearchNext() {
+        if (!pattern_.empty()) {
+            std::vector<uint8_t> pattern = pattern_;
+            Search(pattern, match_ == UINT64_MAX ? 0 : match_ + 1);
+        }
+    }
+
+    void CancelSearch() {
+        BumpControlVersion();
+        if (searching_) {
+            search_cancel_ = true;
+            search_thread_.join();
+            searching_ = false;
+        }
+        search_done_ = false;
+        end_search_done_ = false;
+    }
+
+    bool IsSearching() {
+        return searching_;
+    }
+
+    float GetSearchProgress() {
+        return search_size_ > 0 ? (float)((double)search_progress_.load() / (double)search_size_) : 0.0f;
+    }
+
+    uint64_t GetSelection() {
+        return selection_;
+    }
+
+    uint64_t GetSize() {
+        return data_size_;
+    }
+
+    /*
+    * Memory
+    */
+    MemoryUsage GetMemoryUsage() {
+        return MemoryUsage{ "other", line_.size() + pattern_.size(), internal::HeapBytes(line_) + internal::HeapBytes(pattern_) };
+    }
+
+    void TrimMemory() {
+    }
+
+private:
+    uint64_t GetRowCount() {
+        return (data_size_ + bytes_per_row_ - 1) / bytes_per_row_;
+    }
+
+    void ClampTopRow() {
+        uint64_t rows = GetRowCount();
+        uint64_t max_top = rows > (uint64_t)visible_rows_ ? rows - visible_rows_ : 0;
+        if (top_row_ > max_top) {
+            top_row_ = max_top;
+        }
+    }
+
+    // ʽһеõĻ: ƫ  ʮ  ASCII
+    size_t FormatRow(uint64_t row) {
+        static const char kDigits[] = "0123456789ABCDEF";
+        char* out = &line_[0];
+        uint64_t offset = row * bytes_per_row_;
+        for (int i = 15; i >= 0; i--) {
+            *out++ = kDigits[(offset >> (i * 4)) & 0xF];
+        }
+        *out++ = ' ';
+        *out++ = ' ';
+        uint64_t count = std::min<uint64_t>(bytes_per_row_, data_size_ - offset);
+        for (int i = 0; i < bytes_per_row_; i++) {
+            if ((uint64_t)i < count) {
+                uint8_t value = data_[offset + i];
+                *out++ = kDigits[value >> 4];
+                *out++ = kDigits[value & 0xF];
+            }
+            else {
+                *out++ = ' ';
+                *out++ = ' ';
+            }
+            *out++ = ' ';
+        }
+        *out++ = ' ';
+        for (uint64_t i = 0; i < count; i++) {
+            uint8_t value = data_[offset + i];
+            *out++ = value >= 0x20 && value < 0x7F ? (char)value : '.';
+        }
+        return out - &line_[0];
+    }
+
+    void Draw() {
+        ImGuiIO& io = ImGui::GetIO();
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        float line_height = ImGui::GetTextLineHeightWithSpacing();
+        float char_width = ImGui::CalcTextSize("0").x;
+        float scrollbar_width = ImGui::GetStyle().ScrollbarSize;
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        ImVec2 avail = ImGui::GetContentRegionAvail();
+        visible_rows_ = std::max(1, (int)(avail.y / line_height));
+        uint64_t rows = GetRowCount();
+
+        if (ImGui::IsWindowHovered() && io.MouseWheel != 0.0f) {
+            int64_t delta = (int64_t)(-io.MouseWheel * 3.0f);
+            top_row_ = delta < 0 && (uint64_t)-delta > top_row_ ? 0 : top_row_ + delta;
+        }
+        if (ImGui::IsWindowFocused() && data_size_ > 0) {
+            uint64_t selection = selection_ == UINT64_MAX ? top_row_ * bytes_per_row_ : selection_;
+            uint64_t page = (uint64_t)visible_rows_ * bytes_per_row_;
+            if (ImGui::IsKeyPressed(ImGuiKey_LeftArrow) && selection > 0) JumpTo(selection - 1);
+            if (ImGui::IsKeyPressed(ImGuiKey_RightArrow)) JumpTo(selection + 1);
+            if (ImGui::IsKeyPressed(ImGuiKey_UpArrow)) JumpTo(selection >= (uint64_t)bytes_per_row_ ? selection - bytes_per_row_ : selection);
+            if (ImGui::IsKeyPressed(ImGuiKey_DownArrow)) JumpTo(selection + bytes_per_row_);
+            if (ImGui::IsKeyPressed(ImGuiKey_PageUp)) JumpTo(selection >= page ? selection - page : 0);
+            if (ImGui::IsKeyPressed(ImGuiKey_PageDown)) JumpTo(selection + page);
+        }
+        ClampTopRow();
+
+        // ӳ䵽64λк
+        ImVec2 bar_min(origin.x + avail.x - scrollbar_width, origin.y);
+        ImVec2 bar_max(origin.x + avail.x, origin.y + avail.y);
+        ImGui::SetCursorScreenPos(bar_min);
+        ImGui::InvisibleButton("##scroll", ImVec2(scrollbar_width, std::max(1.0f, avail.y)));
+        uint64_t max_top = rows > (uint64_t)visible_rows_ ? rows - visible_rows_ : 0;
+        float thumb_height = std::max(ImGui::GetStyle().GrabMinSize, rows > 0 ? avail.y * std::min(1.0f, (float)visible_rows_ / (float)rows) : avail.y);
+        if (ImGui::IsItemActive() && max_top > 0) {
+            double t = (io.MousePos.y - bar_min.y - thumb_height * 0.5) / std::max(1.0, (double)(avail.y - thumb_height));
+            t = std::min(1.0, std::max(0.0, t));
+            top_row_ = (uint64_t)(t * (double)max_top);
+        }
+        double ratio = max_top > 0 ? (double)top_row_ / (double)max_top : 0.0;
+        float thumb_y = bar_min.y + (float)(ratio * (avail.y - thumb_height));
+        draw_list->AddRectFilled(bar_min, bar_max, ImGui::GetColorU32(ImGuiCol_ScrollbarBg));
+        draw_list->AddRectFilled(ImVec2(bar_min.x + 2, thumb_y), ImVec2(bar_max.x - 2, thumb_y + thumb_height),
+            ImGui::GetColorU32(ImGui::IsItemActive() ? ImGuiCol_ScrollbarGrabActive : ImGuiCol_ScrollbarGrab), ImGui::GetStyle().ScrollbarRounding);
+
+        float hex_x = char_width * 18;
+        float byte_width = char_width * 3;
+        if (ImGui::IsWindowHovered() && ImGui::IsMouseClicked(ImGuiMouseButton_Left) && io.MousePos.x < bar_min.x) {
+            int column = (int)((io.MousePos.x - origin.x - hex_x) / byte_width);
+            uint64_t row = top_row_ + (uint64_t)std::max(0.0f, (io.MousePos.y - origin.y) / line_height);
+            if (column >= 0 && column < bytes_per_row_) {
+                uint64_t offset = row * bytes_per_row_ + column;
+                if (offset < data_size_) {
+                    selection_ = offset;
+                }
+            }
+        }
+
+        ImU32 text_color = ImGui::GetColorU32(ImGuiCol_Text);
+        ImU32 select_color = ImGui::GetColorU32(ImGuiCol_TextSelectedBg);
+        ImU32 match_color = ImGui::GetColorU32(ImGuiCol_PlotHistogram, 0.5f);
+        draw_list->PushClipRect(origin, ImVec2(bar_min.x, bar_max.y), true);
+        for (int i = 0; i <= visible_rows_ && top_row_ + i < rows; i++) {
+            uint64_t row = top_row_ + i;
+            ImVec2 pos(origin.x, origin.y + i * line_height);
+            uint64_t row_begin = row * bytes_per_row_;
+            uint64_t row_end = row_begin + bytes_per_row_;
+            if (match_ != UINT64_MAX && match_ < row_end && match_ + match_length_ > row_begin) {
+                uint64_t begin = std::max(match_, row_begin) - row_begin;
+                uint64_t end = std::min(match_ + match_length_, row_end) - row_begin;
+                draw_list->AddRectFilled(ImVec2(pos.x + hex_x + begin * byte_width, pos.y),
+                    ImVec2(pos.x + hex_x + end * byte_width - char_width, pos.y + line_height), match_color);
+            }
+            if (selection_ >= row_begin && selection_ < row_end) {
+                uint64_t column = selection_ - row_begin;
+                draw_list->AddRectFilled(ImVec2(pos.x + hex_x + column * byte_width, pos.y),
+                    ImVec2(pos.x + hex_x + column * byte_width + char_width * 2, pos.y + line_height), select_color);
+            }
+            size_t length = FormatRow(row);
+            draw_list->AddText(pos, text_color, line_.data(), line_.data() + length);
+        }
+        draw_list->PopClipRect();
+    }
+
+private:
+    internal::MappedFile file_;
+    const uint8_t* data_;
+    uint64_t data_size_;
+
+    ImVec2 size_;
+    int bytes_per_row_;
+    int visible_rows_;
+    uint64_t top_row_;
+    uint64_t selection_;
+    std::string line_;
+
+    uint64_t match_;
+    uint64_t match_length_;
+    std::vector<uint8_t> pattern_;
+    std::thread search_thread_;
+    bool searching_;
+    std::atomic<bool> search_done_;
+    std::atomic<bool> search_cancel_;
+    std::atomic<uint64_t> search_progress_;
+    uint64_t search_size_;
+    uint64_t search_result_;
+    bool end_search_done_;
+};
+
+
+class Text : public Widget {
+public:
+    template<typename ... Args>
+    Text(const char* fmt, Args&&... args) : Widget(fmt) {
+        text_.Bind(fmt, std::forward<Args>(args)...);
+    }
+
+    void Begin() {
+        Widget::Begin();
+        text_.Update();
+        ImGui::TextUnformatted(text_.GetText(), text_.GetTextEnd());
+    }
+
+    void End() {
+        Widget::End();
+    }
+
+
+    std::string GetText() {
+        text_.Update();
+        return text_.GetString();
+    }
+
+    void SetText(const std::string& text) {
+        SetLabel(text);
+        text_.Bind(text);
+    }
+
+    /*
+    * Control
+    * Propertyʱֻã汾ű仯һ֡¸ʽ
+    */
+    template<typename ... Args>
+    void Bind(const char* fmt, Args&&... args) {
+        SetLabel(fmt);
+        text_.Bind(fmt, std::forward<Args>(args)...);
+    }
+
+private:
+    internal::TextFormat text_;
+};
+
+class SeparatorText : public Widget {
+public:
+    SeparatorText(const std::string& label) : Widget(label) {
+        
+    }
+
+    void Begin() {
+        Widget::Begin();
+        ImGui::SeparatorText(GetLabel().c_str());
+    }
+
+    void End() {
+        Widget::End();
+    }
+};
+
+class BulletText : public Widget {
+public:
+    template<typename ... Args>
+    BulletText(const char* fmt, Args&&... args) : Widget(fmt) {
+        text_.Bind(fmt, std::forward<Args>(args)...);
+    }
+
+    void Begin() {
+        Widget::Begin();
+        text_.Update();
+        ImGui::BulletText("%.*s", (int)(text_.GetTextEnd() - text_.GetText()), text_.GetText());
+    }
+
+    void End() {
+        Widget::End();
+    }
+
+
+    std::string GetText() {
+        text_.Update();
+        return text_.GetString();
+    }
+
+    void SetText(const std::string& text) {
+        SetLabel(text);
+        text_.Bind(text);
+    }
+
+    template<typename ... Args>
+    void Bind(const char* fmt, Args&&... args) {
+        SetLabel(fmt);
+        text_.Bind(fmt, std::forward<Args>(args)...);
+    }
+
+private:
+    internal::TextFormat text_;
+};
+
+class HelpMarker : public Widget {
+public:
+    HelpMarker(const std::string& title, const std::string& desc) : Widget(title), desc_(desc) {
+        
+    }
+
+    void Begin() {
+        Widget::Begin();
+        
+        // TextDisabledͬĲ֣ı뵽ǰеĻߣߴʹû棬ıΪͣĶ
+        const std::string& label = GetLabel();
+        const char* label_end = ImGui::FindRenderedTextEnd(label.c_str(), label.c_str() + label.size());
+        ImGuiWindow* window = ImGui::GetCurrentWindow();
+        ImVec2 pos(window->DC.CursorPos.x, window->DC.CursorPos.y + window->DC.CurrLineTextBaseOffset);
+        ImVec2 size = GetTextMetricsCache().Measure(label.c_str(), label_end);
+        ImGui::ItemSize(size, 0.0f);
+        if (ImGui::ItemAdd(ImRect(pos, ImVec2(pos.x + size.x, pos.y + size.y)), 0)) {
+            window->DrawList->AddText(pos, ImGui::GetColorU32(ImGuiCol_TextDisabled), label.c_str(), label_end);
+        }
+        if (ImGui::BeginItemTooltip()) {
+            ImGui::PushTextWrapPos(ImGui::GetFontSize() * 35.0f);
+            ImGui::TextUnformatted(desc_.c_str());
+            ImGui::PopTextWrapPos();
+            ImGui::EndTooltip();
+        }
+    }
+
+    void End() {
+        Widget::End();
+    }
+
+private:
+    std::string desc_;
+};
+
+
+class CollapsingHeader : public Widget,
+                         public Expandable
+{
+public:
+    CollapsingHeader(const std::string& label) : Widget(label) {
+        
+    }
+
+    void Begin() {
+        Widget::Begin();
+        expand_ = ImGui::CollapsingHeader(GetLabel().c_str());
+        UpdateContent(expand_);
+    }
+
+    void End() {
+        end_expand_ = expand_;
+        Widget::End();
+    }
+
+    /*
+    * Memory
+    */
+    MemoryUsage GetMemoryUsage() {
+        MemoryUsage usage = Widget::GetMemoryUsage();
+        size_t bytes = GetContentBytes();
+        usage.used += bytes;
+        usage.capacity += bytes;
+        return usage;
+    }
+
+    void TrimMemory() {
+        TrimContent();
+    }
+
+private:
+
+};
+
+class TreeNode : public Widget,
+                 public Expandable
+{
+public:
+    TreeNode(const std::string& label) : Widget(label) {
+        end_expand_ = false;
+        expand_ = false;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        expand_ = ImGui::TreeNode(GetLabel().c_str());
+        UpdateContent(expand_);
+    }
+
+    void End() {
+        if (expand_) {
+            ImGui::TreePop();
+        }
+        end_expand_ = expand_;
+        Widget::End();
+    }
+
+
+    /*
+    * Memory
+    */
+    MemoryUsage GetMemoryUsage() {
+        MemoryUsage usage = Widget::GetMemoryUsage();
+        size_t bytes = GetContentBytes();
+        usage.used += bytes;
+        usage.capacity += bytes;
+        return usage;
+    }
+
+    void TrimMemory() {
+        TrimContent();
+    }
+
+
+    /*
+    * Event
+    */
+private:
+};
+
+
+namespace internal {
+// Ѱַʹõ64λϣMurmurHash3finalizerǰ벿֣
+inline size_t MixKey(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (size_t)key;
+}
+} // namespace internal
+
+/*
+* ⻯ӳټ
+* ڵ״չʱͨloaderȡӽڵ㣬ѡں̨̳߳мأͬһڵӽڵţڵ״̬ѹNode
+* ɼбΪƽ飬չ/۵ֻɾӦУʱֻɼΧڵ
+*/
+class LazyTree : public Widget {
+public:
+    struct Item {
+        uint64_t id;
+        std::string label;
+        bool has_children;
+    };
+
+    // parentΪkRootIdʱظڵбں̨߳е
+    typedef std::function<void(uint64_t parent, std::vector<Item>& children)> Loader;
+
+    static constexpr uint64_t kRootId = UINT64_MAX;
+
+    LazyTree(const std::string& label, Loader loader, const ImVec2& size = ImVec2(0, 0)) : Widget(label), loader_(std::move(loader)) {
+        size_ = size;
+        async_ = false;
+        generation_ = 0;
+        shared_ = std::make_shared<Shared>();
+        end_selected_ = kRootId;
+        selected_ = kRootId;
+        index_count_ = 0;
+        Reset();
+    }
+
+    void Begin() {
+        Widget::Begin();
+        ApplyLoaded();
+        Node& root = nodes_[0];
+        if (!(root.flags & kLoaded)) {
+            Load(0);
+        }
+
+        uint32_t toggle = UINT32_MAX;
+        if (ImGui::BeginChild(GetLabel().c_str(), size_)) {
+            float indent = ImGui::GetTreeNodeToLabelSpacing();
+            float base_x = ImGui::GetCursorPosX();
+            ImGuiListClipper clipper;
+            clipper.Begin((int)rows_.size());
+            while (clipper.Step()) {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                    uint32_t index = rows_[row];
+                    Node& node = nodes_[index];
+                    ImGui::SetCursorPosX(base_x + (node.depth - 1) * indent);
+                    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_OpenOnArrow;
+                    if (!(node.flags & kHasChildren)) {
+                        flags |= ImGuiTreeNodeFlags_Leaf;
+                    }
+                    if (node.id == selected_) {
+                        flags |= ImGuiTreeNodeFlags_Selected;
+                    }
+                    ImGui::SetNextItemOpen((node.flags & kExpanded) != 0);
+                    const char* label = labels_.data() + node.label_offset;
+                    // 64λidֽΪID32λתΪָض
+                    ImGui::PushID((const char*)&node.id, (const char*)&node.id + sizeof(node.id));
+                    bool open = ImGui::TreeNodeEx("node", flags, (node.flags & kLoading) ? "%.*s (...)" : "%.*s", (int)node.label_length, label);
+                    ImGui::PopID();
+                    if (ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen()) {
+                        selected_ = node.id;
+                    }
+                    if (open != ((node.flags & kExpanded) != 0)) {
+                        toggle = (uint32_t)row;
+                    }
+                }
+            }
+        }
+        ImGui::EndChild();
+
+        // ƽ޸
+        if (toggle != UINT32_MAX) {
+            uint32_t index = rows_[toggle];
+            if (nodes_[index].flags & kExpanded) {
+                CollapseRow(toggle);
+            }
+            else {
+                ExpandRow(toggle);
+            }
+        }
+    }
+
+    void End() {
+        end_selected_ = selected_;
+        Widget::End();
+    }
+
+    /*
+    * Event
+    */
+    void SelectEvent(std::function<void(uint64_t)> event) {
+        if (end_selected_ != selected_) {
+            event(selected_);
+        }
+    }
+
+    /*
+    * Control
+    */
+    // нڵ㣬һ֡¼ظڵ
+    void Reset() {
+        BumpControlVersion();
+        generation_++;
+        nodes_.clear();
+        labels_.clear();
+        rows_.clear();
+        std::fill(index_.begin(), index_.end(), 0);
+        index_count_ = 0;
+        Node root = {};
+        root.id = kRootId;
+        root.flags = kHasChildren | kExpanded;
+        nodes_.push_back(root);
+    }
+
+    void SetAsync(bool async) {
+        async_ = async;
+    }
+
+    // ֻѼصĽڵЧڵ㲻ɼʱֻ޸״̬
+    void Expand(uint64_t id) {
+        BumpControlVersion();
+        SetExpanded(id, true);
+    }
+
+    void Collapse(uint64_t id) {
+        BumpControlVersion();
+        SetExpanded(id, false);
+    }
+
+    void Select(uint64_t id) {
+        BumpControlVersion();
+        selected_ = id;
+    }
+
+    uint64_t GetSelected() {
+        return selected_;
+    }
+
+    size_t GetRowCount() {
+        return rows_.size();
+    }
+
+    size_t GetNodeCount() {
+        return nodes_.size() - 1;
+    }
+
+    /*
+    * Memory
+    */
+    MemoryUsage GetMemoryUsage() {
+        size_t used = nodes_.size() * sizeof(Node) + labels_.size() + rows_.size() * sizeof(uint32_t) + index_count_ * sizeof(uint32_t);
+        size_t capacity = internal::HeapBytes(nodes_) + internal::HeapBytes(labels_) + internal::HeapBytes(rows_) + internal::HeapBytes(index_);
+        return MemoryUsage{ "list", used, capacity };
+    }
+
+    void TrimMemory() {
+        nodes_.shrink_to_fit();
+        labels_.shrink_to_fit();
+        rows_.shrink_to_fit();
+        RehashIndex(index_count_);
+    }
+
+private:
+    enum : uint8_t {
+        kHasChildren = 1 << 0,
+        kExpanded = 1 << 1,
+        kLoaded = 1 << 2,
+        kLoading = 1 << 3,
+    };
+
+    struct Node {
+        uint64_t id;
+        uint32_t parent;
+        uint32_t first_child;
+        uint32_t child_count;
+        uint32_t label_offset;
+        uint16_t label_length;
+        uint16_t depth;
+        uint8_t flags;
+    };
+
+    struct Loaded {
+        uint64_t generation;
+        uint32_t node;
+        std::vector<Item> children;
+    };
+
+    void Load(uint32_t index) {
+        Node& node = nodes_[index];
+        if (node.flags & (kLoaded | kLoading)) {
+            return;
+        }
+        if (!async_) {
+            std::vector<Item> children;
+            loader_(node.id, children);
+            Attach(index, children);
+            if (index == 0) {
+                InsertSubtree(0, 0);
+            }
+            return;
+        }
+        node.flags |= kLoading;
+        uint64_t id = node.id;
+        uint64_t generation = generation_;
+        Loader loader = loader_;
+        auto shared = shared_;
+        internal::GetWorkerPool().Post([shared, loader, id, index, generation]() {
+            Loaded loaded;
+            loaded.generation = generation;
+            loaded.node = index;
+            loader(id, loaded.children);
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            shared->loaded.push_back(std::move(loaded));
+            shared->pending.store(true, std::memory_order_release);
+        });
+    }
+
+    void ApplyLoaded() {
+        if (!shared_->pending.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::vector<Loaded> loaded;
+        {
+            std::lock_guard<std::mutex> lock(shared_->mutex);
+            loaded.swap(shared_->loaded);
+            shared_->pending.store(false, std::memory_order_relaxed);
+        }
+        for (auto& item : loaded) {
+            if (item.generation != generation_) {
+                continue;
+            }
+            Attach(item.node, item.children);
+            if (item.node == 0) {
+                InsertSubtree(0, 0);
+            }
+            else if ((nodes_[item.node].flags & kExpanded) && IsVisible(item.node)) {
+                int64_t row = FindRow(item.node);
+                if (row >= 0) {
+                    InsertSubtree((uint32_t)row + 1, item.node);
+                }
+            }
+        }
+    }
+
+    void Attach(uint32_t index, const std::vector<Item>& children) {
+        uint32_t first = (uint32_t)nodes_.size();
+        uint16_t depth = nodes_[index].depth + 1;
+        for (auto& child : children) {
+            Node node = {};
+            node.id = child.id;
+            node.parent = index;
+            node.label_offset = (uint32_t)labels_.size();
+            node.label_length = (uint16_t)std::min<size_t>(child.label.size(), UINT16_MAX);
+            node.depth = depth;
+            node.flags = child.has_children ? kHasChildren : 0;
+            labels_.insert(labels_.end(), child.label.begin(), child.label.begin() + node.label_length);
+            nodes_.push_back(node);
+            InsertIndex((uint32_t)nodes_.size() - 1);
+        }
+        Node& node = nodes_[index];
+        node.first_child = first;
+        node.child_count = (uint32_t)children.size();
+        node.flags = (node.flags | kLoaded) & ~kLoading;
+    }
+
+    // rowindexпɼ
+    void InsertSubtree(uint32_t row, uint32_t index) {
+        std::vector<uint32_t> subtree;
+        std::vector<std::pair<uint32_t, uint32_t>> stack;
+        stack.emplace_back(index, 0);
+        while (!stack.empty()) {
+            auto& top = stack.back();
+            Node& node = nodes_[top.first];
+            if (top.second >= node.child_count) {
+                stack.pop_back();
+                continue;
+            }
+            uint32_t child = node.first_child + top.second++;
+            subtree.push_back(child);
+            if ((nodes_[child].flags & kExpanded) && (nodes_[child].flags & kLoaded)) {
+                stack.emplace_back(child, 0);
+            }
+        }
+        rows_.insert(rows_.begin() + row, subtree.begin(), subtree.end());
+    }
+
+    void ExpandRow(uint32_t row) {
+        uint32_t index = rows_[row];
+        Node& node = nodes_[index];
+        node.flags |= kExpanded;
+        if (!(node.flags & kLoaded)) {
+            Load(index);
+            if (!(nodes_[index].flags & kLoaded)) {
+                return;
+            }
+        }
+        InsertSubtree(row + 1, index);
+    }
+
+    void CollapseRow(uint32_t row) {
+        uint32_t index = rows_[row];
+        nodes_[index].flags &= ~kExpanded;
+        uint16_t depth = nodes_[index].depth;
+        size_t end = row + 1;
+        while (end < rows_.size() && nodes_[rows_[end]].depth > depth) {
+            end++;
+        }
+        rows_.erase(rows_.begin() + row + 1, rows_.begin() + end);
+    }
+
+    // rows_Уֲңindexɼ
+    int64_t FindRow(uint32_t index) {
+        auto iter = std::lower_bound(rows_.begin(), rows_.end(), index, [this](uint32_t row, uint32_t index) {
+            return Precedes(row, index);
+        });
+        if (iter == rows_.end() || *iter != index) {
+            return -1;
+        }
+        return iter - rows_.begin();
+    }
+
+    // aǷb֮ǰͬһڵӽڵţ±Ƚϼ
+    bool Precedes(uint32_t a, uint32_t b) {
+        if (a == b) {
+            return false;
+        }
+        uint16_t origin_a = nodes_[a].depth;
+        uint16_t origin_b = nodes_[b].depth;
+        uint16_t depth_a = origin_a;
+        uint16_t depth_b = origin_b;
+        while (depth_a > depth_b) {
+            a = nodes_[a].parent;
+            depth_a--;
+        }
+        while (depth_b > depth_a) {
+            b = nodes_[b].parent;
+            depth_b--;
+        }
+        // һһȣǰ
+        if (a == b) {
+            return origin_a < origin_b;
+        }
+        while (nodes_[a].parent != nodes_[b].parent) {
+            a = nodes_[a].parent;
+            b = nodes_[b].parent;
+        }
+        return a < b;
+    }
+
+    bool IsVisible(uint32_t index) {
+        for (uint32_t parent = nodes_[index].parent; parent != 0; parent = nodes_[parent].parent) {
+            if (!(nodes_[parent].flags & kExpanded)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void SetExpanded(uint64_t id, bool expanded) {
+        uint32_t index = FindIndex(id);
+        if (index == 0) {
+            return;
+        }
+        bool current = (nodes_[index].flags & kExpanded) != 0;
+        if (current == expanded) {
+            return;
+        }
+        int64_t row = IsVisible(index) ? FindRow(index) : -1;
+        if (row < 0) {
+            nodes_[index].flags ^= kExpanded;
+            if (expanded) {
+                Load(index);
+            }
+            return;
+        }
+        if (expanded) {
+            ExpandRow((uint32_t)row);
+        }
+        else {
+            CollapseRow((uint32_t)row);
+        }
+    }
+
+    /*
+    * idnodes_±ĿѰַindex_0ʾλڵ㲻
+    * ڵֻResetʱûĹظidصĽڵΪ׼
+    */
+    uint32_t FindIndex(uint64_t id) {
+        if (index_.empty()) {
+            return 0;
+        }
+        size_t mask = index_.size() - 1;
+        for (size_t pos = internal::MixKey(id) & mask;; pos = (pos + 1) & mask) {
+            uint32_t entry = index_[pos];
+            if (entry == 0 || nodes_[entry].id == id) {
+                return entry;
+            }
+        }
+    }
+
+    void InsertIndex(uint32_t index) {
+        if ((index_count_ + 1) * 4 >= index_.size() * 3) {
+            RehashIndex(index_count_ + 1);
+        }
+        uint64_t id = nodes_[index].id;
+        size_t mask = index_.size() - 1;
+        size_t pos = internal::MixKey(id) & mask;
+        while (index_[pos] != 0 && nodes_[index_[pos]].id != id) {
+            pos = (pos + 1) & mask;
+        }
+        if (index_[pos] == 0) {
+            index_count_++;
+        }
+        index_[pos] = index;
+    }
+
+    // ռò3/4֤λTrimMemoryʱҲС
+    void RehashIndex(size_t count) {
+        size_t size = 16;
+        while ((count + 1) * 4 >= size * 3) {
+            size <<= 1;
+        }
+        if (size == index_.size()) {
+            return;
+        }
+        std::vector<uint32_t> old(size, 0);
+        old.swap(index_);
+        size_t mask = size - 1;
+        for (uint32_t entry : old) {
+            if (entry == 0) {
+                continue;
+            }
+            size_t pos = internal::MixKey(nodes_[entry].id) & mask;
+            while (index_[pos] != 0) {
+                pos = (pos + 1) & mask;
+            }
+            index_[pos] = entry;
+        }
+    }
+
+private:
+    // ̨ؽɹ߳ؼؼ߳Կɰȫд
+    struct Shared {
+        Shared() : pending(false) {}
+        std::mutex mutex;
+        std::vector<Loaded> loaded;
+        std::atomic<bool> pending;
+    };
+
+    Loader loader_;
+    ImVec2 size_;
+    bool async_;
+    uint64_t generation_;
+    std::shared_ptr<Shared> shared_;
+
+    std::vector<Node> nodes_;
+    std::vector<char> labels_;
+    std::vector<uint32_t> rows_;
+    std::vector<uint32_t> index_;
+    size_t index_count_;
+
+    uint64_t end_selected_;
+    uint64_t selected_;
+};
+
+class CheckBox : public Widget {
+public:
+    CheckBox(const std::string& label, bool check = false) : Widget(label) {
+        end_check_ = false;
+        check_ = check;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        check_binding_.Pull(check_);
+        if (ImGui::Checkbox(GetLabel().c_str(), &check_)) {
+            check_binding_.Push(check_);
+        }
+    }
+
+    void End() {
+        end_check_ = check_;
+        Widget::End();
+    }
+
+
+    /*
+    * Event
+    */
+    void CheckEvent(std::function<void()> event) {
+        if (end_check_ == false && check_ == true) {
+            internal::ConsumeInput();
+            event();
+        }
+    }
+
+    void UncheckEvent(std::function<void()> event) {
+        if (end_check_ == true && check_ == false) {
+            internal::ConsumeInput();
+            event();
+        }
+    }
+
+    /*
+    * Control
+    */
+    void SetCheck(bool check) {
+        BumpControlVersion();
+        check_ = check;
+        check_binding_.Push(check);
+    }
+
+    bool GetCheck() {
+        return check_;
+    }
+
+    void BindCheck(Property<bool>& check) {
+        check_binding_.Bind(&check);
+    }
+
+    void SaveState(internal::SnapshotWriter& writer) {
+        Widget::SaveState(writer);
+        writer.Write(check_);
+    }
+
+    void LoadState(internal::SnapshotReader& reader) {
+        Widget::LoadState(reader);
+        bool check;
+        if (reader.Read(check)) {
+            SetCheck(check);
+        }
+    }
+
+private:
+    bool end_check_;
+    bool check_;
+    internal::Binding<bool> check_binding_;
+};
+
+/*
+* ѡ
+* ѡ״̬һ֡״̬һλͼ棬ֻƿɼУ64λҳ仯
+* labelΪnullptrʱʾ
+*/
+class CheckBoxGrid : public Widget {
+public:
+    CheckBoxGrid(const std::string& label, uint32_t count, int columns = 1, const ImVec2& size = ImVec2(0, 0)) : Widget(label) {
+        count_ = 0;
+        columns_ = columns > 0 ? columns : 1;
+        size_ = size;
+        diffed_ = false;
+        Resize(count);
+    }
+
+    void Begin() {
+        Widget::Begin();
+        if (ImGui::BeginChild(GetLabel().c_str(), size_)) {
+            float column_width = ImGui::GetContentRegionAvail().x / columns_;
+            int rows = (int)((count_ + columns_ - 1) / columns_);
+            ImGuiListClipper clipper;
+            clipper.Begin(rows, ImGui::GetFrameHeightWithSpacing());
+            while (clipper.Step()) {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                    for (int column = 0; column < columns_; column++) {
+                        uint32_t index = (uint32_t)row * columns_ + column;
+                        if (index >= count_) {
+                            break;
+                        }
+                        if (column > 0) {
+                            ImGui::SameLine(column_width * column);
+                        }
+                        DrawCell(index);
+                    }
+                }
+            }
+        }
+        ImGui::EndChild();
+        Diff();
+        diffed_ = true;
+    }
+
+    void End() {
+        for (uint32_t word : dirty_words_) {
+            end_check_[word] = check_[word];
+        }
+        dirty_words_.clear();
+        diffed_ = false;
+        for (const PendingCheck& pending : pending_) {
+            if (pending.index == kAll) {
+                SetAll(pending.check);
+            }
+            else {
+                SetCheck(pending.index, pending.check);
+            }
+        }
+        pending_.clear();
+        Widget::End();
+    }
+
+    /*
+    * Event
+    */
+    // Ϊ֡״̬仯ţ
+    void ChangeEvent(std::function<void(const std::vector<uint32_t>&)> event) {
+        if (!flipped_.empty()) {
+            internal::ConsumeInput();
+            event(flipped_);
+        }
+    }
+
+    /*
+    * Control
+    * Begin֮End֮ǰ(ChangeEvent)޸ƳٵEndʱЧһ֡¼
+    */
+    void SetCheck(uint32_t index, bool check) {
+        BumpControlVersion();
+        if (index >= count_) {
+            return;
+        }
+        if (diffed_) {
+            pending_.push_back(PendingCheck{ index, check });
+            return;
+        }
+        uint64_t bit = 1ull << (index & 63);
+        if (check) {
+            check_[index >> 6] |= bit;
+        }
+        else {
+            check_[index >> 6] &= ~bit;
+        }
+    }
+
+    bool GetCheck(uint32_t index) {
+        if (index >= count_) {
+            return false;
+        }
+        return (check_[index >> 6] >> (index & 63)) & 1;
+    }
+
+    void SetAll(bool check) {
+        BumpControlVersion();
+        if (diffed_) {
+            pending_.push_back(PendingCheck{ kAll, check });
+            return;
+        }
+        std::fill(check_.begin(), check_.end(), check ? ~0ull : 0ull);
+        ClearTail(check_);
+    }
+
+    void Resize(uint32_t count) {
+        BumpControlVersion();
+        size_t words = ((size_t)count + 63) / 64;
+        count_ = count;
+        check_.resize(words, 0);
+        end_check_.resize(words, 0);
+        ClearTail(check_);
+        ClearTail(end_check_);
+        // BeginEnd֮СʱΧı仯Ƴٵ޸ģEndԽд
+        dirty_words_.erase(std::remove_if(dirty_words_.begin(), dirty_words_.end(), [words](uint32_t word) { return word >= words; }), dirty_words_.end());
+        flipped_.erase(std::remove_if(flipped_.begin(), flipped_.end(), [count](uint32_t index) { return index >= count; }), flipped_.end());
+        pending_.erase(std::remove_if(pending_.begin(), pending_.end(), [count](const PendingCheck& pending) {
+            return pending.index != kAll && pending.index >= count;
+        }), pending_.end());
+    }
+
+    uint32_t GetCount() {
+        return count_;
+    }
+
+    const std::vector<uint32_t>& GetFlipped() {
+        return flipped_;
+    }
+
+    void SetLabelGetter(std::function<const char*(uint32_t)> label_getter) {
+        BumpControlVersion();
+        label_getter_ = std::move(label_getter);
+    }
+
+    /*
+    * Memory
+    */
+    MemoryUsage GetMemoryUsage() {
+        size_t used = check_.size() * sizeof(uint64_t) * 2 + flipped_.size() * sizeof(uint32_t);
+        size_t capacity = internal::HeapBytes(check_) + internal::HeapBytes(end_check_) + internal::HeapBytes(flipped_) + internal::HeapBytes(dirty_words_) +
+            internal::HeapBytes(pending_);
+        return MemoryUsage{ "list", used, capacity };
+    }
+
+    void TrimMemory() {
+        flipped_.shrink_to_fit();
+        dirty_words_.shrink_to_fit();
+        pending_.shrink_to_fit();
+    }
+
+private:
+    static const uint32_t kAll = 0xFFFFFFFF;
+
+    struct PendingCheck {
+        uint32_t index;
+        bool check;
+    };
+
+    void DrawCell(uint32_t index) {
+        bool check = GetCheck(index);
+        ImGui::PushID((int)index);
+        const char* label = label_getter_ ? label_getter_(index) : nullptr;
+        bool changed;
+        if (label) {
+            changed = ImGui::Checkbox(label, &check);
+        }
+        else {
+            char buffer[16];
+            snprintf(buffer, sizeof(buffer), "%u", index);
+            changed = ImGui::Checkbox(buffer, &check);
+        }
+        ImGui::PopID();
+        if (changed) {
+            SetCheck(index, check);
+        }
+    }
+
+    void Diff() {
+        flipped_.clear();
+        for (size_t word = 0; word < check_.size(); word++) {
+            uint64_t diff = check_[word] ^ end_check_[word];
+            if (diff == 0) {
+                continue;
+            }
+            dirty_words_.push_back((uint32_t)word);
+            while (diff) {
+                flipped_.push_back((uint32_t)(word * 64 + CountTrailingZero(diff)));
+                diff &= diff - 1;
+            }
+        }
+    }
+
+    static int CountTrailingZero(uint64_t value) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return (int)index;
+#elif defined(_MSC_VER)
+        // 32λMSVCû_BitScanForward64
+        unsigned long index;
+        if (_BitScanForward(&index, (unsigned long)value)) {
+            return (int)index;
+        }
+        _BitScanForward(&index, (unsigned long)(value >> 32));
+        return (int)index + 32;
+#else
+        return __builtin_ctzll(value);
+#endif
+    }
+
+    void ClearTail(std::vector<uint64_t>& bits) {
+        if (count_ & 63) {
+            bits.back() &= (1ull << (count_ & 63)) - 1;
+        }
+    }
+
+private:
+    uint32_t count_;
+    int columns_;
+    ImVec2 size_;
+    std::function<const char*(uint32_t)> label_getter_;
+
+    std::vector<uint64_t> end_check_;
+    std::vector<uint64_t> check_;
+    std::vector<uint32_t> dirty_words_;
+    std::vector<uint32_t> flipped_;
+    bool diffed_;
+    std::vector<PendingCheck> pending_;
+};
+
+template<class Element = std::string>
+class ListBox : public Widget {
+public:
+    ListBox(const std::string& label) : Widget(label), size_(-FLT_MIN, -FLT_MIN) {
+        entry_ = false;
+        end_select_index_ = -1;
+        select_index_ = -1;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        entry_ = ImGui::BeginListBox(GetLabel().c_str(), size_);
+    }
+
+    void End() {
+        if (entry_) {
+            ImGui::EndListBox();
+        }
+        Widget::End();
+    }
+
+    /*
+    * Update
+    */
+    void InsertUpdate(std::function<std::string(Element&)> insert) {
+        for (int i = 0; i < list_.size(); i++) {
+            const bool is_selected = (select_index_ == i);
+            auto temp = insert(list_[i]);
+
+            if (temp.empty()) {
+                continue;
+            }
+
+            if (internal::CachedSelectable(i, temp.c_str(), temp.c_str() + temp.size(), is_selected)) {
+                select_index_ = i;
+            }
+
+            if (is_selected) {
+                ImGui::SetItemDefaultFocus();
+            }
+        }
+    }
+
+    /*
+    * Event
+    */
+    void SelectEvent(std::function<void()> event) {
+        if (end_select_index_ != select_index_) {
+            internal::ConsumeInput();
+            event();
+        }
+    }
+
+    /*
+    * Control
+    */
+    Element& GetSelectItem() {
+        return list_.at(select_index_);
+    }
+
+    int GetSelectIndex() {
+        return select_index_;
+    }
+
+    void SetSelectIndex(int select_index) {
+        BumpControlVersion();
+        select_index_ = select_index;
+    }
+
+    void SaveState(internal::SnapshotWriter& writer) {
+        Widget::SaveState(writer);
+        writer.Write(select_index_);
+    }
+
+    void LoadState(internal::SnapshotReader& reader) {
+        Widget::LoadState(reader);
+        reader.Read(select_index_);
+    }
+
+    void SetSize(const ImVec2& size) {
+        BumpControlVersion();
+        size_ = size;
+    }
+
+    ImVec2& GetSize() {
+        return size_;
+    }
+
+    void SetList(std::vector<Element>&& list) {
+        BumpControlVersion();
+        list_ = std::move(list);
+    }
+
+    std::vector<Element>& GetList() {
+        return list_;
+    }
+
+    void ClearList() {
+        BumpControlVersion();
+        list_.clear();
+    }
+
+    /*
+    * Memory
+    */
+    MemoryUsage GetMemoryUsage() {
+        size_t capacity = internal::HeapBytes(list_);
+        size_t used = capacity - (list_.capacity() - list_.size()) * sizeof(Element);
+        return MemoryUsage{ "list", used, capacity };
+    }
+
+    void TrimMemory() {
+        list_.shrink_to_fit();
+    }
+
+private:
+    std::vector<Element> list_;
+
+    ImVec2 size_;
+
+    bool entry_;
+
+    int end_select_index_;
+    int select_index_;
+};
+
+class RadioButtonGroup : public Widget {
+public:
+    RadioButtonGroup(std::vector<std::string> label_list) : Widget(""), label_list_(label_list){
+        push_index_ = 0;
+        select_index_ = 0;
+        end_select_index_ = 0;
+    }
+
+    void Begin(std::function<void(size_t)> push) {
+        Widget::Begin();
+        push_index_ = 0;
+        for (size_t i = 0; i < label_list_.size(); i++) {
+            ImGui::RadioButton(label_list_[i].c_str(), &select_index_, push_index_++);
+            push(i);
+        }
+    }
+
+    void Begin() {
+        Begin([](size_t i) {});
+    }
+
+    void End() {
+        end_select_index_ = select_index_;
+        Widget::End();
+    }
+
+
+    void SelectEvent(std::function<void()> event) {
+        if (end_select_index_ != select_index_) {
+            internal::ConsumeInput();
+            event();
+        }
+    }
+
+private:
+    std::vector<std::string> label_list_;
+
+    int push_index_;
+    int end_select_index_;
+    int select_index_;
+};
+
+
+/*
+* ʱͼ
+* ڻλУ4άmin/maxÿ֡ÿ2
+* ÿͬԼռ7ֽڣĬԼ100KBʱʽcapacity
+*/
+class Plot : public Widget {
+public:
+    Plot(const std::string& label, size_t capacity = 1 << 14) : Widget(label), size_(-FLT_MIN, 150.0f) {
+        capacity_ = 4;
+        while (capacity_ < capacity) {
+            capacity_ <<= 1;
+        }
+        samples_.resize(capacity_);
+        for (size_t block = kFanout; block <= capacity_; block *= kFanout) {
+            levels_.emplace_back(capacity_ / block);
+        }
+
+        total_ = 0;
+        size_count_ = 0;
+
+        view_begin_ = 0.0;
+        view_count_ = 0.0;
+        follow_ = true;
+
+        auto_fit_y_ = true;
+        y_min_ = 0.0f;
+        y_max_ = 1.0f;
+
+        draw_point_count_ = 0;
+    }
+
+    void Begin() {
+        Widget::Begin();
+
+        ImVec2 size = ImGui::CalcItemSize(size_, ImGui::CalcItemWidth(), size_.y);
+        ImVec2 pos = ImGui::GetCursorScreenPos();
+        int width = (int)size.x;
+        if (width < 1 || size.y < 1.0f) {
+            // InvisibleButton򸺵ĳߴ磬ֻռλ
+            ImGui::Dummy(ImVec2(std::max(size.x, 0.0f), std::max(size.y, 0.0f)));
+            draw_point_count_ = 0;
+            return;
+        }
+        ImGui::InvisibleButton(GetLabel().c_str(), size);
+        bool hovered = ImGui::IsItemHovered();
+        bool active = ImGui::IsItemActive();
+
+        HandleInput(pos, size, hovered, active);
+        if (follow_) {
+            view_begin_ = (double)total_ - view_count_;
+        }
+        ClampView();
+
+        BuildColumns(width);
+
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        ImVec2 max(pos.x + size.x, pos.y + size.y);
+        draw_list->AddRectFilled(pos, max, ImGui::GetColorU32(ImGuiCol_FrameBg));
+        draw_list->PushClipRect(pos, max, true);
+
+        float y_range = (y_max_ - y_min_) != 0.0f ? (y_max_ - y_min_) : 1.0f;
+        float y_scale = (size.y - 1.0f) / y_range;
+        points_.clear();
+        for (int i = 0; i < (int)columns_.size(); i++) {
+            const Column& column = columns_[i];
+            if (column.count == 0) {
+                continue;
+            }
+            float x = pos.x + (float)column.x;
+            points_.push_back(ImVec2(x, max.y - 1.0f - (column.min - y_min_) * y_scale));
+            if (column.max != column.min) {
+                points_.push_back(ImVec2(x, max.y - 1.0f - (column.max - y_min_) * y_scale));
+            }
+        }
+        draw_point_count_ = (int)points_.size();
+        if (points_.size() >= 2) {
+            draw_list->AddPolyline(points_.data(), (int)points_.size(), ImGui::GetColorU32(ImGuiCol_PlotLines), ImDrawFlags_None, 1.0f);
+        }
+        draw_list->PopClipRect();
+
+        const std::string& label = GetLabel();
+        const char* label_end = ImGui::FindRenderedTextEnd(label.c_str());
+        if (label_end != label.c_str()) {
+            draw_list->AddText(ImVec2(pos.x + 4.0f, pos.y + 2.0f), ImGui::GetColorU32(ImGuiCol_Text), label.c_str(), label_end);
+        }
+    }
+
+    void End() {
+        Widget::End();
+    }
+
+    /*
+    * Control
+    */
+    void Append(float value) {
+        BumpControlVersion();
+        size_t slot = (size_t)(total_ & (capacity_ - 1));
+        samples_[slot] = value;
+        size_t block = kFanout;
+        for (size_t level = 0; level < levels_.size(); level++, block *= kFanout) {
+            Level& lv = levels_[level];
+            size_t index = (size_t)((total_ / block) & (lv.min.size() - 1));
+            if ((total_ & (block - 1)) == 0) {
+                lv.min[index] = value;
+                lv.max[index] = value;
+            }
+            else {
+                if (value < lv.min[index]) lv.min[index] = value;
+                if (value > lv.max[index]) lv.max[index] = value;
+            }
+        }
+        total_++;
+        if (size_count_ < capacity_) {
+            size_count_++;
+        }
+    }
+
+    void Append(const float* values, size_t count) {
+        BumpControlVersion();
+        for (size_t i = 0; i < count; i++) {
+            Append(values[i]);
+        }
+    }
+
+    void Clear() {
+        BumpControlVersion();
+        total_ = 0;
+        size_count_ = 0;
+        view_begin_ = 0.0;
+        view_count_ = 0.0;
+        follow_ = true;
+    }
+
+    size_t GetSampleCount() {
+        return size_count_;
+    }
+
+    size_t GetCapacity() {
+        return capacity_;
+    }
+
+    // ͼΧλΪţԵһAppendۼƣ
+    void SetView(double begin, double count) {
+        BumpControlVersion();
+        view_begin_ = begin;
+        view_count_ = count;
+        follow_ = false;
+    }
+
+    double GetViewBegin() {
+        return view_begin_;
+    }
+
+    double GetViewCount() {
+        return view_count_;
+    }
+
+    // ʾȫݲ
+    void Fit() {
+        BumpControlVersion();
+        view_count_ = 0.0;
+        follow_ = true;
+    }
+
+    void SetFollow(bool follow) {
+        BumpControlVersion();
+        follow_ = follow;
+    }
+
+    void SetYRange(float min, float max) {
+        BumpControlVersion();
+        y_min_ = min;
+        y_max_ = max;
+        auto_fit_y_ = false;
+    }
+
+    void SetAutoFitY(bool enable) {
+        BumpControlVersion();
+        auto_fit_y_ = enable;
+    }
+
+    void SetSize(const ImVec2& size) {
+        BumpControlVersion();
+        size_ = size;
+    }
+
+    ImVec2& GetSize() {
+        return size_;
+    }
+
+    // һ֡ύAddPolylineĵֻؼй
+    int GetDrawPointCount() {
+        return draw_point_count_;
+    }
+
+    MemoryUsage GetMemoryUsage() {
+        size_t bytes = samples_.capacity() * sizeof(float) + columns_.capacity() * sizeof(Column) + points_.capacity() * sizeof(ImVec2);
+        for (const Level& level : levels_) {
+            bytes += (level.min.capacity() + level.max.capacity()) * sizeof(float);
+        }
+        return MemoryUsage{ "plot", bytes, bytes };
+    }
+
+    void TrimMemory() {
+    }
+
+private:
+    static constexpr size_t kFanout = 4;
+
+    struct Level {
+        Level(size_t size) : min(size), max(size) {}
+        std::vector<float> min;
+        std::vector<float> max;
+    };
+
+    struct Column {
+        int x;
+        size_t count;
+        float min;
+        float max;
+    };
+
+    uint64_t OldestIndex() {
+        return total_ - size_count_;
+    }
+
+    void ClampView() {
+        double oldest = (double)OldestIndex();
+        double available = (double)size_count_;
+        if (view_count_ <= 0.0 || view_count_ > available) {
+            view_count_ = available;
+        }
+        if (view_count_ < 2.0) {
+            view_count_ = available < 2.0 ? available : 2.0;
+        }
+        if (view_begin_ < oldest) {
+            view_begin_ = oldest;
+        }
+        if (view_begin_ + view_count_ > (double)total_) {
+            view_begin_ = (double)total_ - view_count_;
+        }
+    }
+
+    void HandleInput(const ImVec2& pos, const ImVec2& size, bool hovered, bool active) {
+        ImGuiIO& io = ImGui::GetIO();
+        if (view_count_ <= 0.0) {
+            view_count_ = (double)size_count_;
+        }
+        double samples_per_px = view_count_ / size.x;
+        if (active && io.MouseDelta.x != 0.0f) {
+            view_begin_ -= io.MouseDelta.x * samples_per_px;
+            follow_ = false;
+        }
+        if (hovered && io.MouseWheel != 0.0f) {
+            double anchor = view_begin_ + (io.MousePos.x - pos.x) * samples_per_px;
+            double scale = std::pow(0.8, (double)io.MouseWheel);
+            view_count_ *= scale;
+            view_begin_ = anchor - (anchor - view_begin_) * scale;
+            follow_ = false;
+        }
+        if (hovered && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+            Fit();
+        }
+    }
+
+    void Accumulate(Column& column, float min, float max) {
+        if (column.count == 0) {
+            column.min = min;
+            column.max = max;
+        }
+        else {
+            if (min < column.min) column.min = min;
+            if (max > column.max) column.max = max;
+        }
+        column.count++;
+    }
+
+    // ÿѡ񲻳ȵĽ㼶ۺmin/max
+    void BuildColumns(int width) {
+        columns_.clear();
+        if (size_count_ == 0) {
+            return;
+        }
+        uint64_t oldest = OldestIndex();
+        uint64_t begin = (uint64_t)view_begin_;
+        uint64_t end = (uint64_t)std::ceil(view_begin_ + view_count_);
+        if (begin < oldest) begin = oldest;
+        if (end > total_) end = total_;
+        if (begin >= end) {
+            return;
+        }
+        double samples_per_px = (double)(end - begin) / width;
+
+        if (samples_per_px <= 1.0) {
+            for (uint64_t i = begin; i < end; i++) {
+                float v = samples_[(size_t)(i & (capacity_ - 1))];
+                Column column = { (int)((i - begin) / samples_per_px), 1, v, v };
+                columns_.push_back(column);
+            }
+        }
+        else {
+            int level = -1;
+            size_t block = 1;
+            while (level + 1 < (int)levels_.size() && (double)(block * kFanout) <= samples_per_px) {
+                block *= kFanout;
+                level++;
+            }
+            columns_.resize(width);
+            for (int x = 0; x < width; x++) {
+                Column& column = columns_[x];
+                column.x = x;
+                column.count = 0;
+                uint64_t s0 = begin + (uint64_t)(x * samples_per_px);
+                uint64_t s1 = begin + (uint64_t)((x + 1) * samples_per_px);
+                if (s1 > end) s1 = end;
+                if (s1 <= s0) s1 = s0 + 1;
+                if (level < 0) {
+                    for (uint64_t i = s0; i < s1; i++) {
+                        float v = samples_[(size_t)(i & (capacity_ - 1))];
+                        Accumulate(column, v, v);
+                    }
+                    continue;
+                }
+                // ɵĿѱθǣ˻ԭʼ
+                const Level& lv = levels_[level];
+                size_t mask = lv.min.size() - 1;
+                uint64_t first_block = (oldest + block - 1) / block;
+                uint64_t b = s0 / block;
+                if (b < first_block) {
+                    b = first_block;
+                }
+                for (; b <= (s1 - 1) / block; b++) {
+                    size_t index = (size_t)(b & mask);
+                    Accumulate(column, lv.min[index], lv.max[index]);
+                }
+                if (column.count == 0) {
+                    for (uint64_t i = s0; i < s1; i++) {
+                        float v = samples_[(size_t)(i & (capacity_ - 1))];
+                        Accumulate(column, v, v);
+                    }
+                }
+            }
+        }
+
+        if (auto_fit_y_) {
+            bool first = true;
+            for (const Column& column : columns_) {
+                if (column.count == 0) {
+                    continue;
+                }
+                if (first || column.min < y_min_) y_min_ = column.min;
+                if (first || column.max > y_max_) y_max_ = column.max;
+                first = false;
+            }
+        }
+    }
+
+private:
+    std::vector<float> samples_;
+    std::vector<Level> levels_;
+    size_t capacity_;
+    uint64_t total_;
+    size_t size_count_;
+
+    double view_begin_;
+    double view_count_;
+    bool follow_;
+
+    bool auto_fit_y_;
+    float y_min_;
+    float y_max_;
+
+    ImVec2 size_;
+
+    std::vector<Column> columns_;
+    std::vector<ImVec2> points_;
+    int draw_point_count_;
+};
+
+
+/*
+* ڵͼ
+* ڵߵİΧаռÿֻ֡ѯƿɼ֣вҲͨͬһ
+* СڵֻмʱлΪ򻯻ƣȥֺߣȥֻɫ
+* Խĳߵ棬ÿֱ֡ͼ
+*/
+class NodeGraph : public Widget {
+public:
+    typedef uint32_t NodeId;
+    typedef uint32_t EdgeId;
+
+    static constexpr NodeId kNoNode = UINT32_MAX;
+    static constexpr EdgeId kNoEdge = UINT32_MAX;
+
+    enum Lod {
+        kLodDetail,
+        kLodSimple,
+        kLodDot,
+    };
+
+    NodeGraph(const std::string& label) : Widget(label), size_(-FLT_MIN, 400.0f) {
+        cell_size_ = 256.0f;
+        canvas_pos_ = ImVec2(0.0f, 0.0f);
+        canvas_size_ = ImVec2(0.0f, 0.0f);
+        view_origin_ = ImVec2(0.0f, 0.0f);
+        zoom_ = 1.0f;
+        dirty_ = true;
+        stamp_ = 0;
+
+        end_selected_ = kNoNode;
+        selected_ = kNoNode;
+        hovered_ = kNoNode;
+        drag_node_ = kNoNode;
+        drag_moved_ = false;
+
+        lod_ = kLodDetail;
+        lod_height_ = 0.0f;
+        visible_node_count_ = 0;
+        visible_edge_count_ = 0;
+    }
+
+    void Begin() {
+        Widget::Begin();
+
+        ImVec2 size = ImGui::CalcItemSize(size_, ImGui::CalcItemWidth(), size_.y);
+        ImVec2 pos = ImGui::GetCursorScreenPos();
+        ImGui::InvisibleButton(GetLabel().c_str(), size);
+        bool hovered = ImGui::IsItemHovered();
+        bool active = ImGui::IsItemActive();
+        if (size.x < 1.0f || size.y < 1.0f) {
+            return;
+        }
+        canvas_pos_ = pos;
+        canvas_size_ = size;
+
+        if (dirty_) {
+            BuildIndex();
+        }
+        HandleInput(hovered, active);
+        Draw();
+    }
+
+    void End() {
+        end_selected_ = selected_;
+        Widget::End();
+    }
+
+    /*
+    * Event
+    */
+    void SelectEvent(std::function<void(NodeId)> event) {
+        if (selected_ != end_selected_) {
+            event(selected_);
+        }
+    }
+
+    /*
+    * Control
+    */
+    NodeId AddNode(const std::string& label, const ImVec2& pos, const ImVec2& size = ImVec2(120.0f, 40.0f), ImU32 color = IM_COL32(60, 90, 140, 255)) {
+        BumpControlVersion();
+        Node node;
+        node.pos = pos;
+        node.size = size;
+        node.color = color;
+        node.label_offset = (uint32_t)labels_.size();
+        node.label_length = (uint32_t)label.size();
+        labels_.append(label);
+        nodes_.push_back(node);
+        dirty_ = true;
+        return (NodeId)(nodes_.size() - 1);
+    }
+
+    // fromtoӵĽڵʱkNoEdge
+    EdgeId AddEdge(NodeId from, NodeId to) {
+        if (from >= nodes_.size() || to >= nodes_.size()) {
+            return kNoEdge;
+        }
+        BumpControlVersion();
+        Edge edge;
+        edge.from = from;
+        edge.to = to;
+        edges_.push_back(edge);
+        dirty_ = true;
+        return (EdgeId)(edges_.size() - 1);
+    }
+
+    void SetNodePos(NodeId id, const ImVec2& pos) {
+        BumpControlVersion();
+        nodes_[id].pos = pos;
+        dirty_ = true;
+    }
+
+    ImVec2 GetNodePos(NodeId id) {
+        return nodes_[id].pos;
+    }
+
+    void Reserve(size_t node_count, size_t edge_count) {
+        nodes_.reserve(node_count);
+        edges_.reserve(edge_count);
+    }
+
+    void Clear() {
+        BumpControlVersion();
+        nodes_.clear();
+        edges_.clear();
+        labels_.clear();
+        selected_ = kNoNode;
+        hovered_ = kNoNode;
+        EndDrag();
+        dirty_ = true;
+    }
+
+    size_t GetNodeCount() {
+        return nodes_.size();
+    }
+
+    size_t GetEdgeCount() {
+        return edges_.size();
+    }
+
+    void Select(NodeId id) {
+        BumpControlVersion();
+        selected_ = id;
+    }
+
+    NodeId GetSelected() {
+        return selected_;
+    }
+
+    NodeId GetHovered() {
+        return hovered_;
+    }
+
+    // ͼϽǶӦ
+    void SetView(const ImVec2& origin, float zoom) {
+        BumpControlVersion();
+        view_origin_ = origin;
+        zoom_ = ImClamp(zoom, kMinZoom, kMaxZoom);
+    }
+
+    ImVec2 GetViewOrigin() {
+        return view_origin_;
+    }
+
+    float GetZoom() {
+        return zoom_;
+    }
+
+    // ŵʾȫڵ㣬ߴȡһֵ֡
+    void Fit() {
+        BumpControlVersion();
+        if (nodes_.empty() || canvas_size_.x <= 0.0f) {
+            return;
+        }
+        if (dirty_) {
+            BuildIndex();
+        }
+        ImVec2 extent(bounds_max_.x - bounds_min_.x, bounds_max_.y - bounds_min_.y);
+        float zoom = std::min(canvas_size_.x / std::max(extent.x, 1.0f), canvas_size_.y / std::max(extent.y, 1.0f)) * 0.95f;
+        zoom_ = ImClamp(zoom, kMinZoom, kMaxZoom);
+        view_origin_.x = (bounds_min_.x + bounds_max_.x) * 0.5f - canvas_size_.x * 0.5f / zoom_;
+        view_origin_.y = (bounds_min_.y + bounds_max_.y) * 0.5f - canvas_size_.y * 0.5f / zoom_;
+    }
+
+    // ߳λΪ꣬Ӧ볣ڵߴͬһ
+    void SetCellSize(float cell_size) {
+        BumpControlVersion();
+        cell_size_ = std::max(cell_size, 1.0f);
+        dirty_ = true;
+    }
+
+    // вԣposΪ
+    NodeId HitTest(const ImVec2& pos) {
+        if (dirty_) {
+            BuildIndex();
+        }
+        // ϶ĽڵеλѾڣԲλϲ
+        if (drag_node_ != kNoNode && Contains(nodes_[drag_node_], pos)) {
+            return drag_node_;
+        }
+        NodeId hit = kNoNode;
+        QueryGrid(node_grid_, pos, pos, node_stamps_, [&](uint32_t id) {
+            if (id != drag_node_ && Contains(nodes_[id], pos)) {
+                // ӵĽڵϲ
+                if (hit == kNoNode || id > hit) {
+                    hit = id;
+                }
+            }
+        });
+        return hit;
+    }
+
+    void SetSize(const ImVec2& size) {
+        BumpControlVersion();
+        size_ = size;
+    }
+
+    ImVec2& GetSize() {
+        return size_;
+    }
+
+    // һ֡ƵĽڵ
+    size_t GetVisibleNodeCount() {
+        return visible_node_count_;
+    }
+
+    size_t GetVisibleEdgeCount() {
+        return visible_edge_count_;
+    }
+
+    Lod GetLod() {
+        return lod_;
+    }
+
+    /*
+    * Memory
+    */
+    MemoryUsage GetMemoryUsage() {
+        size_t used = nodes_.size() * sizeof(Node) + edges_.size() * sizeof(Edge) + labels_.size() +
+            node_grid_.items.size() * sizeof(uint32_t) + edge_grid_.items.size() * sizeof(uint32_t) + long_edges_.size() * sizeof(uint32_t);
+        size_t capacity = internal::HeapBytes(nodes_) + internal::HeapBytes(edges_) + internal::HeapBytes(labels_) +
+            internal::HeapBytes(node_grid_.start) + internal::HeapBytes(node_grid_.items) +
+            internal::HeapBytes(edge_grid_.start) + internal::HeapBytes(edge_grid_.items) +
+            internal::HeapBytes(long_edges_) + internal::HeapBytes(node_stamps_) + internal::HeapBytes(edge_stamps_) +
+            internal::HeapBytes(visible_) + internal::HeapBytes(dot_colors_) + internal::HeapBytes(dot_cells_);
+        return MemoryUsage{ "node graph", used, capacity };
+    }
+
+    void TrimMemory() {
+        nodes_.shrink_to_fit();
+        edges_.shrink_to_fit();
+        labels_.shrink_to_fit();
+        std::vector<uint32_t>().swap(visible_);
+        std::vector<ImU32>().swap(dot_colors_);
+        std::vector<uint32_t>().swap(dot_cells_);
+    }
+
+private:
+    static constexpr float kMinZoom = 0.001f;
+    static constexpr float kMaxZoom = 10.0f;
+    // ǼǵʱΪ
+    static constexpr int kMaxEdgeCells = 64;
+    static constexpr int kMaxGridCells = 1 << 20;
+    // ״ϸڼºϲƵĻӱ߳
+    static constexpr float kDotCellSize = 2.0f;
+
+    struct Node {
+        ImVec2 pos;
+        ImVec2 size;
+        ImU32 color;
+        uint32_t label_offset;
+        uint32_t label_length;
+    };
+
+    struct Edge {
+        NodeId from;
+        NodeId to;
+    };
+
+    // յľcellĿΪitems[start[cell], start[cell + 1])
+    struct Grid {
+        ImVec2 origin;
+        float cell;
+        int width;
+        int height;
+        std::vector<uint32_t> start;
+        std::vector<uint32_t> items;
+    };
+
+    static bool Contains(const Node& node, const ImVec2& pos) {
+        return pos.x >= node.pos.x && pos.y >= node.pos.y && pos.x < node.pos.x + node.size.x && pos.y < node.pos.y + node.size.y;
+    }
+
+    static bool Overlaps(const ImVec2& min, const ImVec2& max, const ImVec2& view_min, const ImVec2& view_max) {
+        return max.x >= view_min.x && max.y >= view_min.y && min.x <= view_max.x && min.y <= view_max.y;
+    }
+
+    void NodeBounds(const Node& node, ImVec2* min, ImVec2* max) {
+        *min = node.pos;
+        *max = ImVec2(node.pos.x + node.size.x, node.pos.y + node.size.y);
+    }
+
+    // λĸƵ͹
+    void EdgePoints(const Edge& edge, ImVec2 points[4]) {
+        const Node& from = nodes_[edge.from];
+        const Node& to = nodes_[edge.to];
+        points[0] = ImVec2(from.pos.x + from.size.x, from.pos.y + from.size.y * 0.5f);
+        points[3] = ImVec2(to.pos.x, to.pos.y + to.size.y * 0.5f);
+        float offset = std::max(std::fabs(points[3].x - points[0].x) * 0.5f, 20.0f);
+        points[1] = ImVec2(points[0].x + offset, points[0].y);
+        points[2] = ImVec2(points[3].x - offset, points[3].y);
+    }
+
+    void EdgeBounds(const Edge& edge, ImVec2* min, ImVec2* max) {
+        ImVec2 points[4];
+        EdgePoints(edge, points);
+        *min = points[0];
+        *max = points[0];
+        for (int i = 1; i < 4; i++) {
+            *min = ImMin(*min, points[i]);
+            *max = ImMax(*max, points[i]);
+        }
+    }
+
+    void CellRange(const Grid& grid, const ImVec2& min, const ImVec2& max, int* x0, int* y0, int* x1, int* y1) {
+        *x0 = ImClamp((int)std::floor((min.x - grid.origin.x) / grid.cell), 0, grid.width - 1);
+        *y0 = ImClamp((int)std::floor((min.y - grid.origin.y) / grid.cell), 0, grid.height - 1);
+        *x1 = ImClamp((int)std::floor((max.x - grid.origin.x) / grid.cell), 0, grid.width - 1);
+        *y1 = ImClamp((int)std::floor((max.y - grid.origin.y) / grid.cell), 0, grid.height - 1);
+    }
+
+    // boundsfalseĿǼ
+    template<class Bounds>
+    void BuildGrid(Grid& grid, size_t count, Bounds bounds) {
+        size_t cells = (size_t)grid.width * grid.height;
+        grid.start.assign(cells + 1, 0);
+        for (int pass = 0; pass < 2; pass++) {
+            for (size_t i = 0; i < count; i++) {
+                ImVec2 min, max;
+                if (!bounds(i, &min, &max)) {
+                    continue;
+                }
+                int x0, y0, x1, y1;
+                CellRange(grid, min, max, &x0, &y0, &x1, &y1);
+                for (int y = y0; y <= y1; y++) {
+                    for (int x = x0; x <= x1; x++) {
+                        size_t cell = (size_t)y * grid.width + x;
+                        if (pass == 0) {
+                            grid.start[cell + 1]++;
+                        }
+                        else {
+                            grid.items[fill_[cell]++] = (uint32_t)i;
+                        }
+                    }
+                }
+            }
+            if (pass == 0) {
+                for (size_t c = 0; c < cells; c++) {
+                    grid.start[c + 1] += grid.start[c];
+                }
+                grid.items.resize(grid.start[cells]);
+                fill_.assign(grid.start.begin(), grid.start.end() - 1);
+            }
+        }
+    }
+
+    template<class Visit>
+    void QueryGrid(const Grid& grid, const ImVec2& min, const ImVec2& max, std::vector<uint32_t>& stamps, Visit visit) {
+        if (grid.items.empty() || max.x < grid.origin.x || max.y < grid.origin.y ||
+            min.x > grid.origin.x + grid.cell * grid.width || min.y > grid.origin.y + grid.cell * grid.height) {
+            return;
+        }
+        // ԽĿֻһ
+        if (++stamp_ == 0) {
+            std::fill(node_stamps_.begin(), node_stamps_.end(), 0);
+            std::fill(edge_stamps_.begin(), edge_stamps_.end(), 0);
+            stamp_ = 1;
+        }
+        int x0, y0, x1, y1;
+        CellRange(grid, min, max, &x0, &y0, &x1, &y1);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                size_t cell = (size_t)y * grid.width + x;
+                for (uint32_t i = grid.start[cell]; i < grid.start[cell + 1]; i++) {
+                    uint32_t id = grid.items[i];
+                    if (stamps[id] != stamp_) {
+                        stamps[id] = stamp_;
+                        visit(id);
+                    }
+                }
+            }
+        }
+    }
+
+    void BuildIndex() {
+        dirty_ = false;
+        bounds_min_ = ImVec2(0.0f, 0.0f);
+        bounds_max_ = ImVec2(0.0f, 0.0f);
+        for (size_t i = 0; i < nodes_.size(); i++) {
+            ImVec2 min, max;
+            NodeBounds(nodes_[i], &min, &max);
+            bounds_min_ = i == 0 ? min : ImMin(bounds_min_, min);
+            bounds_max_ = i == 0 ? max : ImMax(bounds_max_, max);
+        }
+        // ߵĿƵܳڵ㷶Χ
+        ImVec2 edge_min = bounds_min_;
+        ImVec2 edge_max = bounds_max_;
+        for (const Edge& edge : edges_) {
+            ImVec2 min, max;
+            EdgeBounds(edge, &min, &max);
+            edge_min = ImMin(edge_min, min);
+            edge_max = ImMax(edge_max, max);
+        }
+
+        // ʱŴ߳
+        float cell = cell_size_;
+        ImVec2 extent(edge_max.x - edge_min.x, edge_max.y - edge_min.y);
+        while ((extent.x / cell + 1.0f) * (extent.y / cell + 1.0f) > (float)kMaxGridCells) {
+            cell *= 2.0f;
+        }
+        for (Grid* grid : { &node_grid_, &edge_grid_ }) {
+            grid->origin = edge_min;
+            grid->cell = cell;
+            grid->width = (int)(extent.x / cell) + 1;
+            grid->height = (int)(extent.y / cell) + 1;
+        }
+
+        BuildGrid(node_grid_, nodes_.size(), [this](size_t i, ImVec2* min, ImVec2* max) {
+            NodeBounds(nodes_[i], min, max);
+            return true;
+        });
+        long_edges_.clear();
+        BuildGrid(edge_grid_, edges_.size(), [this](size_t i, ImVec2* min, ImVec2* max) {
+            EdgeBounds(edges_[i], min, max);
+            int x0, y0, x1, y1;
+            CellRange(edge_grid_, *min, *max, &x0, &y0, &x1, &y1);
+            if ((x1 - x0 + 1) * (y1 - y0 + 1) > kMaxEdgeCells) {
+                // 鶼Ǽǣȥ
+                long_edges_.push_back((uint32_t)i);
+                return false;
+            }
+            return true;
+        });
+        std::sort(long_edges_.begin(), long_edges_.end());
+        long_edges_.erase(std::unique(long_edges_.begin(), long_edges_.end()), long_edges_.end());
+        std::vector<uint32_t>().swap(fill_);
+        // ϸڼ𰴽ڵ߶ȵλܸشСڵӰ
+        std::vector<float> heights(nodes_.size());
+        for (size_t i = 0; i < nodes_.size(); i++) {
+            heights[i] = nodes_[i].size.y;
+        }
+        lod_height_ = 0.0f;
+        if (!heights.empty()) {
+            std::nth_element(heights.begin(), heights.begin() + heights.size() / 2, heights.end());
+            lod_height_ = heights[heights.size() / 2];
+        }
+        node_stamps_.assign(nodes_.size(), 0);
+        edge_stamps_.assign(edges_.size(), 0);
+        stamp_ = 0;
+    }
+
+    ImVec2 ToWorld(const ImVec2& screen) {
+        return ImVec2(view_origin_.x + (screen.x - canvas_pos_.x) / zoom_, view_origin_.y + (screen.y - canvas_pos_.y) / zoom_);
+    }
+
+    ImVec2 ToScreen(const ImVec2& world) {
+        return ImVec2(canvas_pos_.x + (world.x - view_origin_.x) * zoom_, canvas_pos_.y + (world.y - view_origin_.y) * zoom_);
+    }
+
+    void HandleInput(bool hovered, bool active) {
+        ImGuiIO& io = ImGui::GetIO();
+        ImVec2 mouse = ToWorld(io.MousePos);
+        hovered_ = hovered ? HitTest(mouse) : kNoNode;
+
+        if (hovered && ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+            selected_ = hovered_;
+            if (hovered_ != kNoNode) {
+                BeginDrag(hovered_);
+            }
+        }
+        if (!active && drag_node_ != kNoNode) {
+            EndDrag();
+        }
+        if (active && (io.MouseDelta.x != 0.0f || io.MouseDelta.y != 0.0f)) {
+            if (drag_node_ != kNoNode) {
+                Node& node = nodes_[drag_node_];
+                node.pos.x += io.MouseDelta.x / zoom_;
+                node.pos.y += io.MouseDelta.y / zoom_;
+                drag_moved_ = true;
+            }
+            else {
+                view_origin_.x -= io.MouseDelta.x / zoom_;
+                view_origin_.y -= io.MouseDelta.y / zoom_;
+            }
+        }
+        if (hovered && io.MouseWheel != 0.0f) {
+            float zoom = ImClamp(zoom_ * std::pow(1.2f, io.MouseWheel), kMinZoom, kMaxZoom);
+            // λΪ
+            view_origin_.x = mouse.x - (io.MousePos.x - canvas_pos_.x) / zoom;
+            view_origin_.y = mouse.y - (io.MousePos.y - canvas_pos_.y) / zoom;
+            zoom_ = zoom;
+        }
+        if (hovered && hovered_ == kNoNode && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+            Fit();
+        }
+        if (dirty_) {
+            BuildIndex();
+        }
+    }
+
+    /*
+    * ϶ڼڵ㼰߲άƺͲԣɿؽһ
+    */
+    void BeginDrag(NodeId id) {
+        drag_node_ = id;
+        drag_moved_ = false;
+        drag_edges_.clear();
+        edge_floating_.assign(edges_.size(), 0);
+        for (size_t i = 0; i < edges_.size(); i++) {
+            if (edges_[i].from == id || edges_[i].to == id) {
+                drag_edges_.push_back((uint32_t)i);
+                edge_floating_[i] = 1;
+            }
+        }
+    }
+
+    void EndDrag() {
+        drag_node_ = kNoNode;
+        drag_edges_.clear();
+        std::vector<uint8_t>().swap(edge_floating_);
+        if (drag_moved_) {
+            dirty_ = true;
+        }
+    }
+
+    bool IsFloating(uint32_t edge) {
+        return edge < edge_floating_.size() && edge_floating_[edge] != 0;
+    }
+
+    // ڵ㲻3ظʱkDotCellSizeصĻӺϲÿֻһΣɫȡϲĽڵ
+    void DrawDots(ImDrawList* draw_list) {
+        int columns = (int)std::ceil(canvas_size_.x / kDotCellSize);
+        int rows = (int)std::ceil(canvas_size_.y / kDotCellSize);
+        if (columns <= 0 || rows <= 0) {
+            return;
+        }
+        // ÿλƺֻùĸӣresizeĲͬΪ0
+        dot_colors_.resize((size_t)columns * rows);
+        for (uint32_t id : visible_) {
+            const Node& node = nodes_[id];
+            if (node.color == 0) {
+                continue;
+            }
+            ImVec2 min = ToScreen(node.pos);
+            int x0, x1, y0, y1;
+            DotSpan(min.x - canvas_pos_.x, node.size.x * zoom_, columns, &x0, &x1);
+            DotSpan(min.y - canvas_pos_.y, node.size.y * zoom_, rows, &y0, &y1);
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) {
+                    uint32_t index = (uint32_t)(y * columns + x);
+                    if (dot_colors_[index] == 0) {
+                        dot_cells_.push_back(index);
+                    }
+                    dot_colors_[index] = node.color;
+                }
+            }
+        }
+        for (uint32_t index : dot_cells_) {
+            ImVec2 min(canvas_pos_.x + (float)(index % columns) * kDotCellSize, canvas_pos_.y + (float)(index / columns) * kDotCellSize);
+            draw_list->AddRectFilled(min, ImVec2(min.x + kDotCellSize, min.y + kDotCellSize), dot_colors_[index]);
+            dot_colors_[index] = 0;
+        }
+        dot_cells_.clear();
+    }
+
+    // ȡڽڵڵĸӣһûʱȡڵڵĸӣСڵ㱻ɶ
+    static void DotSpan(float pos, float size, int count, int* first, int* last) {
+        *first = (int)std::ceil(pos / kDotCellSize - 0.5f);
+        *last = (int)std::floor((pos + size) / kDotCellSize - 0.5f);
+        if (*last < *first) {
+            *first = *last = (int)std::floor((pos + size * 0.5f) / kDotCellSize);
+        }
+        *first = ImClamp(*first, 0, count - 1);
+        *last = ImClamp(*last, 0, count - 1);
+    }
+
+    void Draw() {
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        ImVec2 canvas_max(canvas_pos_.x + canvas_size_.x, canvas_pos_.y + canvas_size_.y);
+        draw_list->AddRectFilled(canvas_pos_, canvas_max, ImGui::GetColorU32(ImGuiCol_FrameBg));
+        draw_list->PushClipRect(canvas_pos_, canvas_max, true);
+
+        float font_size = ImGui::GetFontSize();
+        // Եһڵĸ߶ȹĻϵĽڵߴ
+        float node_height = lod_height_ * zoom_;
+        lod_ = node_height >= font_size ? kLodDetail : node_height >= 3.0f ? kLodSimple : kLodDot;
+
+        ImVec2 view_min = view_origin_;
+        ImVec2 view_max = ToWorld(canvas_max);
+        visible_node_count_ = 0;
+        visible_edge_count_ = 0;
+
+        if (lod_ != kLodDot) {
+            ImU32 edge_color = ImGui::GetColorU32(ImGuiCol_PlotLines);
+            auto draw_edge = [&](uint32_t id) {
+                ImVec2 points[4];
+                EdgePoints(edges_[id], points);
+                for (int i = 0; i < 4; i++) {
+                    points[i] = ToScreen(points[i]);
+                }
+                if (lod_ == kLodDetail) {
+                    draw_list->AddBezierCubic(points[0], points[1], points[2], points[3], edge_color, 1.5f);
+                }
+                else {
+                    draw_list->AddLine(points[0], points[3], edge_color, 1.0f);
+                }
+                visible_edge_count_++;
+            };
+            QueryGrid(edge_grid_, view_min, view_max, edge_stamps_, [&](uint32_t id) {
+                if (!IsFloating(id)) {
+                    draw_edge(id);
+                }
+            });
+            for (uint32_t id : long_edges_) {
+                ImVec2 min, max;
+                EdgeBounds(edges_[id], &min, &max);
+                if (!IsFloating(id) && Overlaps(min, max, view_min, view_max)) {
+                    draw_edge(id);
+                }
+            }
+            for (uint32_t id : drag_edges_) {
+                ImVec2 min, max;
+                EdgeBounds(edges_[id], &min, &max);
+                if (Overlaps(min, max, view_min, view_max)) {
+                    draw_edge(id);
+                }
+            }
+        }
+
+        ImU32 border_color = ImGui::GetColorU32(ImGuiCol_Border);
+        ImU32 text_color = ImGui::GetColorU32(ImGuiCol_Text);
+        ImU32 highlight_color = ImGui::GetColorU32(ImGuiCol_CheckMark);
+        ImFont* font = ImGui::GetFont();
+        float rounding = 4.0f * zoom_;
+        auto draw_node = [&](uint32_t id) {
+            const Node& node = nodes_[id];
+            ImVec2 min = ToScreen(node.pos);
+            ImVec2 max(min.x + node.size.x * zoom_, min.y + node.size.y * zoom_);
+            if (lod_ == kLodSimple) {
+                draw_list->AddRectFilled(min, max, node.color);
+            }
+            else {
+                draw_list->AddRectFilled(min, max, node.color, rounding);
+                draw_list->AddRect(min, max, id == hovered_ ? highlight_color : border_color, rounding);
+                const char* label = labels_.data() + node.label_offset;
+                ImVec4 clip(min.x, min.y, max.x, max.y);
+                float text_size = std::min(font_size * zoom_, font_size * 2.0f);
+                draw_list->AddText(font, text_size, ImVec2(min.x + 4.0f * zoom_, min.y + 4.0f * zoom_), text_color, label, label + node.label_length, 0.0f, &clip);
+            }
+            if (id == selected_) {
+                draw_list->AddRect(min, max, highlight_color, lod_ == kLodDetail ? rounding : 0.0f, 0, 2.0f);
+            }
+        };
+        // id˳ƣHitTestһ£ӵĽڵϲ㣬϶Ľڵ
+        visible_.clear();
+        QueryGrid(node_grid_, view_min, view_max, node_stamps_, [&](uint32_t id) {
+            if (id != drag_node_) {
+                visible_.push_back(id);
+            }
+        });
+        std::sort(visible_.begin(), visible_.end());
+        if (drag_node_ != kNoNode) {
+            ImVec2 min, max;
+            NodeBounds(nodes_[drag_node_], &min, &max);
+            if (Overlaps(min, max, view_min, view_max)) {
+                visible_.push_back(drag_node_);
+            }
+        }
+        visible_node_count_ = visible_.size();
+        if (lod_ == kLodDot) {
+            DrawDots(draw_list);
+            if (selected_ != kNoNode && selected_ < nodes_.size()) {
+                ImVec2 min, max;
+                NodeBounds(nodes_[selected_], &min, &max);
+                if (Overlaps(min, max, view_min, view_max)) {
+                    min = ToScreen(min);
+                    max = ImMax(ToScreen(max), ImVec2(min.x + 1.0f, min.y + 1.0f));
+                    draw_list->AddRect(min, max, highlight_color, 0.0f, 0, 2.0f);
+                }
+            }
+        }
+        else {
+            for (uint32_t id : visible_) {
+                draw_node(id);
+            }
+        }
+
+        draw_list->PopClipRect();
+
+        const char* label_end = ImGui::FindRenderedTextEnd(GetLabel().c_str());
+        if (label_end != GetLabel().c_str()) {
+            draw_list->AddText(ImVec2(canvas_pos_.x + 4.0f, canvas_pos_.y + 2.0f), ImGui::GetColorU32(ImGuiCol_Text), GetLabel().c_str(), label_end);
+        }
+    }
+
+private:
+    std::vector<Node> nodes_;
+    std::vector<Edge> edges_;
+    std::string labels_;
+
+    float cell_size_;
+    Grid node_grid_;
+    Grid edge_grid_;
+    std::vector<uint32_t> long_edges_;
+    std::vector<uint32_t> fill_;
+    std::vector<uint32_t> node_stamps_;
+    std::vector<uint32_t> edge_stamps_;
+    uint32_t stamp_;
+    bool dirty_;
+    ImVec2 bounds_min_;
+    ImVec2 bounds_max_;
+
+    ImVec2 size_;
+    ImVec2 canvas_pos_;
+    ImVec2 canvas_size_;
+    ImVec2 view_origin_;
+    float zoom_;
+
+    NodeId end_selected_;
+    NodeId selected_;
+    NodeId hovered_;
+    NodeId drag_node_;
+    bool drag_moved_;
+    std::vector<uint32_t> drag_edges_;
+    std::vector<uint8_t> edge_floating_;
+
+    Lod lod_;
+    float lod_height_;
+    size_t visible_node_count_;
+    size_t visible_edge_count_;
+    std::vector<uint32_t> visible_;
+    std::vector<ImU32> dot_colors_;
+    std::vector<uint32_t> dot_cells_;
+};
+
+/*
+* Ự
+* עؼ״̬ImGuiĴ/ͣñΪ汾ŵĶļ
+* ʱӳļkeyԱֲңؼ״̬״BeginʱŻָ
+*/
+class Session {
+public:
+    Session() {
+        index_ = nullptr;
+        index_count_ = 0;
+        data_ = nullptr;
+        data_size_ = 0;
+    }
+
+    template<class W>
+    void Register(W& widget, const std::string& key = std::string()) {
+        const std::string& name = key.empty() ? widget.GetLabel() : key;
+        Entry entry;
+        entry.key = internal::HashString64(name.c_str(), name.size());
+        entry.widget = &widget;
+        entry.save = [&widget](internal::SnapshotWriter& writer) { widget.SaveState(writer); };
+        entry.load = [&widget](internal::SnapshotReader& reader) { widget.LoadState(reader); };
+        entries_.push_back(std::move(entry));
+        Schedule(entries_.back());
+    }
+
+    void Unregister(Widget& widget) {
+        for (size_t i = 0; i < entries_.size();) {
+            if (entries_[i].widget == &widget) {
+                widget.SetRestore(nullptr);
+                entries_.erase(entries_.begin() + i);
+            }
+            else {
+                i++;
+            }
+        }
+    }
+
+    bool Save(const std::string& path) {
+        internal::SnapshotWriter data;
+        std::vector<IndexEntry> index;
+        index.reserve(entries_.size());
+        for (auto& entry : entries_) {
+            IndexEntry item;
+            item.key = entry.key;
+            item.offset = data.GetBuffer().size();
+            entry.save(data);
+            item.size = (uint32_t)(data.GetBuffer().size() - item.offset);
+            item.reserved = 0;
+            index.push_back(item);
+        }
+        std::stable_sort(index.begin(), index.end(), [](const IndexEntry& a, const IndexEntry& b) {
+            return a.key < b.key;
+        });
+
+        size_t ini_size = 0;
+        const char* ini = ImGui::SaveIniSettingsToMemory(&ini_size);
+
+        Header header;
+        memcpy(header.magic, kMagic, sizeof(header.magic));
+        header.version = kVersion;
+        header.record_count = (uint32_t)index.size();
+        header.ini_offset = sizeof(Header);
+        header.ini_size = ini_size;
+        header.index_offset = header.ini_offset + header.ini_size;
+        header.data_offset = header.index_offset + index.size() * sizeof(IndexEntry);
+        header.data_size = data.GetBuffer().size();
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.write((const char*)&header, sizeof(header));
+        file.write(ini, ini_size);
+        if (!index.empty()) {
+            file.write((const char*)index.data(), index.size() * sizeof(IndexEntry));
+        }
+        file.write(data.GetBuffer().data(), data.GetBuffer().size());
+        return (bool)file;
+    }
+
+    // Ӧڵһ֮֡ǰImGuiInitУãòЧ
+    // һLoadδӦõĻָᱻ
+    bool Load(const std::string& path) {
+        for (auto& entry : entries_) {
+            entry.widget->SetRestore(nullptr);
+        }
+        index_ = nullptr;
+        index_count_ = 0;
+        data_ = nullptr;
+        data_size_ = 0;
+        file_.reset();
+
+        auto file = std::make_shared<internal::MappedFile>();
+        if (!file->Open(path)) {
+            return false;
+        }
+
+        Header header;
+        uint64_t size = file->GetSize();
+        if (size < sizeof(Header)) {
+            return false;
+        }
+        memcpy(&header, file->GetData(), sizeof(header));
+        if (memcmp(header.magic, kMagic, sizeof(header.magic)) != 0 || header.version != kVersion ||
+            !InRange(header.ini_offset, header.ini_size, size) ||
+            !InRange(header.index_offset, (uint64_t)header.record_count * sizeof(IndexEntry), size) ||
+            !InRange(header.data_offset, header.data_size, size)) {
+            return false;
+        }
+
+        if (header.ini_size > 0) {
+            ImGui::LoadIniSettingsFromMemory(file->GetData() + header.ini_offset, (size_t)header.ini_size);
+        }
+        file_ = file;
+        index_ = file_->GetData() + header.index_offset;
+        index_count_ = header.record_count;
+        data_ = file_->GetData() + header.data_offset;
+        data_size_ = header.data_size;
+
+        for (auto& entry : entries_) {
+            Schedule(entry);
+        }
+        return true;
+    }
+
+    size_t GetRegisterCount() {
+        return entries_.size();
+    }
+
+    size_t GetRecordCount() {
+        return index_count_;
+    }
+
+private:
+    static constexpr char kMagic[8] = { 'I', 'M', 'G', 'U', 'I', 'E', 'X', 'S' };
+    static constexpr uint32_t kVersion = 1;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t record_count;
+        uint64_t ini_offset;
+        uint64_t ini_size;
+        uint64_t index_offset;
+        uint64_t data_offset;
+        uint64_t data_size;
+    };
+
+    struct IndexEntry {
+        uint64_t key;
+        uint64_t offset;
+        uint32_t size;
+        uint32_t reserved;
+    };
+
+    struct Entry {
+        uint64_t key;
+        Widget* widget;
+        std::function<void(internal::SnapshotWriter&)> save;
+        std::function<void(internal::SnapshotReader&)> load;
+    };
+
+    bool Find(uint64_t key, IndexEntry& found) {
+        size_t lo = 0;
+        size_t hi = index_count_;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            IndexEntry item;
+            memcpy(&item, index_ + mid * sizeof(IndexEntry), sizeof(item));
+            if (item.key < key) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        if (lo == index_count_) {
+            return false;
+        }
+        memcpy(&found, index_ + lo * sizeof(IndexEntry), sizeof(found));
+        return found.key == key && InRange(found.offset, found.size, data_size_);
+    }
+
+    // ֱȽϳʣռ䣬offset + lengthʱҲܾܾ
+    static bool InRange(uint64_t offset, uint64_t length, uint64_t size) {
+        return offset <= size && length <= size - offset;
+    }
+
+    void Schedule(Entry& entry) {
+        IndexEntry found;
+        if (index_ == nullptr || !Find(entry.key, found)) {
+            return;
+        }
+        // հӳãSessionδִеĻָԿɶȡ
+        std::shared_ptr<internal::MappedFile> file = file_;
+        const char* data = data_ + found.offset;
+        size_t size = found.size;
+        auto load = entry.load;
+        entry.widget->SetRestore([file, load, data, size]() {
+            internal::SnapshotReader reader(data, size);
+            load(reader);
+        });
+    }
+
+private:
+    std::vector<Entry> entries_;
+
+    std::shared_ptr<internal::MappedFile> file_;
+    const char* index_;
+    size_t index_count_;
+    const char* data_;
+    uint64_t data_size_;
+};
+
+
+namespace internal {
+inline std::atomic<size_t>& TypeCounter() {
+    static std::atomic<size_t> counter(0);
+    return counter;
+}
+
+template<class T>
+inline size_t TypeIndex() {
+    static const size_t index = TypeCounter()++;
+    return index;
+}
+} // namespace internal
+
+/*
+* ؼ
+* keyÿؼÿֿؼ͵һslab󰴿ҵַ
+* keyΪѰַReserve֮Ԥֵʱرٷڴ(ؼʱķ)
+* evict_frames֡δGetĿؼᱻٴGetʱ¹죬InitEvent´
+* õĿؼϴEndʱ״̬ڼ䲻¼ڼControl´ʾʱ
+* ͬ͵keyͻlabelɵ÷֤ImGuiΨһ("ɾ##123")
+*/
+class WidgetPool {
+public:
+    WidgetPool() {
+        frame_ = 0;
+        evict_frames_ = 60;
+        create_count_ = 0;
+        evict_count_ = 0;
+    }
+
+    ~WidgetPool() {
+        Clear();
+    }
+
+    WidgetPool(const WidgetPool&) = delete;
+    void operator=(const WidgetPool&) = delete;
+
+    // argsֻڿؼ״δʱʹ
+    template<class W, class... Args>
+    W& Get(uint64_t key, Args&&... args) {
+        Slab<W>& slab = GetSlab<W>();
+        bool created;
+        W& widget = slab.Get(key, frame_, created, std::forward<Args>(args)...);
+        if (created) {
+            create_count_++;
+        }
+        return widget;
+    }
+
+    template<class W, class... Args>
+    W& Get(const std::string& key, Args&&... args) {
+        return Get<W>(internal::HashString64(key.c_str(), key.size()), std::forward<Args>(args)...);
+    }
+
+    template<class W>
+    W* Find(uint64_t key) {
+        size_t index = internal::TypeIndex<W>();
+        if (index >= slabs_.size() || !slabs_[index]) {
+            return nullptr;
+        }
+        return static_cast<Slab<W>*>(slabs_[index].get())->Find(key);
+    }
+
+    template<class W>
+    void Reserve(size_t count) {
+        GetSlab<W>().Reserve(count);
+    }
+
+    // ÿ֡һΣڵĿؼ
+    void Update() {
+        frame_++;
+        for (auto& slab : slabs_) {
+            if (slab) {
+                evict_count_ += slab->Evict(frame_, evict_frames_);
+            }
+        }
+    }
+
+    void Clear() {
+        for (auto& slab : slabs_) {
+            if (slab) {
+                slab->Clear();
+            }
+        }
+    }
+
+    void SetEvictFrames(uint64_t frames) {
+        evict_frames_ = frames;
+    }
+
+    size_t GetCount() {
+        size_t count = 0;
+        for (auto& slab : slabs_) {
+            if (slab) {
+                count += slab->GetCount();
+            }
+        }
+        return count;
+    }
+
+    size_t GetCreateCount() {
+        return create_count_;
+    }
+
+    size_t GetEvictCount() {
+        return evict_count_;
+    }
+
+private:
+    class SlabBase {
+    public:
+        virtual ~SlabBase() {}
+        virtual size_t Evict(uint64_t frame, uint64_t evict_frames) = 0;
+        virtual void Clear() = 0;
+        virtual size_t GetCount() = 0;
+    };
+
+    template<class W>
+    class Slab : public SlabBase {
+    public:
+        Slab() {
+            count_ = 0;
+            tombstone_count_ = 0;
+        }
+
+        ~Slab() override {
+            Clear();
+        }
+
+        template<class... Args>
+        W& Get(uint64_t key, uint64_t frame, bool& created, Args&&... args) {
+            size_t pos = Lookup(key);
+            if (pos != kNotFound) {
+                uint32_t index = table_[pos] - 1;
+                slots_[index].frame = frame;
+                created = false;
+                return *At(index);
+            }
+            uint32_t index;
+            if (!free_.empty()) {
+                index = free_.back();
+                free_.pop_back();
+            }
+            else {
+                index = (uint32_t)slots_.size();
+                if (index / kChunkSize >= chunks_.size()) {
+                    chunks_.emplace_back(new Chunk);
+                }
+                slots_.push_back(Slot{});
+            }
+            W* widget = new (At(index)) W(std::forward<Args>(args)...);
+            Insert(key, index);
+            Slot& slot = slots_[index];
+            slot.key = key;
+            slot.frame = frame;
+            slot.live = true;
+            count_++;
+            created = true;
+            return *widget;
+        }
+
+        W* Find(uint64_t key) {
+            size_t pos = Lookup(key);
+            if (pos == kNotFound) {
+                return nullptr;
+            }
+            return At(table_[pos] - 1);
+        }
+
+        void Reserve(size_t count) {
+            if (count < count_) {
+                count = count_;
+            }
+            if ((count + tombstone_count_) * 4 >= table_.size() * 3) {
+                Rehash(count);
+            }
+            slots_.reserve(count);
+            free_.reserve(count);
+            while (chunks_.size() * kChunkSize < count) {
+                chunks_.emplace_back(new Chunk);
+            }
+        }
+
+        size_t Evict(uint64_t frame, uint64_t evict_frames) override {
+            size_t evicted = 0;
+            for (uint32_t i = 0; i < slots_.size(); i++) {
+                Slot& slot = slots_[i];
+                if (slot.live && frame - slot.frame > evict_frames) {
+                    Destroy(i);
+                    evicted++;
+                }
+            }
+            return evicted;
+        }
+
+        void Clear() override {
+            for (uint32_t i = 0; i < slots_.size(); i++) {
+                if (slots_[i].live) {
+                    Destroy(i);
+                }
+            }
+        }
+
+        size_t GetCount() override {
+            return count_;
+        }
+
+    private:
+        static const uint32_t kChunkSize = 64;
+        // table_0ʾλkTombstoneʾɾΪslots_±+1
+        static const uint32_t kTombstone = 0xFFFFFFFF;
+        static const size_t kNotFound = (size_t)-1;
+
+        struct Chunk {
+            alignas(W) unsigned char data[sizeof(W) * kChunkSize];
+        };
+
+        struct Slot {
+            uint64_t key;
+            uint64_t frame;
+            bool live;
+        };
+
+        W* At(uint32_t index) {
+            return reinterpret_cast<W*>(chunks_[index / kChunkSize]->data + sizeof(W) * (index % kChunkSize));
+        }
+
+        void Destroy(uint32_t index) {
+            Slot& slot = slots_[index];
+            At(index)->~W();
+            table_[Lookup(slot.key)] = kTombstone;
+            tombstone_count_++;
+            slot.live = false;
+            free_.push_back(index);
+            count_--;
+        }
+
+        size_t Lookup(uint64_t key) {
+            if (table_.empty()) {
+                return kNotFound;
+            }
+            size_t mask = table_.size() - 1;
+            for (size_t pos = internal::MixKey(key) & mask;; pos = (pos + 1) & mask) {
+                uint32_t entry = table_[pos];
+                if (entry == 0) {
+                    return kNotFound;
+                }
+                if (entry != kTombstone && slots_[entry - 1].key == key) {
+                    return pos;
+                }
+            }
+        }
+
+        // ռ(Ĺ)3/4֤λ
+        void Insert(uint64_t key, uint32_t index) {
+            if ((count_ + tombstone_count_ + 1) * 4 >= table_.size() * 3) {
+                Rehash(count_ + 1);
+            }
+            size_t mask = table_.size() - 1;
+            size_t pos = internal::MixKey(key) & mask;
+            while (table_[pos] != 0 && table_[pos] != kTombstone) {
+                pos = (pos + 1) & mask;
+            }
+            if (table_[pos] == kTombstone) {
+                tombstone_count_--;
+            }
+            table_[pos] = index + 1;
+        }
+
+        // 㹻ʱԭؽĹ·
+        void Rehash(size_t count) {
+            size_t size = table_.size() < 16 ? 16 : table_.size();
+            while ((count + 1) * 4 >= size * 3) {
+                size <<= 1;
+            }
+            table_.assign(size, 0);
+            tombstone_count_ = 0;
+            size_t mask = size - 1;
+            for (uint32_t i = 0; i < slots_.size(); i++) {
+                if (!slots_[i].live) {
+                    continue;
+                }
+                size_t pos = internal::MixKey(slots_[i].key) & mask;
+                while (table_[pos] != 0) {
+                    pos = (pos + 1) & mask;
+                }
+                table_[pos] = i + 1;
+            }
+        }
+
+    private:
+        std::vector<std::unique_ptr<Chunk>> chunks_;
+        std::vector<Slot> slots_;
+        std::vector<uint32_t> free_;
+        std::vector<uint32_t> table_;
+        size_t count_;
+        size_t tombstone_count_;
+    };
+
+    template<class W>
+    Slab<W>& GetSlab() {
+        size_t index = internal::TypeIndex<W>();
+        if (index >= slabs_.size()) {
+            slabs_.resize(index + 1);
+        }
+        if (!slabs_[index]) {
+            slabs_[index].reset(new Slab<W>);
+        }
+        return *static_cast<Slab<W>*>(slabs_[index].get());
+    }
+
+private:
+    std::vector<std::unique_ptr<SlabBase>> slabs_;
+    uint64_t frame_;
+    uint64_t evict_frames_;
+
+    size_t create_count_;
+    size_t evict_count_;
+};
+
+
+#ifdef IMGUI_EX_COROUTINE
+/*
+* Э̶
+* StartActionڼԶÿؼЭ̽(ȡ)ʱ
+* co_await Async(fn)ںִ̨̳߳fnɺЭ̵UI̵߳һ֡ʼʱָ
+* ȡǱ(Windowر)Э̲ٻֱָ٣ֲճ
+* ЭֻпؼãؼЭʱ
+* Эδ쳣SetActionErrorHandlerõĻصЭ漴
+* UI߳˳ǰҪȴ̨
+*/
+namespace internal {
+inline std::function<void(std::exception_ptr)>& ActionErrorHandler() {
+    static thread_local std::function<void(std::exception_ptr)> handler;
+    return handler;
+}
+} // namespace internal
+
+// Եǰ߳Э̶Ч
+static void SetActionErrorHandler(std::function<void(std::exception_ptr)> handler) {
+    internal::ActionErrorHandler() = std::move(handler);
+}
+
+class Action {
+public:
+    struct promise_type;
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    struct promise_type {
+        promise_type();
+        ~promise_type() {
+            if (widget && *widget) {
+                (*widget)->Enable();
+            }
+        }
+
+        Action get_return_object() {
+            return Action();
+        }
+
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() {
+        }
+
+        // ׳жResumeQueue::DrainʣЭ̼ȲָҲ
+        void unhandled_exception() {
+            std::function<void(std::exception_ptr)>& handler = internal::ActionErrorHandler();
+            if (handler) {
+                handler(std::current_exception());
+            }
+        }
+
+        std::shared_ptr<Widget*> widget;
+        CancelToken token;
+        std::shared_ptr<void> keeper;
+    };
+};
+
+namespace internal {
+struct ActionContext {
+    std::shared_ptr<Widget*> widget;
+    CancelToken token;
+    std::shared_ptr<void> keeper;
+};
+
+inline ActionContext*& CurrentActionContext() {
+    static thread_local ActionContext* context = nullptr;
+    return context;
+}
+
+// UI̵߳ĻָУ߳ͶݣUI߳֡ʼʱȡնֻһԭӶȡ
+class ResumeQueue {
+public:
+    ResumeQueue() {
+        pending_ = false;
+        wake_window_ = GetCommandQueue().GetWakeWindow();
+    }
+
+    void Post(Action::Handle handle) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            handles_.push_back(handle);
+        }
+        pending_.store(true, std::memory_order_release);
+        PostWake(wake_window_.load(std::memory_order_acquire));
+    }
+
+    void Drain() {
+        // ѭڶд֮ûѴ
+        wake_window_.store(GetCommandQueue().GetWakeWindow(), std::memory_order_release);
+        if (!pending_.load(std::memory_order_acquire)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            draining_.swap(handles_);
+            pending_.store(false, std::memory_order_relaxed);
+        }
+        for (auto handle : draining_) {
+            if (handle.promise().token.IsCancelled()) {
+                handle.destroy();
+            }
+            else {
+                handle.resume();
+            }
+        }
+        draining_.clear();
+    }
+
+private:
+    std::atomic<bool> pending_;
+    std::atomic<HWND> wake_window_;
+    std::mutex mutex_;
+    std::vector<Action::Handle> handles_;
+    std::vector<Action::Handle> draining_;
+};
+
+inline ResumeQueue& CurrentResumeQueue() {
+    static thread_local ResumeQueue queue;
+    return queue;
+}
+
+// ѭNewFrame֮
+static void DrainResumeQueue() {
+    CurrentResumeQueue().Drain();
+}
+} // namespace internal
+
+inline Action::promise_type::promise_type() {
+    internal::ActionContext* context = internal::CurrentActionContext();
+    if (context) {
+        widget = std::move(context->widget);
+        token = context->token;
+        keeper = std::move(context->keeper);
+        internal::CurrentActionContext() = nullptr;
+    }
+}
+
+template<class Fn>
+class AsyncAwaiter {
+public:
+    typedef decltype(std::declval<Fn&>()()) Result;
+
+    AsyncAwaiter(Fn fn) : fn_(std::move(fn)) {
+    }
+
+    bool await_ready() {
+        return false;
+    }
+
+    void await_suspend(Action::Handle handle) {
+        internal::ResumeQueue* queue = &internal::CurrentResumeQueue();
+        internal::GetWorkerPool().Post([this, handle, queue]() {
+            try {
+                if constexpr (std::is_void<Result>::value) {
+                    fn_();
+                }
+                else {
+                    result_.emplace(fn_());
+                }
+            }
+            catch (...) {
+                exception_ = std::current_exception();
+            }
+            queue->Post(handle);
+        });
+    }
+
+    Result await_resume() {
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+        if constexpr (!std::is_void<Result>::value) {
+            return std::move(*result_);
+        }
+    }
+
+private:
+    Fn fn_;
+    std::optional<typename std::conditional<std::is_void<Result>::value, char, Result>::type> result_;
+    std::exception_ptr exception_;
+};
+
+template<class Fn>
+static AsyncAwaiter<typename std::decay<Fn>::type> Async(Fn&& fn) {
+    return AsyncAwaiter<typename std::decay<Fn>::type>(std::forward<Fn>(fn));
+}
+
+// factoryǷActionЭ(ͨlambda)Э̽ǰһֱ
+template<class Factory>
+static void StartAction(Widget& widget, const CancelToken& token, Factory&& factory) {
+    if (token.IsCancelled()) {
+        return;
+    }
+    auto keeper = std::make_shared<typename std::decay<Factory>::type>(std::forward<Factory>(factory));
+    internal::ActionContext context{ widget.GetRef(), token, keeper };
+    widget.Disable();
+    internal::CurrentActionContext() = &context;
+    (*keeper)();
+    internal::CurrentActionContext() = nullptr;
+}
+#endif // IMGUI_EX_COROUTINE
+
+
+/*
+* ӿڣD3D11ʵּGetTextureRendererCpuTextureRendererGPU
+*/
+class TextureRenderer {
+public:
+    virtual ~TextureRenderer() {}
+
+    virtual ImTextureID CreateTexture(const unsigned char* rgba, int width, int height) = 0;
+    virtual void DestroyTexture(ImTextureID texture) = 0;
+};
+
+TextureRenderer* GetTextureRenderer();
+
+class CpuTextureRenderer : public TextureRenderer {
+public:
+    CpuTextureRenderer() {
+        next_id_ = 1;
+        create_count_ = 0;
+        destroy_count_ = 0;
+        resident_bytes_ = 0;
+    }
+
+    ImTextureID CreateTexture(const unsigned char* rgba, int width, int height) override {
+        size_t size = (size_t)width * height * 4;
+        ImTextureID id = (ImTextureID)(intptr_t)next_id_++;
+        textures_[id].assign(rgba, rgba + size);
+        create_count_++;
+        resident_bytes_ += size;
+        return id;
+    }
+
+    void DestroyTexture(ImTextureID texture) override {
+        auto iter = textures_.find(texture);
+        if (iter == textures_.end()) {
+            return;
+        }
+        resident_bytes_ -= iter->second.size();
+        textures_.erase(iter);
+        destroy_count_++;
+    }
+
+    const std::vector<unsigned char>* GetPixels(ImTextureID texture) {
+        auto iter = textures_.find(texture);
+        return iter == textures_.end() ? nullptr : &iter->second;
+    }
+
+    size_t GetCreateCount() {
+        return create_count_;
+    }
+
+    size_t GetDestroyCount() {
+        return destroy_count_;
+    }
+
+    size_t GetResidentBytes() {
+        return resident_bytes_;
+    }
+
+private:
+    std::unordered_map<ImTextureID, std::vector<unsigned char>> textures_;
+    intptr_t next_id_;
+    size_t create_count_;
+    size_t destroy_count_;
+    size_t resident_bytes_;
+};
+
+/*
+* 
+* ڹ߳нУUpdateÿ֡ԤϴѽͼƬԴʱLRṶ
+* UpdateҪUI߳ÿ֡һ
+*/
+class TextureManager {
+public:
+    typedef std::function<bool(const std::string& key, std::vector<unsigned char>& rgba, int& width, int& height)> Decoder;
+
+    enum class State {
+        kQueued,
+        kDecoding,
+        kDecoded,
+        kReady,
+        kFailed,
+        kEvicted,
+    };
+
+    struct Texture {
+        std::string key;
+        std::atomic<State> state;
+        ImTextureID id;
+        int width;
+        int height;
+        size_t bytes;
+        uint64_t last_use_frame;
+        std::vector<unsigned char> pixels;
+        std::list<Texture*>::iterator lru;
+    };
+
+    TextureManager(TextureRenderer* renderer, Decoder decoder, size_t thread_count = 2) : renderer_(renderer), decoder_(decoder) {
+        upload_budget_ = 4 * 1024 * 1024;
+        memory_limit_ = 256 * 1024 * 1024;
+        frame_ = 0;
+        resident_bytes_ = 0;
+        upload_bytes_ = 0;
+        upload_count_ = 0;
+        evict_count_ = 0;
+        stop_ = false;
+        wake_window_ = nullptr;
+        for (size_t i = 0; i < thread_count; i++) {
+            workers_.emplace_back([this]() { WorkerLoop(); });
+        }
+    }
+
+    ~TextureManager() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cond_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+        for (auto& item : textures_) {
+            if (item.second.state == State::kReady) {
+                renderer_->DestroyTexture(item.second.id);
+            }
+        }
+    }
+
+    TextureManager(const TextureManager&) = delete;
+    TextureManager& operator=(const TextureManager&) = delete;
+
+    // δʱnullptrҪʱŶӽ
+    Texture* Request(const std::string& key) {
+        auto iter = textures_.find(key);
+        Texture* texture;
+        if (iter == textures_.end()) {
+            texture = &textures_[key];
+            texture->key = key;
+            texture->state = State::kEvicted;
+            texture->id = nullptr;
+            texture->width = 0;
+            texture->height = 0;
+            texture->bytes = 0;
+            texture->last_use_frame = 0;
+            texture->lru = lru_.end();
+        }
+        else {
+            texture = &iter->second;
+        }
+        texture->last_use_frame = frame_;
+        if (texture->state == State::kReady) {
+            lru_.splice(lru_.begin(), lru_, texture->lru);
+            return texture;
+        }
+        if (texture->state == State::kEvicted) {
+            texture->state = State::kQueued;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                jobs_.push_back(texture);
+                wake_window_ = GetCommandQueue().GetWakeWindow();
+            }
+            cond_.notify_one();
+        }
+        return nullptr;
+    }
+
+    void Update() {
+        frame_++;
+        upload_bytes_ = 0;
+        upload_count_ = 0;
+
+        for (;;) {
+            Texture* texture = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (decoded_.empty()) {
+                    break;
+                }
+                texture = decoded_.front();
+                if (upload_bytes_ > 0 && upload_bytes_ + texture->pixels.size() > upload_budget_) {
+                    break;
+                }
+                decoded_.pop_front();
+            }
+            Upload(texture);
+        }
+
+        Evict();
+    }
+
+    void SetUploadBudget(size_t bytes) {
+        upload_budget_ = bytes;
+    }
+
+    void SetMemoryLimit(size_t bytes) {
+        memory_limit_ = bytes;
+    }
+
+    size_t GetResidentBytes() {
+        return resident_bytes_;
+    }
+
+    // һUpdateϴֽԤֻᷢڵͼƬԤʱ
+    size_t GetUploadBytes() {
+        return upload_bytes_;
+    }
+
+    size_t GetUploadCount() {
+        return upload_count_;
+    }
+
+    size_t GetEvictCount() {
+        return evict_count_;
+    }
+
+    size_t GetPendingCount() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return jobs_.size() + decoded_.size();
+    }
+
+private:
+    void WorkerLoop() {
+        for (;;) {
+            Texture* texture;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+                if (stop_) {
+                    return;
+                }
+                texture = jobs_.front();
+                jobs_.pop_front();
+                texture->state = State::kDecoding;
+            }
+            std::vector<unsigned char> pixels;
+            int width = 0;
+            int height = 0;
+            bool ok = decoder_(texture->key, pixels, width, height) && width > 0 && height > 0 &&
+                      pixels.size() >= (size_t)width * height * 4;
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (ok) {
+                texture->pixels = std::move(pixels);
+                texture->width = width;
+                texture->height = height;
+                texture->state = State::kDecoded;
+                decoded_.push_back(texture);
+            }
+            else {
+                texture->state = State::kFailed;
+            }
+            internal::PostWake(wake_window_);
+        }
+    }
+
+    void Upload(Texture* texture) {
+        texture->id = renderer_->CreateTexture(texture->pixels.data(), texture->width, texture->height);
+        std::vector<unsigned char>().swap(texture->pixels);
+        if (texture->id == nullptr) {
+            texture->state = State::kFailed;
+            return;
+        }
+        texture->bytes = (size_t)texture->width * texture->height * 4;
+        texture->state = State::kReady;
+        lru_.push_front(texture);
+        texture->lru = lru_.begin();
+        resident_bytes_ += texture->bytes;
+        upload_bytes_ += texture->bytes;
+        upload_count_++;
+    }
+
+    // ̭֡ʹõ
+    void Evict() {
+        while (resident_bytes_ > memory_limit_ && !lru_.empty()) {
+            Texture* texture = lru_.back();
+            if (texture->last_use_frame + 1 >= frame_) {
+                break;
+            }
+            lru_.pop_back();
+            texture->lru = lru_.end();
+            renderer_->DestroyTexture(texture->id);
+            texture->id = nullptr;
+            resident_bytes_ -= texture->bytes;
+            texture->bytes = 0;
+            texture->state = State::kEvicted;
+            evict_count_++;
+        }
+    }
+
+private:
+    TextureRenderer* renderer_;
+    Decoder decoder_;
+
+    std::unordered_map<std::string, Texture> textures_;
+    std::list<Texture*> lru_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<Texture*> jobs_;
+    std::deque<Texture*> decoded_;
+    std::vector<std::thread> workers_;
+    bool stop_;
+    // һͶݽUI̵߳ĻѴ
+    HWND wake_window_;
+
+    size_t upload_budget_;
+    size_t memory_limit_;
+    uint64_t frame_;
+    size_t resident_bytes_;
+    size_t upload_bytes_;
+    size_t upload_count_;
+    size_t evict_count_;
+};
+
+class Image : public Widget {
+public:
+    Image(const std::string& label, TextureManager& manager, const std::string& key, const ImVec2& size = ImVec2(0, 0)) : Widget(label), manager_(manager), key_(key), size_(size) {
+        end_ready_ = false;
+        ready_ = false;
+    }
+
+    void Begin() {
+        Widget::Begin();
+        TextureManager::Texture* texture = manager_.Request(key_);
+        ready_ = texture != nullptr;
+        if (ready_) {
+            ImVec2 size = size_;
+            if (size.x <= 0.0f) size.x = (float)texture->width;
+            if (size.y <= 0.0f) size.y = (float)texture->height;
+            ImGui::Image(texture->id, size);
+            return;
+        }
+
+        // ռλ
+        ImVec2 size(size_.x > 0.0f ? size_.x : 64.0f, size_.y > 0.0f ? size_.y : 64.0f);
+        ImVec2 pos = ImGui::GetCursorScreenPos();
+        ImGui::Dummy(size);
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        ImVec2 max(pos.x + size.x, pos.y + size.y);
+        draw_list->AddRectFilled(pos, max, ImGui::GetColorU32(ImGuiCol_FrameBg));
+        float t = (float)ImGui::GetTime();
+        float radius = (size.x < size.y ? size.x : size.y) * 0.2f;
+        ImVec2 center(pos.x + size.x * 0.5f + std::cos(t * 4.0f) * radius, pos.y + size.y * 0.5f + std::sin(t * 4.0f) * radius);
+        draw_list->AddCircleFilled(center, radius * 0.3f, ImGui::GetColorU32(ImGuiCol_TextDisabled));
+        // ռλImGui::GetTimeеȴʱҪˢ
+        RequestRedraw();
+    }
+
+    void End() {
+        end_ready_ = ready_;
+        Widget::End();
+    }
+
+    /*
+    * Event
+    */
+    void LoadEvent(std::function<void()> event) {
+        if (ready_ == true && ready_ != end_ready_) {
+            event();
+        }
+    }
+
+    /*
+    * Control
+    */
+    void SetKey(const std::string& key) {
+        BumpControlVersion();
+        key_ = key;
+    }
+
+    const std::string& GetKey() {
+        return key_;
+    }
+
+    void SetSize(const ImVec2& size) {
+        BumpControlVersion();
+        size_ = size;
+    }
+
+    ImVec2& GetSize() {
+        return size_;
+    }
+
+    bool IsReady() {
+        return ready_;
+    }
+
+private:
+    TextureManager& manager_;
+    std::string key_;
+    ImVec2 size_;
+
+    bool end_ready_;
+    bool ready_;
+};
+
+
+namespace internal {
+// ǰHostHeadlessContextжǷ߳ʹImGuiȫַ亯
+inline std::atomic<int>& ContextCount() {
+    static std::atomic<int> count(0);
+    return count;
+}
+} // namespace internal
+
+/*
+* ޴ڡȾ˵ImGuiContextƽ̨ؼȡImDrawData
+* ̹߳ͬһͼʱͼҪȹ
+*/
+class HeadlessContext {
+public:
+    HeadlessContext(ImFontAtlas* atlas = nullptr, const ImVec2& display_size = ImVec2(1280.0f, 800.0f)) {
+        ImGuiContext* last = ImGui::GetCurrentContext();
+        context_ = ImGui::CreateContext(atlas);
+        internal::ContextCount()++;
+        ImGui::SetCurrentContext(context_);
+        ImGuiIO& io = ImGui::GetIO();
+        io.IniFilename = nullptr;
+        io.DisplaySize = display_size;
+        io.DeltaTime = 1.0f / 60.0f;
+        if (!io.Fonts->IsBuilt()) {
+            unsigned char* pixels;
+            int width, height;
+            io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+        }
+        if (io.Fonts->TexID == (ImTextureID)0) {
+            io.Fonts->SetTexID((ImTextureID)(intptr_t)1);
+        }
+        if (last != nullptr) {
+            ImGui::SetCurrentContext(last);
+        }
+    }
+
+    ~HeadlessContext() {
+        ImGui::DestroyContext(context_);
+        internal::ContextCount()--;
+    }
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    ImDrawData* Frame(const std::function<void()>& update, float delta_time = 1.0f / 60.0f) {
+        ImGui::SetCurrentContext(context_);
+        ImGui::GetIO().DeltaTime = delta_time;
+        ImGui::NewFrame();
+        GetCommandQueue().Drain();
+#ifdef IMGUI_EX_COROUTINE
+        internal::DrainResumeQueue();
+#endif
+        update();
+        ReleaseExpiredContents();
+        ImGui::Render();
+        return ImGui::GetDrawData();
+    }
+
+    ImGuiContext* GetContext() {
+        return context_;
+    }
+
+private:
+    ImGuiContext* context_;
+};
+
+/*
+* context_count߳иһHeadlessContextͬһͼ
+* updateĲΪcontextţcontextĿؼ״̬Ӧcontextϼÿ֡
+*/
+static double BenchmarkContexts(int context_count, int frame_count, const std::function<void(int)>& update) {
+    ImFontAtlas atlas;
+    atlas.AddFontDefault();
+    unsigned char* pixels;
+    int width, height;
+    atlas.GetTexDataAsRGBA32(&pixels, &width, &height);
+    atlas.SetTexID((ImTextureID)(intptr_t)1);
+
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < context_count; i++) {
+        threads.emplace_back([&atlas, &update, frame_count, i]() {
+            HeadlessContext context(&atlas);
+            for (int frame = 0; frame < frame_count; frame++) {
+                context.Frame([&update, i]() { update(i); });
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds > 0.0 ? (double)context_count * frame_count / seconds : 0.0;
+}
+
+struct ContextScaling {
+    int context_count;
+    double frames_per_second;
+    // Եcontextĺϼ֡ʱµcontext_count
+    double speedup;
+};
+
+// 1..max_context_countcontextBenchmarkContextsڹ۲չ
+static std::vector<ContextScaling> BenchmarkContextScaling(int frame_count, const std::function<void(int)>& update, int max_context_count = 16) {
+    std::vector<ContextScaling> result;
+    for (int count = 1; count <= max_context_count; count++) {
+        ContextScaling scaling;
+        scaling.context_count = count;
+        scaling.frames_per_second = BenchmarkContexts(count, frame_count, update);
+        scaling.speedup = result.empty() || result[0].frames_per_second <= 0.0 ? 1.0 : scaling.frames_per_second / result[0].frames_per_second;
+        result.push_back(scaling);
+    }
+    return result;
+}
+
+// ̶ĲοأÿcontextһıťͻĴڣ1..max_context_countcontextУڲ֮ͬȽ
+static std::vector<ContextScaling> BenchmarkReferenceScaling(int frame_count = 600, int max_context_count = 16) {
+    return BenchmarkContextScaling(frame_count, [](int index) {
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f), ImGuiCond_Always);
+        ImGui::SetNextWindowSize(ImVec2(1280.0f, 800.0f), ImGuiCond_Always);
+        ImGui::Begin("Reference");
+        static thread_local float value = 0.0f;
+        ImGui::SliderFloat("value", &value, 0.0f, 1.0f);
+        for (int row = 0; row < 200; row++) {
+            ImGui::Text("context %d row %d", index, row);
+            if (row % 20 == 0) {
+                ImGui::PushID(row);
+                ImGui::Button("button");
+                ImGui::PopID();
+            }
+        }
+        ImGui::End();
+    }, max_context_count);
+}
+
+struct TextMetricsBenchmark {
+    // ֻͳƲĺʱ
+    double calc_seconds;
+    double cached_seconds;
+    float hit_rate;
+};
+
+// HeadlessContextÿ֡row_countǩframe_countֱ֡ʹCalcTextSizeTextMetricsCache
+static TextMetricsBenchmark BenchmarkTextMetrics(int row_count, int frame_count) {
+    ImFontAtlas atlas;
+    atlas.AddFontDefault();
+    unsigned char* pixels;
+    int width, height;
+    atlas.GetTexDataAsRGBA32(&pixels, &width, &height);
+    atlas.SetTexID((ImTextureID)(intptr_t)1);
+
+    std::vector<std::string> labels(row_count);
+    for (int i = 0; i < row_count; i++) {
+        labels[i] = "Item " + std::to_string(i) + " of the benchmark list";
+    }
+    HeadlessContext context(&atlas);
+    TextMetricsCache cache((size_t)row_count * 2);
+    auto run = [&](bool cached) {
+        std::chrono::steady_clock::duration total{};
+        for (int frame = 0; frame < frame_count; frame++) {
+            context.Frame([&]() {
+                auto start = std::chrono::steady_clock::now();
+                for (auto& label : labels) {
+                    const char* end = label.c_str() + label.size();
+                    if (cached) {
+                        cache.Measure(label.c_str(), end);
+                    }
+                    else {
+                        ImGui::CalcTextSize(label.c_str(), end);
+                    }
+                }
+                total += std::chrono::steady_clock::now() - start;
+            });
+        }
+        return std::chrono::duration<double>(total).count();
+    };
+
+    TextMetricsBenchmark result;
+    result.calc_seconds = run(false);
+    result.cached_seconds = run(true);
+    result.hit_rate = cache.GetHitRate();
+    return result;
+}
+
+struct CommandQueueBenchmark {
+    // ߳Ͷɵܺʱ
+    double post_ms;
+    // һ֡Drainȫĺʱ
+    double drain_ms;
+    size_t drain_count;
+};
+
+// producer_count̹߳Ͷcommand_countCheckBox::SetCheckHeadlessContextһ֡ȫDrain
+static CommandQueueBenchmark BenchmarkCommandQueue(int command_count = 10000, int producer_count = 4) {
+    ImFontAtlas atlas;
+    atlas.AddFontDefault();
+    unsigned char* pixels;
+    int width, height;
+    atlas.GetTexDataAsRGBA32(&pixels, &width, &height);
+    atlas.SetTexID((ImTextureID)(intptr_t)1);
+
+    HeadlessContext context(&atlas);
+    CommandQueue queue;
+    std::vector<std::unique_ptr<CheckBox>> check_boxes;
+    for (int i = 0; i < 100; i++) {
+        check_boxes.push_back(std::make_unique<CheckBox>("CheckBox " + std::to_string(i)));
+    }
+
+    CommandQueueBenchmark result;
+    producer_count = std::max(1, producer_count);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> producers;
+    for (int p = 0; p < producer_count; p++) {
+        producers.emplace_back([&, p]() {
+            for (int i = p; i < command_count; i += producer_count) {
+                queue.Post(*check_boxes[i % check_boxes.size()], &CheckBox::SetCheck, (i & 1) != 0);
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    result.post_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    context.Frame([&]() {
+        auto drain_start = std::chrono::steady_clock::now();
+        result.drain_count = queue.Drain();
+        result.drain_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - drain_start).count();
+    });
+    return result;
+}
+
+struct CodeEditorBenchmark {
+    // ÿ֡ƽʱ༭
+    double typing_ms;
+    double paste_ms;
+    double scroll_ms;
+    // ׶κϼ·
+    size_t retokenize_count;
+};
+
+/*
+* HeadlessContextжline_countеCodeEditorֱ֡һַճpaste_linesСҳframe_count֡
+* ȷϱ༭͹Ŀֻɼк޸ĵйأĵ޹
+*/
+static CodeEditorBenchmark BenchmarkCodeEditor(int line_count, int frame_count, int paste_lines = 100) {
+    ImFontAtlas atlas;
+    atlas.AddFontDefault();
+    unsigned char* pixels;
+    int width, height;
+    atlas.GetTexDataAsRGBA32(&pixels, &width, &height);
+    atlas.SetTexID((ImTextureID)(intptr_t)1);
+
+    std::string text;
+    for (int i = 0; i < line_count; i++) {
+        text += "    int value" + std::to_string(i) + " = compute(" + std::to_string(i) + "); // line\n";
+    }
+    std::string paste;
+    for (int i = 0; i < paste_lines; i++) {
+        paste += "    /* pasted */ call(\"text\", 42);\n";
+    }
+    HeadlessContext context(&atlas);
+    CodeEditor editor("##benchmark_editor", ImVec2(800.0f, 600.0f));
+    editor.SetText(text);
+    auto run = [&](const std::function<void(int)>& edit) {
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frame_count; frame++) {
+            context.Frame([&]() {
+                edit(frame);
+                editor.Begin();
+                editor.End();
+            });
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / std::max(1, frame_count);
+    };
+
+    CodeEditorBenchmark result;
+    editor.SetCursor((size_t)line_count / 2, 4);
+    result.typing_ms = run([&](int) { editor.Insert("x", 1); });
+    result.paste_ms = run([&](int) { editor.Insert(paste.data(), paste.size()); });
+    size_t lines = editor.GetLineCount();
+    result.scroll_ms = run([&](int frame) { editor.SetCursor((size_t)frame * 40 % lines, 0); });
+    result.retokenize_count = editor.GetRetokenizeCount();
+    return result;
+}
+
+struct CheckBoxGridBenchmark {
+    // ÿ֡ƽʱѡ仯
+    double frame_ms;
+    // ȫѡ״̬ͬʱ仯һ֡
+    double flip_all_ms;
+};
+
+// HeadlessContextлcountѡÿ֡޸flips_per_frameframe_count֡ȽλͼڴѡµĿ
+static CheckBoxGridBenchmark BenchmarkCheckBoxGrid(uint32_t count, int frame_count, int flips_per_frame = 8) {
+    ImFontAtlas atlas;
+    atlas.AddFontDefault();
+    unsigned char* pixels;
+    int width, height;
+    atlas.GetTexDataAsRGBA32(&pixels, &width, &height);
+    atlas.SetTexID((ImTextureID)(intptr_t)1);
+
+    HeadlessContext context(&atlas);
+    CheckBoxGrid grid("##benchmark_grid", count, 4, ImVec2(800.0f, 600.0f));
+    auto frame = [&](const std::function<void()>& edit) {
+        auto start = std::chrono::steady_clock::now();
+        context.Frame([&]() {
+            edit();
+            grid.Begin();
+            grid.End();
+        });
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    CheckBoxGridBenchmark result;
+    double total = 0.0;
+    uint32_t next = 0;
+    for (int i = 0; i < frame_count; i++) {
+        total += frame([&]() {
+            for (int flip = 0; flip < flips_per_frame && count > 0; flip++) {
+                next = (next + 7919) % count;
+                grid.SetCheck(next, !grid.GetCheck(next));
+            }
+        });
+    }
+    result.frame_ms = total / std::max(1, frame_count);
+    result.flip_all_ms = frame([&]() { grid.SetAll(true); });
+    return result;
+}
+
+struct WindowCacheBenchmark {
+    // ÿ֡ƽʱֱΪڶͶرջ
+    double cached_ms;
+    double uncached_ms;
+    // ֻ̬ControlãʵʱеPlotÿ֡׷
+    DrawCacheStats static_stats;
+    DrawCacheStats live_stats;
+};
+
+/*
+* HeadlessContextлڣ̬ڰwidget_countťÿcontrol_interval֡޸һαǩʵʱеPlotÿ֡׷һ
+* ȷһڵControlòʹһڵĻʧЧ
+*/
+static WindowCacheBenchmark BenchmarkWindowCache(int widget_count, int frame_count, int control_interval = 60) {
+    ImFontAtlas atlas;
+    atlas.AddFontDefault();
+    unsigned char* pixels;
+    int width, height;
+    atlas.GetTexDataAsRGBA32(&pixels, &width, &height);
+    atlas.SetTexID((ImTextureID)(intptr_t)1);
+
+    HeadlessContext context(&atlas);
+    std::vector<std::unique_ptr<Button>> buttons;
+    for (int i = 0; i < widget_count; i++) {
+        buttons.push_back(std::make_unique<Button>("Button " + std::to_string(i)));
+    }
+    Plot plot("##benchmark_plot");
+    auto run = [&](bool cacheable, WindowCacheBenchmark* result) {
+        Window static_window("Static", false, true, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings);
+        Window live_window("Live", false, true, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings);
+        static_window.SetCacheable(cacheable);
+        live_window.SetCacheable(cacheable);
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frame_count; frame++) {
+            if (control_interval > 0 && frame % control_interval == control_interval - 1 && !buttons.empty()) {
+                buttons[0]->SetLabel("Button 0 (" + std::to_string(frame) + ")");
+            }
+            plot.Append(sinf((float)frame * 0.1f));
+            context.Frame([&]() {
+                static_window.Begin();
+                static_window.CacheUpdate([&]() {
+                    for (auto& button : buttons) {
+                        button->Begin();
+                        button->End();
+                    }
+                });
+                static_window.End();
+                live_window.Begin();
+                live_window.CacheUpdate([&]() {
+                    plot.Begin();
+                    plot.End();
+                });
+                live_window.End();
+            });
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / std::max(1, frame_count);
+        if (result) {
+            result->static_stats = static_window.GetCacheStats();
+            result->live_stats = live_window.GetCacheStats();
+        }
+        return ms;
+    };
+
+    WindowCacheBenchmark result;
+    result.cached_ms = run(true, &result);
+    result.uncached_ms = run(false, nullptr);
+    return result;
+}
+
+struct PlotOutput {
+    size_t sample_count;
+    float width;
+    int draw_point_count;
+    // ֡Ķڱ
+    int vertex_count;
+};
+
+// ֱԸͿȻPlotƵĵͶӦֻ޹
+static std::vector<PlotOutput> CheckPlotOutput(const std::vector<size_t>& sample_counts, const std::vector<float>& widths) {
+    ImFontAtlas atlas;
+    atlas.AddFontDefault();
+    unsigned char* pixels;
+    int width, height;
+    atlas.GetTexDataAsRGBA32(&pixels, &width, &height);
+    atlas.SetTexID((ImTextureID)(intptr_t)1);
+
+    std::vector<PlotOutput> result;
+    for (size_t sample_count : sample_counts) {
+        Plot plot("##output_plot", sample_count);
+        for (size_t i = 0; i < sample_count; i++) {
+            plot.Append(sinf((float)i * 0.01f) + (float)(i % 7) * 0.1f);
+        }
+        for (float plot_width : widths) {
+            HeadlessContext context(&atlas);
+            plot.SetSize(ImVec2(plot_width, 150.0f));
+            ImDrawData* draw_data = context.Frame([&]() {
+                ImGui::SetNextWindowSize(ImVec2(plot_width + 100.0f, 300.0f), ImGuiCond_Always);
+                ImGui::Begin("Plot");
+                plot.Begin();
+                plot.End();
+                ImGui::End();
+            });
+            result.push_back(PlotOutput{ sample_count, plot_width, plot.GetDrawPointCount(), draw_data->TotalVtxCount });
+        }
+    }
+    return result;
+}
+
+struct SessionBenchmark {
+    double save_ms;
+    // ӳ䡢УļΪעؼŻָ
+    double load_ms;
+    // ֡пؼִлָ
+    double restore_ms;
+    // ָ뱣ʱ״̬ͬĿؼӦΪ0
+    size_t mismatch_count;
+    // ƫƼӳȻƵļܾ
+    bool overflow_rejected;
+};
+
+/*
+* widget_countCheckBox״̬µĿؼSessionزָ֡
+* ļͷеĳȸΪʹƫƻƵֵȷLoadܾļ
+*/
+static SessionBenchmark BenchmarkSession(int widget_count = 10000, const std::string& path = "imgui_ex_session_benchmark.bin") {
+    ImFontAtlas atlas;
+    atlas.AddFontDefault();
+    unsigned char* pixels;
+    int width, height;
+    atlas.GetTexDataAsRGBA32(&pixels, &width, &height);
+    atlas.SetTexID((ImTextureID)(intptr_t)1);
+
+    HeadlessContext context(&atlas);
+    auto elapsed = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    auto make = [&]() {
+        std::vector<std::unique_ptr<CheckBox>> check_boxes;
+        for (int i = 0; i < widget_count; i++) {
+            check_boxes.push_back(std::make_unique<CheckBox>("CheckBox " + std::to_string(i)));
+        }
+        return check_boxes;
+    };
+
+    SessionBenchmark result;
+    {
+        auto check_boxes = make();
+        Session session;
+        for (int i = 0; i < widget_count; i++) {
+            check_boxes[i]->SetCheck(i % 3 == 0);
+            session.Register(*check_boxes[i]);
+        }
+        // 洰Ҫһ֡
+        context.Frame([]() {});
+        auto start = std::chrono::steady_clock::now();
+        session.Save(path);
+        result.save_ms = elapsed(start);
+    }
+    {
+        auto check_boxes = make();
+        Session session;
+        for (auto& check_box : check_boxes) {
+            session.Register(*check_box);
+        }
+        auto start = std::chrono::steady_clock::now();
+        session.Load(path);
+        result.load_ms = elapsed(start);
+
+        start = std::chrono::steady_clock::now();
+        context.Frame([&]() {
+            ImGui::Begin("Session");
+            for (auto& check_box : check_boxes) {
+                check_box->Begin();
+                check_box->End();
+            }
+            ImGui::End();
+        });
+        result.restore_ms = elapsed(start);
+
+        result.mismatch_count = 0;
+        for (int i = 0; i < widget_count; i++) {
+            if (check_boxes[i]->GetCheck() != (i % 3 == 0)) {
+                result.mismatch_count++;
+            }
+        }
+    }
+
+    // ļͷini_sizeλƫ24data_offsetλƫ40
+    auto load_patched = [&](std::streamoff offset, uint64_t value) {
+        std::string bytes;
+        {
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            bytes.resize((size_t)in.tellg());
+            in.seekg(0);
+            in.read(&bytes[0], bytes.size());
+        }
+        std::string patched_path = path + ".patched";
+        memcpy(&bytes[(size_t)offset], &value, sizeof(value));
+        {
+            std::ofstream out(patched_path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), bytes.size());
+        }
+        bool loaded;
+        {
+            Session session;
+            ImGui::SetCurrentContext(context.GetContext());
+            loaded = session.Load(patched_path);
+        }
+        std::remove(patched_path.c_str());
+        return loaded;
+    };
+    result.overflow_rejected = !load_patched(24, UINT64_MAX - 8) && !load_patched(40, UINT64_MAX - 8);
+    std::remove(path.c_str());
+    return result;
+}
+
+struct NodeGraphBenchmark {
+    // ֡ռƵĺʱ
+    double build_ms;
+    // ϸڼÿ֡ƽʱԼһ֡ƵĽڵ
+    double frame_ms[3];
+    size_t visible_nodes[3];
+    size_t visible_edges[3];
+    NodeGraph::Lod lod[3];
+};
+
+/*
+* node_countڵųɷÿڵҲ·ھӣÿ1000ڵһ߶Ϊ10Ľڵ
+* ֱԭʼšڵֻмءFitʾȫͼ¸frame_count֡
+*/
+static NodeGraphBenchmark BenchmarkNodeGraph(int node_count = 100000, int frame_count = 60) {
+    ImFontAtlas atlas;
+    atlas.AddFontDefault();
+    unsigned char* pixels;
+    int width, height;
+    atlas.GetTexDataAsRGBA32(&pixels, &width, &height);
+    atlas.SetTexID((ImTextureID)(intptr_t)1);
+
+    HeadlessContext context(&atlas);
+    NodeGraph graph("##benchmark_graph");
+    graph.SetSize(ImVec2(1200.0f, 700.0f));
+    int columns = std::max(1, (int)std::sqrt((double)node_count));
+    graph.Reserve(node_count, (size_t)node_count * 2);
+    for (int i = 0; i < node_count; i++) {
+        float node_height = i % 1000 == 0 ? 400.0f : 40.0f;
+        graph.AddNode("Node " + std::to_string(i), ImVec2((float)(i % columns) * 200.0f, (float)(i / columns) * 100.0f), ImVec2(120.0f, node_height));
+    }
+    for (int i = 0; i < node_count; i++) {
+        if ((i + 1) % columns != 0 && i + 1 < node_count) {
+            graph.AddEdge(i, i + 1);
+        }
+        if (i + columns < node_count) {
+            graph.AddEdge(i, i + columns);
+        }
+    }
+
+    auto frame = [&]() {
+        context.Frame([&]() {
+            ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f), ImGuiCond_Always);
+            ImGui::SetNextWindowSize(ImVec2(1280.0f, 800.0f), ImGuiCond_Always);
+            ImGui::Begin("Graph");
+            graph.Begin();
+            graph.End();
+            ImGui::End();
+        });
+    };
+    auto elapsed = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    NodeGraphBenchmark result;
+    auto start = std::chrono::steady_clock::now();
+    frame();
+    result.build_ms = elapsed(start);
+    for (int view = 0; view < 3; view++) {
+        if (view == 0) {
+            graph.SetView(ImVec2(0.0f, 0.0f), 1.0f);
+        }
+        else if (view == 1) {
+            graph.SetView(ImVec2(0.0f, 0.0f), 0.1f);
+        }
+        else {
+            graph.Fit();
+        }
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frame_count; i++) {
+            frame();
+        }
+        result.frame_ms[view] = elapsed(start) / std::max(1, frame_count);
+        result.visible_nodes[view] = graph.GetVisibleNodeCount();
+        result.visible_edges[view] = graph.GetVisibleEdgeCount();
+        result.lod[view] = graph.GetLod();
+    }
+    return result;
+}
+
+
+/*
+* ϳ룬д뵱ǰImGuiContextвͬʱ¼ӳͳ
+*/
+class InputInjector {
+public:
+    InputInjector(LatencyTracker* tracker = nullptr) {
+        tracker_ = tracker;
+    }
+
+    void MouseMove(float x, float y) {
+        Stamp(InputType::kMouseMove);
+        ImGui::GetIO().AddMousePosEvent(x, y);
+    }
+
+    void MouseButton(int button, bool down) {
+        Stamp(InputType::kMouseButton);
+        ImGui::GetIO().AddMouseButtonEvent(button, down);
+    }
+
+    void MouseWheel(float wheel_x, float wheel_y) {
+        Stamp(InputType::kMouseWheel);
+        ImGui::GetIO().AddMouseWheelEvent(wheel_x, wheel_y);
+    }
+
+    void Key(ImGuiKey key, bool down) {
+        Stamp(InputType::kKey);
+        ImGui::GetIO().AddKeyEvent(key, down);
+    }
+
+    void Char(unsigned int c) {
+        Stamp(InputType::kChar);
+        ImGui::GetIO().AddInputCharacter(c);
+    }
+
+    void Focus(bool focused) {
+        Stamp(InputType::kFocus);
+        ImGui::GetIO().AddFocusEvent(focused);
+    }
+
+private:
+    void Stamp(InputType type) {
+        LatencyTracker* tracker = tracker_ ? tracker_ : CurrentLatencyTracker();
+        if (tracker) {
+            tracker->Input(type);
+        }
+    }
+
+private:
+    LatencyTracker* tracker_;
+};
+
+/*
+* ޴ڵӳٲ
+* ʹFakeClockģѭĽࣺ֡ʱֱͬȴԼÿ֡ĩβSlowDown
+*/
+class LatencyHarness {
+public:
+    LatencyHarness(std::function<void()> update) : tracker_(&clock_), injector_(&tracker_), update_(update) {
+        last_frame_time_ = 0.0;
+        frame_cost_ = 0.002;
+        vsync_interval_ = 1.0 / 60.0;
+        slow_down_ = 0.010;
+    }
+
+    // һ֮֡ǰע룬ȵȴdelayԿ֡еλ
+    InputInjector& Inject(double delay = 0.0) {
+        clock_.Advance(delay);
+        ImGui::SetCurrentContext(context_.GetContext());
+        return injector_;
+    }
+
+    void RunFrame() {
+        LatencyTracker* last = CurrentLatencyTracker();
+        SetLatencyTracker(&tracker_);
+        double delta_time = clock_.Now() - last_frame_time_;
+        last_frame_time_ = clock_.Now();
+
+        // NewFrameFrameڲãFakeClockʱ䲻䣬ȼ¼
+        tracker_.NewFrame();
+        context_.Frame([this]() {
+            update_();
+            clock_.Advance(frame_cost_);
+        }, delta_time > 0.0 ? (float)delta_time : 1.0f / 60.0f);
+        tracker_.Render();
+        if (vsync_interval_ > 0.0) {
+            double now = clock_.Now();
+            double next = std::ceil(now / vsync_interval_) * vsync_interval_;
+            clock_.Advance(next - now);
+        }
+        tracker_.Present();
+        clock_.Sleep(slow_down_);
+        SetLatencyTracker(last);
+    }
+
+    void SetFrameCost(double seconds) {
+        frame_cost_ = seconds;
+    }
+
+    // 0ʾرմֱͬ
+    void SetVsyncInterval(double seconds) {
+        vsync_interval_ = seconds;
+    }
+
+    void SetSlowDown(double seconds) {
+        slow_down_ = seconds;
+    }
+
+    FakeClock& GetClock() {
+        return clock_;
+    }
+
+    LatencyTracker& GetTracker() {
+        return tracker_;
+    }
+
+    HeadlessContext& GetContext() {
+        return context_;
+    }
+
+private:
+    FakeClock clock_;
+    LatencyTracker tracker_;
+    InputInjector injector_;
+    HeadlessContext context_;
+    std::function<void()> update_;
+
+    double last_frame_time_;
+    double frame_cost_;
+    double vsync_interval_;
+    double slow_down_;
+};
+
+struct IdleTimerCheck {
+    // ͣڰť֮ʾûгʱΪ
+    double tooltip_delay;
+    // ֮ͣȾ֡
+    size_t tooltip_frame_count;
+    // ʾֺǷص޵ȴ
+    bool tooltip_idle;
+    // ռλͼڼdurationȾ֡Ӧӽduration * 60
+    size_t spinner_frame_count;
+};
+
+/*
+* ʹFakeClockģ⿪еȴѭÿ֡ȴAnimator::GetIdleTimeoutGetTimerTimeoutнСֱ̼ͬ
+* ȴΪʱѭһϢģ֮
+* ֱͣʾܷû°ӳٳ֣ԼеImageռλǷˢ
+*/
+static IdleTimerCheck CheckIdleTimers(double duration = 2.0) {
+    ImFontAtlas atlas;
+    atlas.AddFontDefault();
+    unsigned char* pixels;
+    int width, height;
+    atlas.GetTexDataAsRGBA32(&pixels, &width, &height);
+    atlas.SetTexID((ImTextureID)(intptr_t)1);
+
+    ImGuiContext* last = ImGui::GetCurrentContext();
+    const double vsync_interval = 1.0 / 60.0;
+    FakeClock clock;
+    Animator animator(&clock);
+    animator.SetIdleEnabled(true);
+
+    // ел򳬹durationȾ֡
+    auto run = [&](HeadlessContext& context, const std::function<void()>& update, bool& idle) {
+        size_t frame_count = 0;
+        double end = clock.Now() + duration;
+        double last_frame_time = clock.Now() - vsync_interval;
+        idle = false;
+        while (clock.Now() < end) {
+            float delta_time = (float)(clock.Now() - last_frame_time);
+            last_frame_time = clock.Now();
+            context.Frame([&]() {
+                animator.Update();
+                update();
+            }, delta_time);
+            frame_count++;
+            double timeout = std::min(animator.GetIdleTimeout(), GetTimerTimeout());
+            if (std::isinf(timeout)) {
+                idle = true;
+                break;
+            }
+            clock.Sleep(std::max(timeout, vsync_interval));
+        }
+        return frame_count;
+    };
+
+    IdleTimerCheck result;
+    {
+        HeadlessContext context(&atlas);
+        ImVec2 center(0.0f, 0.0f);
+        double tooltip_time = -1.0;
+        auto update = [&]() {
+            ImGui::Begin("##idle_timers");
+            ImGui::Button("button");
+            center = ImVec2((ImGui::GetItemRectMin().x + ImGui::GetItemRectMax().x) * 0.5f, (ImGui::GetItemRectMin().y + ImGui::GetItemRectMax().y) * 0.5f);
+            if (ImGui::BeginItemTooltip()) {
+                ImGui::TextUnformatted("tooltip");
+                ImGui::EndTooltip();
+                if (tooltip_time < 0.0) {
+                    tooltip_time = clock.Now();
+                }
+            }
+            ImGui::End();
+        };
+        // ´ǰ֡ҪԶߴ磬ťλȶƶ
+        for (int i = 0; i < 3; i++) {
+            context.Frame(update, (float)vsync_interval);
+            clock.Advance(vsync_interval);
+        }
+
+        ImGui::SetCurrentContext(context.GetContext());
+        ImGui::GetIO().AddMousePosEvent(center.x, center.y);
+        double hover_time = clock.Now();
+        result.tooltip_frame_count = run(context, update, result.tooltip_idle);
+        result.tooltip_delay = tooltip_time < 0.0 ? -1.0 : tooltip_time - hover_time;
+    }
+    {
+        // һֱʼδ
+        std::atomic<bool> release(false);
+        CpuTextureRenderer renderer;
+        TextureManager manager(&renderer, [&](const std::string&, std::vector<unsigned char>&, int&, int&) {
+            while (!release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return false;
+        }, 1);
+        HeadlessContext context(&atlas);
+        Image image("##idle_image", manager, "loading", ImVec2(64.0f, 64.0f));
+        bool idle;
+        result.spinner_frame_count = run(context, [&]() {
+            ImGui::Begin("##idle_timers");
+            image.Begin();
+            image.End();
+            ImGui::End();
+        }, idle);
+        release = true;
+    }
+    ImGui::SetCurrentContext(last);
+    return result;
+}
+
+
+struct MemoryEntry {
+    std::string name;
+    const char* category;
+    size_t used;
+    size_t capacity;
+};
+
+struct MemoryReport {
+    std::vector<MemoryEntry> windows;
+    std::vector<MemoryEntry> widgets;
+    size_t draw_list_bytes;
+    size_t text_bytes;
+    size_t list_bytes;
+    size_t other_bytes;
+    size_t font_atlas_bytes;
+    size_t total_bytes;
+};
+
+/*
+* ڴͳԶ
+* ڵImDrawListעؼĻhold_secondswindow_secondsʹ÷ֵratioͻᱻ
+* Updateֻ֮֡֡ãѭPresent֮õǰ̵߳MemoryTracker
+*/
+class MemoryTracker {
+public:
+    MemoryTracker() {
+        ratio_ = 4.0f;
+        hold_seconds_ = 10.0;
+        window_seconds_ = 30.0;
+        min_bytes_ = 64 * 1024;
+        trim_count_ = 0;
+        trimmed_bytes_ = 0;
+    }
+
+    template<class W>
+    void Register(W& widget, const std::string& name = std::string()) {
+        Entry entry;
+        entry.name = name.empty() ? widget.GetLabel() : name;
+        entry.widget = &widget;
+        entry.usage = [&widget]() { return widget.GetMemoryUsage(); };
+        entry.trim = [&widget]() { widget.TrimMemory(); };
+        entries_.push_back(std::move(entry));
+    }
+
+    void Unregister(Widget& widget) {
+        for (size_t i = 0; i < entries_.size();) {
+            if (entries_[i].widget == &widget) {
+                states_.erase(entries_[i].widget);
+                entries_.erase(entries_.begin() + i);
+            }
+            else {
+                i++;
+            }
+        }
+    }
+
+    void SetTrimPolicy(float ratio, double hold_seconds, double window_seconds, size_t min_bytes = 64 * 1024) {
+        ratio_ = ratio;
+        hold_seconds_ = hold_seconds;
+        window_seconds_ = window_seconds;
+        min_bytes_ = min_bytes;
+    }
+
+    MemoryReport Report() {
+        MemoryReport report = {};
+        ImGuiContext& g = *GImGui;
+        for (int i = 0; i < g.Windows.Size; i++) {
+            ImGuiWindow* window = g.Windows[i];
+            MemoryEntry entry;
+            entry.name = window->Name;
+            entry.category = "draw_list";
+            DrawListUsage(window->DrawList, entry.used, entry.capacity);
+            report.draw_list_bytes += entry.capacity;
+            report.windows.push_back(std::move(entry));
+        }
+        for (auto& item : entries_) {
+            MemoryUsage usage = item.usage();
+            MemoryEntry entry;
+            entry.name = item.name;
+            entry.category = usage.category;
+            entry.used = usage.used;
+            entry.capacity = usage.capacity;
+            if (strcmp(usage.category, "text") == 0) {
+                report.text_bytes += usage.capacity;
+            }
+            else if (strcmp(usage.category, "list") == 0) {
+                report.list_bytes += usage.capacity;
+            }
+            else {
+                report.other_bytes += usage.capacity;
+            }
+            report.widgets.push_back(std::move(entry));
+        }
+        report.font_atlas_bytes = FontAtlasBytes(ImGui::GetIO().Fonts);
+        report.total_bytes = report.draw_list_bytes + report.text_bytes + report.list_bytes + report.other_bytes + report.font_atlas_bytes;
+        return report;
+    }
+
+    // رֽ
+    size_t Update(double now) {
+        size_t trimmed = 0;
+        ImGuiContext& g = *GImGui;
+        for (int i = 0; i < g.Windows.Size; i++) {
+            ImGuiWindow* window = g.Windows[i];
+            if (window->MemoryCompacted || window->DrawList == nullptr) {
+                continue;
+            }
+            size_t used, capacity;
+            DrawListUsage(window->DrawList, used, capacity);
+            if (Check(window, used, capacity, now)) {
+                int vtx_size = window->DrawList->VtxBuffer.Size;
+                int idx_size = window->DrawList->IdxBuffer.Size;
+                ImGui::GcCompactTransientWindowBuffers(window);
+                // ImGuiѴʱᰴѹǰreserveΪǰһ֡ͻָԭ״
+                window->MemoryDrawListVtxCapacity = vtx_size;
+                window->MemoryDrawListIdxCapacity = idx_size;
+                size_t awake = vtx_size * sizeof(ImDrawVert) + idx_size * sizeof(ImDrawIdx);
+                trimmed += capacity > awake ? capacity - awake : 0;
+            }
+        }
+        for (auto& item : entries_) {
+            MemoryUsage usage = item.usage();
+            if (Check(item.widget, usage.used, usage.capacity, now)) {
+                item.trim();
+                MemoryUsage after = item.usage();
+                trimmed += usage.capacity > after.capacity ? usage.capacity - after.capacity : 0;
+            }
+        }
+        if (trimmed > 0) {
+            trim_count_++;
+            trimmed_bytes_ += trimmed;
+        }
+        return trimmed;
+    }
+
+    size_t Update() {
+        return Update(ImGui::GetTime());
+    }
+
+    size_t GetTrimCount() {
+        return trim_count_;
+    }
+
+    size_t GetTrimmedBytes() {
+        return trimmed_bytes_;
+    }
+
+private:
+    struct Entry {
+        std::string name;
+        Widget* widget;
+        std::function<MemoryUsage()> usage;
+        std::function<void()> trim;
+    };
+
+    struct TrimState {
+        size_t peak;
+        double peak_time;
+        double above_time;
+        bool above;
+    };
+
+    static void DrawListUsage(ImDrawList* draw_list, size_t& used, size_t& capacity) {
+        used = draw_list->VtxBuffer.Size * sizeof(ImDrawVert) + draw_list->IdxBuffer.Size * sizeof(ImDrawIdx) + draw_list->CmdBuffer.Size * sizeof(ImDrawCmd);
+        capacity = draw_list->VtxBuffer.Capacity * sizeof(ImDrawVert) + draw_list->IdxBuffer.Capacity * sizeof(ImDrawIdx) + draw_list->CmdBuffer.Capacity * sizeof(ImDrawCmd);
+    }
+
+    static size_t FontAtlasBytes(ImFontAtlas* atlas) {
+        size_t pixels = (size_t)atlas->TexWidth * atlas->TexHeight;
+        size_t bytes = 0;
+        if (atlas->TexPixelsAlpha8) bytes += pixels;
+        if (atlas->TexPixelsRGBA32) bytes += pixels * 4;
+        for (int i = 0; i < atlas->Fonts.Size; i++) {
+            ImFont* font = atlas->Fonts[i];
+            bytes += font->Glyphs.Capacity * sizeof(ImFontGlyph);
+            bytes += font->IndexAdvanceX.Capacity * sizeof(float);
+            bytes += font->IndexLookup.Capacity * sizeof(ImWchar);
+        }
+        return bytes;
+    }
+
+    // ֵÿwindow_seconds¿ʼͳ
+    bool Check(const void* key, size_t used, size_t capacity, double now) {
+        TrimState& state = states_[key];
+        if (state.peak_time == 0.0 || now - state.peak_time > window_seconds_) {
+            state.peak = used;
+            state.peak_time = now;
+        }
+        else if (used > state.peak) {
+            state.peak = used;
+        }
+        size_t peak = state.peak > min_bytes_ ? state.peak : min_bytes_;
+        if ((double)capacity <= (double)peak * ratio_) {
+            state.above = false;
+            return false;
+        }
+        if (!state.above) {
+            state.above = true;
+            state.above_time = now;
+            return false;
+        }
+        if (now - state.above_time < hold_seconds_) {
+            return false;
+        }
+        state.above = false;
+        return true;
+    }
+
+private:
+    std::vector<Entry> entries_;
+    std::unordered_map<const void*, TrimState> states_;
+
+    float ratio_;
+    double hold_seconds_;
+    double window_seconds_;
+    size_t min_bytes_;
+
+    size_t trim_count_;
+    size_t trimmed_bytes_;
+};
+
+inline MemoryTracker*& CurrentMemoryTracker() {
+    static thread_local MemoryTracker* tracker = nullptr;
+    return tracker;
+}
+
+static void SetMemoryTracker(MemoryTracker* tracker) {
+    CurrentMemoryTracker() = tracker;
+}
+
+struct MemorySoak {
+    // ListBox
+    size_t peak_capacity;
+    // нʱӦԶСpeak_capacity
+    size_t final_capacity;
+    size_t trim_count;
+    size_t trimmed_bytes;
+    // Ӽ䵽һûʱΪ
+    double trim_delay;
+};
+
+/*
+* HeadlessContext10֡ÿģʱMemoryTracker
+* һListBoxװspike_rowsУգwindow_seconds + hold_seconds * 2
+* ԣֵͳƴڽҳhold_seconds֮Ӧ
+*/
+static MemorySoak SoakMemoryTracker(double hold_seconds = 10.0, double window_seconds = 30.0, size_t spike_rows = 100000) {
+    ImFontAtlas atlas;
+    atlas.AddFontDefault();
+    unsigned char* pixels;
+    int width, height;
+    atlas.GetTexDataAsRGBA32(&pixels, &width, &height);
+    atlas.SetTexID((ImTextureID)(intptr_t)1);
+
+    HeadlessContext context(&atlas);
+    ListBox<std::string> list_box("##soak_list");
+    MemoryTracker tracker;
+    tracker.SetTrimPolicy(4.0f, hold_seconds, window_seconds);
+    tracker.Register(list_box);
+
+    std::vector<std::string> rows(spike_rows);
+    for (size_t i = 0; i < spike_rows; i++) {
+        rows[i] = "Row " + std::to_string(i);
+    }
+    list_box.SetList(std::move(rows));
+
+    MemorySoak result = {};
+    result.trim_delay = -1.0;
+    const double frame_interval = 0.1;
+    const double spike_seconds = 1.0;
+    double end = spike_seconds + window_seconds + hold_seconds * 2.0;
+    bool spiking = true;
+    for (int frame = 0; frame * frame_interval < end; frame++) {
+        double now = frame * frame_interval;
+        if (spiking && now >= spike_seconds) {
+            spiking = false;
+            list_box.ClearList();
+            result.peak_capacity = list_box.GetMemoryUsage().capacity;
+        }
+        context.Frame([&]() {
+            ImGui::Begin("Soak");
+            list_box.Begin();
+            list_box.InsertUpdate([](std::string& row) { return row; });
+            list_box.End();
+            ImGui::End();
+        }, (float)frame_interval);
+        if (tracker.Update(now) > 0 && result.trim_delay < 0.0 && !spiking) {
+            result.trim_delay = now - spike_seconds;
+        }
+    }
+    result.final_capacity = list_box.GetMemoryUsage().capacity;
+    result.trim_count = tracker.GetTrimCount();
+    result.trimmed_bytes = tracker.GetTrimmedBytes();
+    return result;
+}
+
+
+struct DrawStats {
+    int draw_lists;
+    int draw_cmds;
+    int vtx_count;
+    int idx_count;
+    int texture_switches;
+};
+
+struct DrawBudget {
+    int draw_cmds;
+    int vtx_count;
+    int idx_count;
+    int texture_switches;
+};
+
+/*
+* ƿͳ
+* draw_cmdsֻʵʵĻƵ(ElemCount0޻ص)texture_switchesύ˳лһΰ
+*/
+static DrawStats CountDrawData(ImDrawData* draw_data) {
+    DrawStats stats = {};
+    if (draw_data == nullptr || !draw_data->Valid) {
+        return stats;
+    }
+    stats.draw_lists = draw_data->CmdListsCount;
+    stats.vtx_count = draw_data->TotalVtxCount;
+    stats.idx_count = draw_data->TotalIdxCount;
+    ImTextureID texture = (ImTextureID)0;
+    bool bound = false;
+    for (int i = 0; i < draw_data->CmdListsCount; i++) {
+        const ImDrawList* draw_list = draw_data->CmdLists[i];
+        for (int j = 0; j < draw_list->CmdBuffer.Size; j++) {
+            const ImDrawCmd& cmd = draw_list->CmdBuffer[j];
+            if (cmd.UserCallback != nullptr || cmd.ElemCount == 0) {
+                continue;
+            }
+            stats.draw_cmds++;
+            if (!bound || cmd.GetTexID() != texture) {
+                texture = cmd.GetTexID();
+                bound = true;
+                stats.texture_switches++;
+            }
+        }
+    }
+    return stats;
+}
+
+struct ViewportDrawStats {
+    ImGuiID viewport_id;
+    DrawStats stats;
+};
+
+// ImGui::Render֮ãͳƵǰcontextÿӿڵĻ
+static std::vector<ViewportDrawStats> CollectDrawStats() {
+    std::vector<ViewportDrawStats> result;
+    ImGuiContext& g = *GImGui;
+    for (int i = 0; i < g.Viewports.Size; i++) {
+        ImGuiViewport* viewport = g.Viewports[i];
+        if (viewport->DrawData == nullptr) {
+            continue;
+        }
+        result.push_back(ViewportDrawStats{ viewport->ID, CountDrawData(viewport->DrawData) });
+    }
+    return result;
+}
+
+// ޴ڻлһ棬warmup_frames֡ôڳߴչ״̬ȶһ֡ͳ
+static DrawStats MeasureScreen(HeadlessContext& context, const std::function<void()>& update, int warmup_frames = 2) {
+    for (int i = 0; i < warmup_frames; i++) {
+        context.Frame(update);
+    }
+    return CountDrawData(context.Frame(update));
+}
+
+/*
+* Ԥ
+* ÿһԤ㣬ıļÿиʽΪ:  draw_cmds vtx_count idx_count texture_switches#ͷΪע
+* CheckԤʱfalseѳĿ׷ӵreport
+*/
+class DrawBudgetChecker {
+public:
+    DrawBudgetChecker() {
+    }
+
+    void SetBudget(const std::string& name, const DrawBudget& budget) {
+        budgets_[name] = budget;
+    }
+
+    bool GetBudget(const std::string& name, DrawBudget& budget) {
+        auto it = budgets_.find(name);
+        if (it == budgets_.end()) {
+            return false;
+        }
+        budget = it->second;
+        return true;
+    }
+
+    bool Load(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) {
+            return false;
+        }
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            char name[256];
+            DrawBudget budget;
+            if (sscanf(line.c_str(), "%255s %d %d %d %d", name, &budget.draw_cmds, &budget.vtx_count, &budget.idx_count, &budget.texture_switches) == 5) {
+                budgets_[name] = budget;
+            }
+        }
+        return true;
+    }
+
+    bool Save(const std::string& path) {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << "# name draw_cmds vtx_count idx_count texture_switches\n";
+        for (auto& item : budgets_) {
+            const DrawBudget& budget = item.second;
+            file << item.first << ' ' << budget.draw_cmds << ' ' << budget.vtx_count << ' ' << budget.idx_count << ' ' << budget.texture_switches << '\n';
+        }
+        return true;
+    }
+
+    // ûԤĻΪͨ
+    bool Check(const std::string& name, const DrawStats& stats, std::string* report = nullptr) {
+        auto it = budgets_.find(name);
+        if (it == budgets_.end()) {
+            return true;
+        }
+        const DrawBudget& budget = it->second;
+        bool ok = true;
+        ok &= CheckItem(name, "draw_cmds", stats.draw_cmds, budget.draw_cmds, report);
+        ok &= CheckItem(name, "vtx_count", stats.vtx_count, budget.vtx_count, report);
+        ok &= CheckItem(name, "idx_count", stats.idx_count, budget.idx_count, report);
+        ok &= CheckItem(name, "texture_switches", stats.texture_switches, budget.texture_switches, report);
+        return ok;
+    }
+
+    // õǰԤ㣬Ԥļ
+    void Accept(const std::string& name, const DrawStats& stats) {
+        budgets_[name] = DrawBudget{ stats.draw_cmds, stats.vtx_count, stats.idx_count, stats.texture_switches };
+    }
+
+private:
+    static bool CheckItem(const std::string& name, const char* item, int value, int budget, std::string* report) {
+        if (value <= budget) {
+            return true;
+        }
+        if (report) {
+            char buffer[256];
+            snprintf(buffer, sizeof(buffer), "%s: %s %d > %d\n", name.c_str(), item, value, budget);
+            report->append(buffer);
+        }
+        return false;
+    }
+
+private:
+    std::map<std::string, DrawBudget> budgets_;
+};
+
+/*
+* Ԥ׼
+* ÿڶHeadlessContextлƣӿڷֱԤȽϣһӿʹûΪ"/"
+* ֻImGuiĻݣҪGPUʹڣͷļWin32d3d11ͷļֻWindowsϱ
+* ԤļҪĿ껷Acceptɺύ˺RunڳԤʱfalse
+*/
+class DrawBudgetSuite {
+public:
+    DrawBudgetSuite() {
+        warmup_frames_ = 2;
+    }
+
+    void AddScreen(const std::string& name, std::function<void()> update) {
+        screens_.push_back(Screen{ name, std::move(update) });
+    }
+
+    void SetWarmupFrames(int frames) {
+        warmup_frames_ = frames;
+    }
+
+    // л涼ԤʱtrueĿ׷ӵreport
+    bool Run(DrawBudgetChecker& checker, std::string* report = nullptr, ImFontAtlas* atlas = nullptr) {
+        Measure(atlas);
+        bool ok = true;
+        for (auto& result : results_) {
+            ok &= checker.Check(result.first, result.second, report);
+        }
+        return ok;
+    }
+
+    // ԵǰΪµԤ
+    void Accept(DrawBudgetChecker& checker, ImFontAtlas* atlas = nullptr) {
+        Measure(atlas);
+        for (auto& result : results_) {
+            checker.Accept(result.first, result.second);
+        }
+    }
+
+    const std::vector<std::pair<std::string, DrawStats>>& GetResults() {
+        return results_;
+    }
+
+    // ڶHeadlessContextлÿ棬һ֡Render֮ԸcontextΪǰcontextafter_frame
+    void ForEachScreen(const std::function<void(const std::string& name)>& after_frame, ImFontAtlas* atlas = nullptr) {
+        // FrameлǰcontextҪڻ֮ǰȡõ÷context
+        ImGuiContext* last = ImGui::GetCurrentContext();
+        for (auto& screen : screens_) {
+            HeadlessContext context(atlas);
+            for (int i = 0; i <= warmup_frames_; i++) {
+                context.Frame(screen.update);
+            }
+            after_frame(screen.name);
+            ImGui::SetCurrentContext(last);
+        }
+    }
+
+private:
+    struct Screen {
+        std::string name;
+        std::function<void()> update;
+    };
+
+    void Measure(ImFontAtlas* atlas) {
+        results_.clear();
+        ForEachScreen([this](const std::string& screen) {
+            std::vector<ViewportDrawStats> viewports = CollectDrawStats();
+            for (size_t i = 0; i < viewports.size(); i++) {
+                std::string name = i == 0 ? screen : screen + "/" + std::to_string(i);
+                results_.emplace_back(name, viewports[i].stats);
+            }
+        }, atlas);
+    }
+
+private:
+    std::vector<Screen> screens_;
+    std::vector<std::pair<std::string, DrawStats>> results_;
+    int warmup_frames_;
+};
+
+namespace internal {
+static void BeginReferenceWindow(Window& window) {
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(1280.0f, 800.0f), ImGuiCond_Always);
+    window.Begin();
+}
+} // namespace internal
+
+// ο棺󴰿ڡȫչбͶıؼڸ֮֡䱣
+static void AddReferenceScreens(DrawBudgetSuite& suite) {
+    {
+        auto window = std::make_shared<Window>("Large Window");
+        auto lines = std::make_shared<std::vector<Text>>();
+        auto value = std::make_shared<Property<int>>(0);
+        lines->reserve(500);
+        for (int i = 0; i < 500; i++) {
+            lines->emplace_back("row %d value %d", i, *value);
+        }
+        suite.AddScreen("large_window", [window, lines, value]() {
+            internal::BeginReferenceWindow(*window);
+            window->ExpandUpdate([&]() {
+                for (auto& line : *lines) {
+                    line.Begin();
+                    line.End();
+                }
+            });
+            window->End();
+        });
+    }
+    {
+        auto window = std::make_shared<Window>("Tree");
+        auto nodes = std::make_shared<std::vector<TreeNode>>();
+        nodes->reserve(10 + 10 * 10);
+        for (int i = 0; i < 10 + 10 * 10; i++) {
+            nodes->emplace_back("node##" + std::to_string(i));
+        }
+        suite.AddScreen("tree", [window, nodes]() {
+            internal::BeginReferenceWindow(*window);
+            window->ExpandUpdate([&]() {
+                for (int i = 0; i < 10; i++) {
+                    TreeNode& node = (*nodes)[i];
+                    ImGui::SetNextItemOpen(true, ImGuiCond_Always);
+                    node.Begin();
+                    node.ExpandUpdate([&]() {
+                        for (int j = 0; j < 10; j++) {
+                            TreeNode& child = (*nodes)[10 + i * 10 + j];
+                            ImGui::SetNextItemOpen(true, ImGuiCond_Always);
+                            child.Begin();
+                            child.End();
+                        }
+                    });
+                    node.End();
+                }
+            });
+            window->End();
+        });
+    }
+    {
+        auto window = std::make_shared<Window>("List");
+        auto list = std::make_shared<ListBox<>>("##list");
+        std::vector<std::string> items;
+        for (int i = 0; i < 10000; i++) {
+            items.push_back("item " + std::to_string(i));
+        }
+        list->SetList(std::move(items));
+        suite.AddScreen("list_box", [window, list]() {
+            internal::BeginReferenceWindow(*window);
+            window->ExpandUpdate([&]() {
+                list->Begin();
+                list->InsertUpdate([](std::string& item) { return item; });
+                list->End();
+            });
+            window->End();
+        });
+    }
+    {
+        auto window = std::make_shared<Window>("Multiline");
+        std::string text;
+        for (int i = 0; i < 2000; i++) {
+            text += "line " + std::to_string(i) + " of multiline text\n";
+        }
+        auto input = std::make_shared<InputTextMultiline>("##text", text);
+        suite.AddScreen("multiline_text", [window, input]() {
+            internal::BeginReferenceWindow(*window);
+            window->ExpandUpdate([&]() {
+                input->Begin();
+                input->End();
+            });
+            window->End();
+        });
+    }
+}
+
+
+/*
+* դ
+* DX11˵ķʽImDrawDataüΡɫˡ׼alpha
+* ֻУݱ任ǰǷһ£׷GPUȫͬ
+*/
+struct RasterTexture {
+    ImTextureID id;
+    int width;
+    int height;
+    const uint32_t* pixels;
+};
+
+class Rasterizer {
+public:
+    Rasterizer(int width, int height) {
+        width_ = width;
+        height_ = height;
+        pixels_.assign((size_t)width * height, 0);
+    }
+
+    void AddTexture(const RasterTexture& texture) {
+        textures_.push_back(texture);
+    }
+
+    // ӵǰcontextͼҪͼRGBA32
+    void AddFontTexture() {
+        ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+        if (atlas->TexPixelsRGBA32) {
+            AddTexture(RasterTexture{ atlas->TexID, atlas->TexWidth, atlas->TexHeight, (const uint32_t*)atlas->TexPixelsRGBA32 });
+        }
+    }
+
+    void Clear(uint32_t color = 0) {
+        std::fill(pixels_.begin(), pixels_.end(), color);
+    }
+
+    void Draw(ImDrawData* draw_data) {
+        ImVec2 offset = draw_data->DisplayPos;
+        ImVec2 scale = draw_data->FramebufferScale;
+        for (int i = 0; i < draw_data->CmdListsCount; i++) {
+            const ImDrawList* draw_list = draw_data->CmdLists[i];
+            for (int j = 0; j < draw_list->CmdBuffer.Size; j++) {
+                const ImDrawCmd& cmd = draw_list->CmdBuffer[j];
+                if (cmd.UserCallback != nullptr) {
+                    continue;
+                }
+                int clip_x0 = std::max(0, (int)((cmd.ClipRect.x - offset.x) * scale.x));
+                int clip_y0 = std::max(0, (int)((cmd.ClipRect.y - offset.y) * scale.y));
+                int clip_x1 = std::min(width_, (int)((cmd.ClipRect.z - offset.x) * scale.x));
+                int clip_y1 = std::min(height_, (int)((cmd.ClipRect.w - offset.y) * scale.y));
+                if (clip_x1 <= clip_x0 || clip_y1 <= clip_y0) {
+                    continue;
+                }
+                const RasterTexture* texture = FindTexture(cmd.GetTexID());
+                const ImDrawIdx* idx = draw_list->IdxBuffer.Data + cmd.IdxOffset;
+                const ImDrawVert* vtx = draw_list->VtxBuffer.Data + cmd.VtxOffset;
+                for (unsigned int k = 0; k + 2 < cmd.ElemCount; k += 3) {
+                    DrawTriangle(vtx[idx[k]], vtx[idx[k + 1]], vtx[idx[k + 2]], offset, scale, texture, clip_x0, clip_y0, clip_x1, clip_y1);
+                }
+            }
+        }
+    }
+
+    const std::vector<uint32_t>& GetPixels() {
+        return pixels_;
+    }
+
+    size_t CountDifferentPixels(const Rasterizer& other) {
+        if (other.pixels_.size() != pixels_.size()) {
+            return pixels_.size() > other.pixels_.size() ? pixels_.size() : other.pixels_.size();
+        }
+        size_t count = 0;
+        for (size_t i = 0; i < pixels_.size(); i++) {
+            count += pixels_[i] != other.pixels_[i];
+        }
+        return count;
+    }
+
+private:
+    const RasterTexture* FindTexture(ImTextureID id) {
+        for (auto& texture : textures_) {
+            if (texture.id == id) {
+                return &texture;
+            }
+        }
+        return nullptr;
+    }
+
+    static float Edge(const ImVec2& a, const ImVec2& b, float x, float y) {
+        return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+    }
+
+    // 򣬹ߵֻһ
+    static bool IsTopLeft(const ImVec2& a, const ImVec2& b) {
+        return (a.y == b.y && b.x < a.x) || b.y < a.y;
+    }
+
+    static void Unpack(uint32_t color, float out[4]) {
+        for (int i = 0; i < 4; i++) {
+            out[i] = (float)((color >> (i * 8)) & 0xFF) / 255.0f;
+        }
+    }
+
+    void DrawTriangle(const ImDrawVert& v0, const ImDrawVert& v1, const ImDrawVert& v2, const ImVec2& offset, const ImVec2& scale,
+        const RasterTexture* texture, int clip_x0, int clip_y0, int clip_x1, int clip_y1) {
+        ImVec2 p0((v0.pos.x - offset.x) * scale.x, (v0.pos.y - offset.y) * scale.y);
+        ImVec2 p1((v1.pos.x - offset.x) * scale.x, (v1.pos.y - offset.y) * scale.y);
+        ImVec2 p2((v2.pos.x - offset.x) * scale.x, (v2.pos.y - offset.y) * scale.y);
+        float area = Edge(p0, p1, p2.x, p2.y);
+        if (area == 0.0f) {
+            return;
+        }
+        // ͳһΪ˳ʱ(Ļy)
+        const ImDrawVert* verts[3] = { &v0, &v1, &v2 };
+        if (area < 0.0f) {
+            std::swap(p1, p2);
+            std::swap(verts[1], verts[2]);
+            area = -area;
+        }
+        int x0 = std::max(clip_x0, (int)floorf(std::min(p0.x, std::min(p1.x, p2.x))));
+        int y0 = std::max(clip_y0, (int)floorf(std::min(p0.y, std::min(p1.y, p2.y))));
+        int x1 = std::min(clip_x1, (int)ceilf(std::max(p0.x, std::max(p1.x, p2.x))));
+        int y1 = std::min(clip_y1, (int)ceilf(std::max(p0.y, std::max(p1.y, p2.y))));
+        bool top_left0 = IsTopLeft(p1, p2);
+        bool top_left1 = IsTopLeft(p2, p0);
+        bool top_left2 = IsTopLeft(p0, p1);
+        float c0[4], c1[4], c2[4];
+        Unpack(verts[0]->col, c0);
+        Unpack(verts[1]->col, c1);
+        Unpack(verts[2]->col, c2);
+        for (int y = y0; y < y1; y++) {
+            for (int x = x0; x < x1; x++) {
+                float px = x + 0.5f, py = y + 0.5f;
+                float w0 = Edge(p1, p2, px, py);
+                float w1 = Edge(p2, p0, px, py);
+                float w2 = Edge(p0, p1, px, py);
+                if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) {
+                    continue;
+                }
+                if ((w0 == 0.0f && !top_left0) || (w1 == 0.0f && !top_left1) || (w2 == 0.0f && !top_left2)) {
+                    continue;
+                }
+                w0 /= area;
+                w1 /= area;
+                w2 /= area;
+                float src[4];
+                for (int i = 0; i < 4; i++) {
+                    src[i] = c0[i] * w0 + c1[i] * w1 + c2[i] * w2;
+                }
+                if (texture) {
+                    float u = verts[0]->uv.x * w0 + verts[1]->uv.x * w1 + verts[2]->uv.x * w2;
+                    float v = verts[0]->uv.y * w0 + verts[1]->uv.y * w1 + verts[2]->uv.y * w2;
+                    int tx = std::min(texture->width - 1, std::max(0, (int)(u * texture->width)));
+                    int ty = std::min(texture->height - 1, std::max(0, (int)(v * texture->height)));
+                    float texel[4];
+                    Unpack(texture->pixels[(size_t)ty * texture->width + tx], texel);
+                    for (int i = 0; i < 4; i++) {
+                        src[i] *= texel[i];
+                    }
+                }
+                uint32_t& pixel = pixels_[(size_t)y * width_ + x];
+                float dst[4];
+                Unpack(pixel, dst);
+                uint32_t result = 0;
+                for (int i = 0; i < 4; i++) {
+                    float value = i < 3 ? src[i] * src[3] + dst[i] * (1.0f - src[3]) : src[3] + dst[3] * (1.0f - src[3]);
+                    value = std::min(1.0f, std::max(0.0f, value));
+                    result |= (uint32_t)(value * 255.0f + 0.5f) << (i * 8);
+                }
+                pixel = result;
+            }
+        }
+    }
+
+private:
+    int width_;
+    int height_;
+    std::vector<uint32_t> pixels_;
+    std::vector<RasterTexture> textures_;
+};
+
+
+struct CoalesceStats {
+    int draw_lists_before;
+    int draw_lists_after;
+    int draw_cmds_before;
+    int draw_cmds_after;
+    double cpu_time;
+    // Уʱһµ
+    size_t mismatch_pixels;
+};
+
+/*
+* ϲ
+* ImGui::Render֮󡢺RenderDrawData֮ǰProcessǰcontextӿڵĻ
+* ɾϲüΡVtxOffsetͬڵ
+* SetMergeListsͬһӿڵImDrawListƵһϲбУҪ·VtxOffsetʹ細ڵҲܺϲ
+* ϲбɱУһProcessǰЧԶصӿڲϲб
+*/
+class DrawCoalescer {
+public:
+    DrawCoalescer() {
+        merge_lists_ = false;
+        verify_ = false;
+        stats_ = {};
+    }
+
+    void SetMergeLists(bool merge_lists) {
+        merge_lists_ = merge_lists;
+    }
+
+    // УÿӿڹդΣǳֻڲ
+    void SetVerify(bool verify) {
+        verify_ = verify;
+    }
+
+    void Process() {
+        ImGuiContext& g = *GImGui;
+        auto start = std::chrono::steady_clock::now();
+        stats_ = {};
+        double verify_time = 0.0;
+        size_t merged_index = 0;
+        for (int i = 0; i < g.Viewports.Size; i++) {
+            ImDrawData* draw_data = g.Viewports[i]->DrawData;
+            if (draw_data == nullptr || !draw_data->Valid) {
+                continue;
+            }
+            std::unique_ptr<Rasterizer> before;
+            if (verify_) {
+                auto verify_start = std::chrono::steady_clock::now();
+                before = Rasterize(draw_data);
+                verify_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - verify_start).count();
+            }
+            stats_.draw_lists_before += draw_data->CmdListsCount;
+            stats_.draw_cmds_before += CountCmds(draw_data);
+            if (merge_lists_ && draw_data->CmdListsCount > 1 && !HasUserCallback(draw_data)) {
+                if (merged_index == merged_.size()) {
+                    merged_.emplace_back(new ImDrawList(ImGui::GetDrawListSharedData()));
+                }
+                MergeLists(draw_data, merged_[merged_index++].get());
+            }
+            else {
+                for (int j = 0; j < draw_data->CmdListsCount; j++) {
+                    CoalesceList(draw_data->CmdLists[j]);
+                }
+            }
+            stats_.draw_lists_after += draw_data->CmdListsCount;
+            stats_.draw_cmds_after += CountCmds(draw_data);
+            if (before) {
+                auto verify_start = std::chrono::steady_clock::now();
+                stats_.mismatch_pixels += before->CountDifferentPixels(*Rasterize(draw_data));
+                verify_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - verify_start).count();
+            }
+        }
+        stats_.cpu_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() - verify_time;
+    }
+
+    const CoalesceStats& GetStats() {
+        return stats_;
+    }
+
+private:
+    static bool CanMerge(const ImDrawCmd& prev, const ImDrawCmd& cmd) {
+        return prev.UserCallback == nullptr && cmd.UserCallback == nullptr &&
+            prev.GetTexID() == cmd.GetTexID() && prev.VtxOffset == cmd.VtxOffset &&
+            prev.IdxOffset + prev.ElemCount == cmd.IdxOffset &&
+            memcmp(&prev.ClipRect, &cmd.ClipRect, sizeof(ImVec4)) == 0;
+    }
+
+    static int CountCmds(ImDrawData* draw_data) {
+        int count = 0;
+        for (int i = 0; i < draw_data->CmdListsCount; i++) {
+            count += draw_data->CmdLists[i]->CmdBuffer.Size;
+        }
+        return count;
+    }
+
+    static bool HasUserCallback(ImDrawData* draw_data) {
+        for (int i = 0; i < draw_data->CmdListsCount; i++) {
+            const ImDrawList* draw_list = draw_data->CmdLists[i];
+            for (int j = 0; j < draw_list->CmdBuffer.Size; j++) {
+                ImDrawCallback callback = draw_list->CmdBuffer[j].UserCallback;
+                if (callback != nullptr && callback != ImDrawCallback_ResetRenderState) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    static void CoalesceList(ImDrawList* draw_list) {
+        ImVector<ImDrawCmd>& cmds = draw_list->CmdBuffer;
+        int count = 0;
+        for (int i = 0; i < cmds.Size; i++) {
+            const ImDrawCmd& cmd = cmds[i];
+            if (cmd.UserCallback == nullptr && cmd.ElemCount == 0) {
+                continue;
+            }
+            if (count > 0 && CanMerge(cmds[count - 1], cmd)) {
+                cmds[count - 1].ElemCount += cmd.ElemCount;
+                continue;
+            }
+            cmds[count++] = cmd;
+        }
+        cmds.shrink(count);
+    }
+
+    static void MergeLists(ImDrawData* draw_data, ImDrawList* merged) {
+        const unsigned int max_index = sizeof(ImDrawIdx) == 2 ? 0xFFFF : 0xFFFFFFFF;
+        merged->CmdBuffer.resize(0);
+        merged->IdxBuffer.resize(0);
+        merged->VtxBuffer.resize(0);
+        merged->VtxBuffer.reserve(draw_data->TotalVtxCount);
+        merged->IdxBuffer.reserve(draw_data->TotalIdxCount);
+        unsigned int chunk_start = 0;
+        for (int i = 0; i < draw_data->CmdListsCount; i++) {
+            const ImDrawList* draw_list = draw_data->CmdLists[i];
+            unsigned int base = (unsigned int)merged->VtxBuffer.Size;
+            merged->VtxBuffer.resize(merged->VtxBuffer.Size + draw_list->VtxBuffer.Size);
+            memcpy(merged->VtxBuffer.Data + base, draw_list->VtxBuffer.Data, draw_list->VtxBuffer.size_in_bytes());
+            for (int j = 0; j < draw_list->CmdBuffer.Size; j++) {
+                const ImDrawCmd& cmd = draw_list->CmdBuffer[j];
+                if (cmd.UserCallback != nullptr) {
+                    merged->CmdBuffer.push_back(cmd);
+                    continue;
+                }
+                if (cmd.ElemCount == 0) {
+                    continue;
+                }
+                const ImDrawIdx* src = draw_list->IdxBuffer.Data + cmd.IdxOffset;
+                unsigned int cmd_max = 0;
+                for (unsigned int k = 0; k < cmd.ElemCount; k++) {
+                    cmd_max = std::max(cmd_max, (unsigned int)src[k]);
+                }
+                unsigned int vtx_start = base + cmd.VtxOffset;
+                if (vtx_start < chunk_start || vtx_start - chunk_start + cmd_max > max_index) {
+                    chunk_start = vtx_start;
+                }
+                unsigned int rebase = vtx_start - chunk_start;
+                unsigned int idx_offset = (unsigned int)merged->IdxBuffer.Size;
+                merged->IdxBuffer.resize(merged->IdxBuffer.Size + cmd.ElemCount);
+                ImDrawIdx* dst = merged->IdxBuffer.Data + idx_offset;
+                for (unsigned int k = 0; k < cmd.ElemCount; k++) {
+                    dst[k] = (ImDrawIdx)(src[k] + rebase);
+                }
+                ImDrawCmd out = cmd;
+                out.VtxOffset = chunk_start;
+                out.IdxOffset = idx_offset;
+                if (merged->CmdBuffer.Size > 0 && CanMerge(merged->CmdBuffer.back(), out)) {
+                    merged->CmdBuffer.back().ElemCount += out.ElemCount;
+                }
+                else {
+                    merged->CmdBuffer.push_back(out);
+                }
+            }
+        }
+        draw_data->CmdLists.resize(0);
+        draw_data->CmdLists.push_back(merged);
+        draw_data->CmdListsCount = 1;
+    }
+
+    static std::unique_ptr<Rasterizer> Rasterize(ImDrawData* draw_data) {
+        int width = (int)(draw_data->DisplaySize.x * draw_data->FramebufferScale.x);
+        int height = (int)(draw_data->DisplaySize.y * draw_data->FramebufferScale.y);
+        std::unique_ptr<Rasterizer> rasterizer(new Rasterizer(std::max(width, 0), std::max(height, 0)));
+        rasterizer->AddFontTexture();
+        rasterizer->Draw(draw_data);
+        return rasterizer;
+    }
+
+private:
+    bool merge_lists_;
+    bool verify_;
+    std::vector<std::unique_ptr<ImDrawList>> merged_;
+    CoalesceStats stats_;
+};
+
+inline DrawCoalescer*& CurrentDrawCoalescer() {
+    static thread_local DrawCoalescer* coalescer = nullptr;
+    return coalescer;
+}
+
+static void SetDrawCoalescer(DrawCoalescer* coalescer) {
+    CurrentDrawCoalescer() = coalescer;
+}
+
+struct CoalesceCheck {
+    std::string screen;
+    bool merge_lists;
+    CoalesceStats stats;
+};
+
+// ÿοϷֱرպͿSetMergeListsдУDrawCoalescerнmismatch_pixelsӦΪ0
+static std::vector<CoalesceCheck> CheckDrawCoalescer(ImFontAtlas* atlas = nullptr) {
+    DrawBudgetSuite suite;
+    AddReferenceScreens(suite);
+    std::vector<CoalesceCheck> result;
+    for (bool merge_lists : { false, true }) {
+        DrawCoalescer coalescer;
+        coalescer.SetMergeLists(merge_lists);
+        coalescer.SetVerify(true);
+        suite.ForEachScreen([&](const std::string& name) {
+            coalescer.Process();
+            result.push_back(CoalesceCheck{ name, merge_lists, coalescer.GetStats() });
+        }, atlas);
+    }
+    return result;
+}
+
+
+struct CullStats {
+    size_t frames;
+    size_t skipped_frames;
+    size_t triangles;
+    size_t culled_triangles;
+    size_t saved_vtx_bytes;
+    size_t saved_idx_bytes;
+    double cpu_time;
+};
+
+/*
+* ü޳
+* ImGui::Render֮ɾȫλClipRect֮Σѹ
+* ޳ʵmin_cull_rateʱ֮skip_frames֡Ȼ²
+*/
+class ClipCuller {
+public:
+    ClipCuller() {
+        min_cull_rate_ = 0.05f;
+        skip_frames_ = 30;
+        skip_remaining_ = 0;
+        stats_ = {};
+        last_ = {};
+    }
+
+    void SetAdaptive(float min_cull_rate, int skip_frames) {
+        min_cull_rate_ = min_cull_rate;
+        skip_frames_ = skip_frames;
+    }
+
+    void Process() {
+        stats_.frames++;
+        if (skip_remaining_ > 0) {
+            skip_remaining_--;
+            stats_.skipped_frames++;
+            last_ = {};
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        CullStats frame = {};
+        ImGuiContext& g = *GImGui;
+        for (int i = 0; i < g.Viewports.Size; i++) {
+            ImDrawData* draw_data = g.Viewports[i]->DrawData;
+            if (draw_data == nullptr || !draw_data->Valid) {
+                continue;
+            }
+            int total_vtx = 0;
+            int total_idx = 0;
+            for (int j = 0; j < draw_data->CmdListsCount; j++) {
+                ImDrawList* draw_list = draw_data->CmdLists[j];
+                CullList(draw_list, frame);
+                total_vtx += draw_list->VtxBuffer.Size;
+                total_idx += draw_list->IdxBuffer.Size;
+            }
+            draw_data->TotalVtxCount = total_vtx;
+            draw_data->TotalIdxCount = total_idx;
+        }
+        frame.cpu_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        last_ = frame;
+        stats_.triangles += frame.triangles;
+        stats_.culled_triangles += frame.culled_triangles;
+        stats_.saved_vtx_bytes += frame.saved_vtx_bytes;
+        stats_.saved_idx_bytes += frame.saved_idx_bytes;
+        stats_.cpu_time += frame.cpu_time;
+        if (frame.triangles > 0 && (float)frame.culled_triangles < (float)frame.triangles * min_cull_rate_) {
+            skip_remaining_ = skip_frames_;
+        }
+    }
+
+    // ۼͳ
+    const CullStats& GetStats() {
+        return stats_;
+    }
+
+    // һ֡ͳƣ֡ȫΪ0
+    const CullStats& GetLastFrameStats() {
+        return last_;
+    }
+
+private:
+    // ε㶼ڲüͬһߵʱ޳clipСѾȡ
+    static bool IsCulled(const ImVec2& p0, const ImVec2& p1, const ImVec2& p2, const ImVec4& clip) {
+        return (p0.x < clip.x && p1.x < clip.x && p2.x < clip.x) ||
+            (p0.y < clip.y && p1.y < clip.y && p2.y < clip.y) ||
+            (p0.x > clip.z && p1.x > clip.z && p2.x > clip.z) ||
+            (p0.y > clip.w && p1.y > clip.w && p2.y > clip.w);
+    }
+
+    void CullList(ImDrawList* draw_list, CullStats& frame) {
+        ImVector<ImDrawCmd>& cmds = draw_list->CmdBuffer;
+        ImDrawIdx* idx = draw_list->IdxBuffer.Data;
+        const ImDrawVert* vtx = draw_list->VtxBuffer.Data;
+        int vtx_count = draw_list->VtxBuffer.Size;
+        used_.assign(vtx_count, 0);
+
+        // ԭѹдλòᳬȡλ
+        unsigned int write = 0;
+        int cmd_count = 0;
+        bool culled_any = false;
+        for (int i = 0; i < cmds.Size; i++) {
+            ImDrawCmd cmd = cmds[i];
+            if (cmd.UserCallback != nullptr) {
+                cmds[cmd_count++] = cmd;
+                continue;
+            }
+            const ImDrawVert* base = vtx + cmd.VtxOffset;
+            const ImDrawIdx* src = idx + cmd.IdxOffset;
+            unsigned int out = write;
+            unsigned int triangle_count = cmd.ElemCount / 3;
+            frame.triangles += triangle_count;
+            // ˰ѲüνضΪСڵ()Ȼɼȡı߱Ƚ
+            ImVec4 clip_rect(floorf(cmd.ClipRect.x), floorf(cmd.ClipRect.y), cmd.ClipRect.z, cmd.ClipRect.w);
+#ifdef IMGUI_EX_SSE2
+            // ÿΪ(x, y, -x, -y)ȡֵ(x0, y0, -x1, -y1)ȽϣһСȫ
+            const __m128 sign = _mm_castsi128_ps(_mm_set_epi32((int)0x80000000, (int)0x80000000, 0, 0));
+            const __m128 clip = _mm_xor_ps(_mm_set_ps(clip_rect.w, clip_rect.z, clip_rect.y, clip_rect.x), sign);
+#endif
+            for (unsigned int t = 0; t < triangle_count; t++) {
+                ImDrawIdx i0 = src[t * 3 + 0];
+                ImDrawIdx i1 = src[t * 3 + 1];
+                ImDrawIdx i2 = src[t * 3 + 2];
+#ifdef IMGUI_EX_SSE2
+                __m128 p0 = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&base[i0].pos);
+                __m128 p1 = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&base[i1].pos);
+                __m128 p2 = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&base[i2].pos);
+                p0 = _mm_xor_ps(_mm_movelh_ps(p0, p0), sign);
+                p1 = _mm_xor_ps(_mm_movelh_ps(p1, p1), sign);
+                p2 = _mm_xor_ps(_mm_movelh_ps(p2, p2), sign);
+                __m128 extent = _mm_max_ps(_mm_max_ps(p0, p1), p2);
+                bool culled = _mm_movemask_ps(_mm_cmplt_ps(extent, clip)) != 0;
+#else
+                bool culled = IsCulled(base[i0].pos, base[i1].pos, base[i2].pos, clip_rect);
+#endif
+                if (culled) {
+                    frame.culled_triangles++;
+                    culled_any = true;
+                    continue;
+                }
+                idx[out + 0] = i0;
+                idx[out + 1] = i1;
+                idx[out + 2] = i2;
+                out += 3;
+                used_[cmd.VtxOffset + i0] = 1;
+                used_[cmd.VtxOffset + i1] = 1;
+                used_[cmd.VtxOffset + i2] = 1;
+            }
+            if (out == write) {
+                continue;
+            }
+            cmd.IdxOffset = write;
+            cmd.ElemCount = out - write;
+            write = out;
+            cmds[cmd_count++] = cmd;
+        }
+        cmds.shrink(cmd_count);
+        if (!culled_any) {
+            return;
+        }
+        frame.saved_idx_bytes += (draw_list->IdxBuffer.Size - write) * sizeof(ImDrawIdx);
+        draw_list->IdxBuffer.shrink(write);
+
+        // ѹremapضλᳬԭ
+        remap_.resize(vtx_count + 1);
+        unsigned int kept = 0;
+        for (int i = 0; i < vtx_count; i++) {
+            remap_[i] = kept;
+            if (used_[i]) {
+                draw_list->VtxBuffer.Data[kept++] = vtx[i];
+            }
+        }
+        remap_[vtx_count] = kept;
+        for (int i = 0; i < cmds.Size; i++) {
+            ImDrawCmd& cmd = cmds[i];
+            if (cmd.UserCallback != nullptr) {
+                continue;
+            }
+            unsigned int vtx_offset = remap_[cmd.VtxOffset];
+            ImDrawIdx* dst = idx + cmd.IdxOffset;
+            for (unsigned int k = 0; k < cmd.ElemCount; k++) {
+                dst[k] = (ImDrawIdx)(remap_[cmd.VtxOffset + dst[k]] - vtx_offset);
+            }
+            cmd.VtxOffset = vtx_offset;
+        }
+        frame.saved_vtx_bytes += (vtx_count - kept) * sizeof(ImDrawVert);
+        draw_list->VtxBuffer.shrink(kept);
+    }
+
+private:
+    float min_cull_rate_;
+    int skip_frames_;
+    int skip_remaining_;
+
+    std::vector<uint8_t> used_;
+    std::vector<unsigned int> remap_;
+
+    CullStats stats_;
+    CullStats last_;
+};
+
+inline ClipCuller*& CurrentClipCuller() {
+    static thread_local ClipCuller* culler = nullptr;
+    return culler;
+}
+
+static void SetClipCuller(ClipCuller* culler) {
+    CurrentClipCuller() = culler;
+}
+
+
+namespace internal {
+// ¼ļе¼ImGuiInputEventİ汾޹
+struct RecordEvent {
+    enum Type : uint8_t {
+        kMousePos,
+        kMouseWheel,
+        kMouseButton,
+        kKey,
+        kText,
+        kFocus,
+    };
+    uint8_t type;
+    uint8_t down;
+    uint16_t reserved;
+    int32_t code;
+    float x;
+    float y;
+};
+
+struct RecordFrame {
+    float delta_time;
+    float display_width;
+    float display_height;
+    uint32_t event_count;
+};
+
+static constexpr char kRecordMagic[8] = { 'I', 'M', 'G', 'U', 'I', 'E', 'X', 'R' };
+static constexpr uint32_t kRecordVersion = 1;
+
+// ImGui¼תΪ汾޹صRecordEvent޷תʱfalse
+static bool ToRecordEvent(const ImGuiInputEvent& event, RecordEvent* record) {
+    *record = {};
+    switch (event.Type) {
+    case ImGuiInputEventType_MousePos:
+        record->type = RecordEvent::kMousePos;
+        record->x = event.MousePos.PosX;
+        record->y = event.MousePos.PosY;
+        break;
+    case ImGuiInputEventType_MouseWheel:
+        record->type = RecordEvent::kMouseWheel;
+        record->x = event.MouseWheel.WheelX;
+        record->y = event.MouseWheel.WheelY;
+        break;
+    case ImGuiInputEventType_MouseButton:
+        record->type = RecordEvent::kMouseButton;
+        record->code = event.MouseButton.Button;
+        record->down = event.MouseButton.Down;
+        break;
+    case ImGuiInputEventType_Key:
+        record->type = RecordEvent::kKey;
+        record->code = event.Key.Key;
+        record->down = event.Key.Down;
+        record->x = event.Key.AnalogValue;
+        break;
+    case ImGuiInputEventType_Text:
+        record->type = RecordEvent::kText;
+        record->code = (int32_t)event.Text.Char;
+        break;
+    case ImGuiInputEventType_Focus:
+        record->type = RecordEvent::kFocus;
+        record->down = event.AppFocused.Focused;
+        break;
+    default:
+        // ӿͣƽ̨¼޷޴ڻط
+        return false;
+    }
+    return true;
+}
+
+static void DispatchRecordEvent(ImGuiIO& io, const RecordEvent& record) {
+    switch (record.type) {
+    case RecordEvent::kMousePos:
+        io.AddMousePosEvent(record.x, record.y);
+        break;
+    case RecordEvent::kMouseWheel:
+        io.AddMouseWheelEvent(record.x, record.y);
+        break;
+    case RecordEvent::kMouseButton:
+        io.AddMouseButtonEvent(record.code, record.down != 0);
+        break;
+    case RecordEvent::kKey:
+        io.AddKeyAnalogEvent((ImGuiKey)record.code, record.down != 0, record.x);
+        break;
+    case RecordEvent::kText:
+        io.AddInputCharacter((unsigned int)record.code);
+        break;
+    case RecordEvent::kFocus:
+        io.AddFocusEvent(record.down != 0);
+        break;
+    }
+}
+
+} // namespace internal
+
+/*
+* ¼
+* ѭںNewFrame֮ImGui::NewFrame֮ǰRecord汾֡¼ԼDeltaTimeDisplaySize
+* δ¼ڶеһ֡EventIdֻ¼¼
+*/
+class InputRecorder {
+public:
+    InputRecorder() {
+        last_event_id_ = 0;
+        frame_count_ = 0;
+    }
+
+    ~InputRecorder() {
+        Close();
+    }
+
+    bool Open(const std::string& path) {
+        Close();
+        file_.open(path, std::ios::binary | std::ios::trunc);
+        if (!file_) {
+            return false;
+        }
+        file_.write(internal::kRecordMagic, sizeof(internal::kRecordMagic));
+        file_.write((const char*)&internal::kRecordVersion, sizeof(internal::kRecordVersion));
+        last_event_id_ = 0;
+        frame_count_ = 0;
+        return true;
+    }
+
+    void Close() {
+        if (file_.is_open()) {
+            Flush();
+            file_.close();
         }
-        end_expand_ = expand_;
-        end_select_index_ = select_index_;
-        Widget::End();
     }
 
-    /*
-    * Update
-    */
-    void InsertUpdate(std::function<std::string(Element&)> insert) {
-        if (expand_ == false) {
+    bool IsOpen() {
+        return file_.is_open();
+    }
+
+    void Record() {
+        if (!file_.is_open()) {
             return;
         }
-        for (int i = 0; i < list_.size(); i++) {
-            const bool is_selected = (select_index_ == i);
-            auto temp = insert(list_[i]);
-
-            if (temp.empty()) {
+        ImGuiContext& g = *GImGui;
+        ImGuiIO& io = g.IO;
+        events_.clear();
+        for (int i = 0; i < g.InputEventsQueue.Size; i++) {
+            const ImGuiInputEvent& event = g.InputEventsQueue[i];
+            if (event.EventId <= last_event_id_) {
                 continue;
             }
-
-            if (ImGui::Selectable(temp.c_str(), is_selected)) {
-                select_index_ = i;
-                select_label_ = temp;
-            }
-
-            if (is_selected) {
-                ImGui::SetItemDefaultFocus();
+            last_event_id_ = event.EventId;
+            internal::RecordEvent record;
+            if (!internal::ToRecordEvent(event, &record)) {
+                continue;
             }
+            events_.push_back(record);
         }
-        
-    }
-
-    /*
-    * Event
-    */
-    void SelectEvent(std::function<void()> event) {
-        if (end_select_index_ != select_index_) {
-            event();
+        internal::RecordFrame frame;
+        frame.delta_time = io.DeltaTime;
+        frame.display_width = io.DisplaySize.x;
+        frame.display_height = io.DisplaySize.y;
+        frame.event_count = (uint32_t)events_.size();
+        writer_.Write(frame);
+        for (auto& record : events_) {
+            writer_.Write(record);
+        }
+        frame_count_++;
+        if (writer_.GetBuffer().size() >= 64 * 1024) {
+            Flush();
         }
     }
 
-
-    /*
-    * Control
-    */
-    Element& GetSelectItem() {
-        return list_.at(select_index_);
+    size_t GetFrameCount() {
+        return frame_count_;
     }
 
-    int GetSelectIndex() {
-        return select_index_;
+private:
+    void Flush() {
+        std::string& buffer = writer_.GetBuffer();
+        file_.write(buffer.data(), buffer.size());
+        file_.flush();
+        buffer.clear();
     }
 
-    int SetSelectIndex(int select_index) {
-        select_index_ = select_index;
-    }
+private:
+    std::ofstream file_;
+    internal::SnapshotWriter writer_;
+    std::vector<internal::RecordEvent> events_;
+    unsigned int last_event_id_;
+    size_t frame_count_;
+};
 
-    void SetList(std::vector<Element>&& list) {
-        list_ = std::move(list);
-    }
+inline InputRecorder*& CurrentInputRecorder() {
+    static thread_local InputRecorder* recorder = nullptr;
+    return recorder;
+}
 
-    std::vector<Element>& GetList() {
-        return list_;
+static void SetInputRecorder(InputRecorder* recorder) {
+    CurrentInputRecorder() = recorder;
+}
+
+
+namespace internal {
+// ͳImGuiĵãuser_dataָб汻滻ķ亯
+struct ImGuiAllocCounter {
+    ImGuiMemAllocFunc alloc;
+    ImGuiMemFreeFunc free;
+    void* user_data;
+    size_t count;
+    size_t bytes;
+
+    static void* Alloc(size_t size, void* user_data) {
+        ImGuiAllocCounter* counter = (ImGuiAllocCounter*)user_data;
+        counter->count++;
+        counter->bytes += size;
+        return counter->alloc(size, counter->user_data);
     }
 
-    void ClearList() {
-        list_.clear();
+    static void Free(void* ptr, void* user_data) {
+        ImGuiAllocCounter* counter = (ImGuiAllocCounter*)user_data;
+        counter->free(ptr, counter->user_data);
     }
+};
 
-private:
-    std::vector<Element> list_;
-    int end_select_index_;
-    int select_index_;
-    std::string select_label_;
+// ȫoperator newĵôֻIMGUI_EX_COUNT_NEWʱimgui_ex_win32.cppŻ滻operator new
+inline std::atomic<size_t>& NewCount() {
+    static std::atomic<size_t> count(0);
+    return count;
+}
+} // namespace internal
 
+struct ReplayFrameStats {
+    double cpu_time;
+    size_t alloc_count;
+    size_t alloc_bytes;
+    DrawStats draw;
 };
 
-class InputText : public Widget {
+/*
+* ط
+* HeadlessContextа¼Ƶ¼DeltaTime֡ͬһupdatereal_timeΪfalseʱȴȫ
+* after_renderÿ֡ImGui::Render֮(ClipCuller::Process)ʱͷ䲻֡ͳ
+* ͳƵImGuiطڼ滻ȫֵImGui亯
+* ֻûHostHeadlessContextʱ(絥ܲԽ)Runֱӷؿս
+*/
+class InputReplay {
 public:
-    InputText(const std::string& label, size_t text_size) : Widget(label), text_(text_size, '\0') {
-        end_input_ = false;
-        input_ = false;
+    InputReplay() {
     }
 
-    void Begin() {
-        Widget::Begin();
-        if (ImGui::InputText(GetLabel().c_str(), (char*)text_.c_str(), text_.size())) {
-            input_ = true;
-        } else {
-            input_ = false;
+    bool Load(const std::string& path) {
+        frames_.clear();
+        events_.clear();
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        internal::SnapshotReader reader(data.data(), data.size());
+        char magic[sizeof(internal::kRecordMagic)];
+        uint32_t version;
+        if (!reader.Read(magic) || memcmp(magic, internal::kRecordMagic, sizeof(magic)) != 0 ||
+            !reader.Read(version) || version != internal::kRecordVersion) {
+            return false;
         }
+        internal::RecordFrame frame;
+        while (reader.Read(frame)) {
+            Frame item;
+            item.frame = frame;
+            item.first_event = events_.size();
+            for (uint32_t i = 0; i < frame.event_count; i++) {
+                internal::RecordEvent record;
+                if (!reader.Read(record)) {
+                    // ļĩβ֡(¼ж)
+                    events_.resize(item.first_event);
+                    return true;
+                }
+                events_.push_back(record);
+            }
+            frames_.push_back(item);
+        }
+        return true;
     }
 
-    void End() {
-        end_input_ = input_;
-        Widget::End();
+    size_t GetFrameCount() {
+        return frames_.size();
     }
 
-    /*
-    * Event
-    */
-    void InputEvent(std::function<void()> event) {
-        if (input_ == true && input_ != end_input_) {
-            event();
+    std::vector<ReplayFrameStats> Run(HeadlessContext& context, const std::function<void()>& update, bool real_time = false,
+        const std::function<void()>& after_render = nullptr) {
+        std::vector<ReplayFrameStats> stats;
+        if (internal::ContextCount() > 1) {
+            return stats;
         }
-    }
+        stats.reserve(frames_.size());
+
+        internal::ImGuiAllocCounter counter = {};
+        ImGui::GetAllocatorFunctions(&counter.alloc, &counter.free, &counter.user_data);
+        ImGui::SetAllocatorFunctions(&internal::ImGuiAllocCounter::Alloc, &internal::ImGuiAllocCounter::Free, &counter);
+
+        ImGuiContext* last = ImGui::GetCurrentContext();
+        ImGui::SetCurrentContext(context.GetContext());
+        auto deadline = std::chrono::steady_clock::now();
+        for (auto& item : frames_) {
+            ImGuiIO& io = ImGui::GetIO();
+            io.DisplaySize = ImVec2(item.frame.display_width, item.frame.display_height);
+            for (uint32_t i = 0; i < item.frame.event_count; i++) {
+                internal::DispatchRecordEvent(io, events_[item.first_event + i]);
+            }
 
-    std::string GetText() {
-        return std::string(text_.c_str(), strlen(text_.c_str()));
-    }
+            counter.count = 0;
+            counter.bytes = 0;
+            auto start = std::chrono::steady_clock::now();
+            ImDrawData* draw_data = context.Frame(update, item.frame.delta_time > 0.0f ? item.frame.delta_time : 1.0f / 60.0f);
+            auto end = std::chrono::steady_clock::now();
+
+            ReplayFrameStats frame_stats = {};
+            frame_stats.cpu_time = std::chrono::duration<double>(end - start).count();
+            frame_stats.alloc_count = counter.count;
+            frame_stats.alloc_bytes = counter.bytes;
+            if (after_render) {
+                after_render();
+            }
+            frame_stats.draw = CountDrawData(draw_data);
+            stats.push_back(frame_stats);
 
-    void SetText(const std::string& text) {
-        memcpy((void*)text_.c_str(), text.c_str(), (text_.size() < text.size() ? text_.size() : text.size()));
+            if (real_time) {
+                deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(item.frame.delta_time));
+                std::this_thread::sleep_until(deadline);
+            }
+        }
+        if (last != nullptr) {
+            ImGui::SetCurrentContext(last);
+        }
+
+        ImGui::SetAllocatorFunctions(counter.alloc, counter.free, counter.user_data);
+        return stats;
     }
 
 private:
-    std::string text_;
+    struct Frame {
+        internal::RecordFrame frame;
+        size_t first_event;
+    };
 
-    bool end_input_;
-    bool input_;
+private:
+    std::vector<Frame> frames_;
+    std::vector<internal::RecordEvent> events_;
 };
 
-class InputTextMultiline : public Widget {
-public:
-    InputTextMultiline(const std::string& label, const std::string& text = "", ImGuiInputTextFlags flags = 0) : Widget(label), size_(-FLT_MIN, -FLT_MIN) {
-        end_input_ = false;
-        input_ = false;
-
-        flags_ = flags | ImGuiInputTextFlags_CallbackResize;
-        SetText(text);
+/*
+* ϳɻϵĲü޳лrow_countоκıǴڸ߶ȵ󲿷λڲü֮
+* Ӧرգÿִ֡޳
+*/
+static CullStats BenchmarkClipCuller(int row_count, int frame_count) {
+    ImFontAtlas atlas;
+    atlas.AddFontDefault();
+    unsigned char* pixels;
+    int width, height;
+    atlas.GetTexDataAsRGBA32(&pixels, &width, &height);
+    atlas.SetTexID((ImTextureID)(intptr_t)1);
+
+    HeadlessContext context(&atlas);
+    ClipCuller culler;
+    culler.SetAdaptive(0.0f, 0);
+    for (int frame = 0; frame < frame_count; frame++) {
+        context.Frame([&]() {
+            ImGui::SetNextWindowPos(ImVec2(100.0f, 100.0f), ImGuiCond_Always);
+            ImGui::SetNextWindowSize(ImVec2(400.0f, 300.0f), ImGuiCond_Always);
+            ImGui::Begin("Culling");
+            ImDrawList* draw_list = ImGui::GetWindowDrawList();
+            ImVec2 origin = ImGui::GetCursorScreenPos();
+            for (int row = 0; row < row_count; row++) {
+                // еλ֡ƶǲü߽ǡС߽ϵ
+                float y = origin.y - 600.0f + (float)((row * 7 + frame) % 2000) * 0.75f;
+                float x = origin.x - 200.0f + (float)((row * 13) % 800) + 0.5f;
+                draw_list->AddRectFilled(ImVec2(x, y), ImVec2(x + 40.0f, y + 8.0f), IM_COL32(80, 160, 240, 255));
+                draw_list->AddText(ImVec2(x, y), IM_COL32(255, 255, 255, 255), "cull");
+            }
+            ImGui::End();
+        });
+        culler.Process();
     }
+    return culler.GetStats();
+}
 
-    void Begin() {
-        if (text_.empty()) {
-            text_.push_back('\0');
-        }
-        Widget::Begin();
-        if (ImGui::InputTextMultiline(GetLabel().c_str(), text_.begin(), text_.size(), size_, flags_, ResizeCallback, &text_)) {
-            input_ = true;
-        }
-        else {
-            input_ = false;
+// ¼ƻϵĲü޳طreplayͬʱÿ֡Renderִ֮޳طInputReplay::Runͬ
+static CullStats BenchmarkClipCullerReplay(InputReplay& replay, HeadlessContext& context, const std::function<void()>& update) {
+    ClipCuller culler;
+    culler.SetAdaptive(0.0f, 0);
+    replay.Run(context, update, false, [&culler]() { culler.Process(); });
+    return culler.GetStats();
+}
+
+struct WidgetPoolAllocations {
+    // Ԥ֮֡ĺϼ
+    size_t imgui_alloc_count;
+    size_t new_count;
+    // δIMGUI_EX_COUNT_NEWʱͳoperator newnew_countΪ0
+    bool new_counted;
+    size_t create_count;
+    size_t evict_count;
+    double frame_ms;
+};
+
+/*
+* HeadlessContextͨWidgetPoolrow_countаťÿ֡churn_per_frameУµkeyؼĿؼں
+* Reserve֮󾭹һԤȣλĹѳ֣ͳframe_count֡ImGuiȫoperator newĵô߶ӦΪ0
+* ǩ϶̣std::stringڶϷ䣻InputReplay::Runһ滻ȫֵImGui亯ʱؿս
+*/
+static WidgetPoolAllocations BenchmarkWidgetPool(int row_count = 10000, int frame_count = 120, int churn_per_frame = 100) {
+    WidgetPoolAllocations result = {};
+    if (internal::ContextCount() > 0) {
+        return result;
+    }
+    ImFontAtlas atlas;
+    atlas.AddFontDefault();
+    unsigned char* pixels;
+    int width, height;
+    atlas.GetTexDataAsRGBA32(&pixels, &width, &height);
+    atlas.SetTexID((ImTextureID)(intptr_t)1);
+
+    HeadlessContext context(&atlas);
+    const uint64_t evict_frames = 2;
+    WidgetPool pool;
+    pool.SetEvictFrames(evict_frames);
+    pool.Reserve<Button>(row_count + churn_per_frame * (evict_frames + 2));
+
+    uint64_t first = 0;
+    char label[32];
+    std::function<void()> update = [&]() {
+        ImGui::Begin("Pool");
+        for (int i = 0; i < row_count; i++) {
+            uint64_t key = first + i;
+            snprintf(label, sizeof(label), "Row %llu", (unsigned long long)key);
+            Button& button = pool.Get<Button>(key, label);
+            button.Begin();
+            button.End();
         }
+        ImGui::End();
+        pool.Update();
+        first += churn_per_frame;
+    };
+    for (uint64_t i = 0; i < evict_frames + 4; i++) {
+        context.Frame(update);
     }
 
-    void End() {
-        end_input_ = input_;
-        Widget::End();
+    internal::ImGuiAllocCounter counter = {};
+    ImGui::GetAllocatorFunctions(&counter.alloc, &counter.free, &counter.user_data);
+    ImGui::SetAllocatorFunctions(&internal::ImGuiAllocCounter::Alloc, &internal::ImGuiAllocCounter::Free, &counter);
+    size_t create_count = pool.GetCreateCount();
+    size_t evict_count = pool.GetEvictCount();
+    size_t new_count = internal::NewCount();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frame_count; i++) {
+        context.Frame(update);
     }
+    result.frame_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / std::max(1, frame_count);
+    result.new_count = internal::NewCount() - new_count;
+    ImGui::SetAllocatorFunctions(counter.alloc, counter.free, counter.user_data);
+
+    result.imgui_alloc_count = counter.count;
+#ifdef IMGUI_EX_COUNT_NEW
+    result.new_counted = true;
+#else
+    result.new_counted = false;
+#endif
+    result.create_count = pool.GetCreateCount() - create_count;
+    result.evict_count = pool.GetEvictCount() - evict_count;
+    return result;
+}
 
-    /*
-    * Event
-    */
-    void InputEvent(std::function<void()> event) {
-        if (input_ == true && input_ != end_input_) {
-            event();
-        }
-    }
 
-    std::string GetText() {
-        return std::string(&text_[0], strlen(&text_[0]));
+namespace internal {
+// ɶдڴ棬ɷ˴鿴˴
+class SharedMemory {
+public:
+    SharedMemory() {
+        mapping_ = NULL;
+        data_ = nullptr;
+        size_ = 0;
     }
 
-    void SetText(const std::string& text) {
-        text_.clear();
-        text_.resize(text.size() + 1);
-        memcpy(&text_[0], &text[0], text.size() + 1);
+    ~SharedMemory() {
+        Close();
     }
 
-    void SetSize(const ImVec2& size) {
-        size_ = size;
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    bool Create(const std::string& name, uint64_t size) {
+        Close();
+        mapping_ = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD)size, name.c_str());
+        if (mapping_ == NULL) {
+            return false;
+        }
+        return Map(size);
     }
 
-    ImVec2& GetSize() {
-        return size_;
+    bool Open(const std::string& name, uint64_t size) {
+        Close();
+        mapping_ = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+        if (mapping_ == NULL) {
+            return false;
+        }
+        return Map(size);
     }
 
-    void SetReadOnly(bool enable) {
-        if (enable) {
-            flags_ |= ImGuiInputTextFlags_ReadOnly;
+    void Close() {
+        if (data_) {
+            UnmapViewOfFile(data_);
+            data_ = nullptr;
         }
-        else {
-            flags_ &= (~ImGuiInputTextFlags_ReadOnly);
+        if (mapping_) {
+            CloseHandle(mapping_);
+            mapping_ = NULL;
         }
+        size_ = 0;
+    }
+
+    char* GetData() {
+        return data_;
+    }
+
+    uint64_t GetSize() {
+        return size_;
     }
 
 private:
-    static int ResizeCallback(ImGuiInputTextCallbackData* data) {
-        if (data->EventFlag == ImGuiInputTextFlags_CallbackResize) {
-            ImVector<char>* my_str = (ImVector<char>*)data->UserData;
-            IM_ASSERT(my_str->begin() == data->Buf);
-            my_str->resize(data->BufSize); // NB: On resizing calls, generally data->BufSize == data->BufTextLen + 1
-            data->Buf = my_str->begin();
+    bool Map(uint64_t size) {
+        data_ = (char*)MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, (size_t)size);
+        if (data_ == nullptr) {
+            Close();
+            return false;
         }
-        return 0;
+        size_ = size;
+        return true;
     }
 
 private:
-    ImVector<char> text_;
+    HANDLE mapping_;
+    char* data_;
+    uint64_t size_;
+};
 
-    bool end_input_;
-    bool input_;
+/*
+* λڹڴеĵߵ߻λ
+* ϢΪ[uint32 size][uint32 type][payload]8ֽڶ룬βŲʱдϢ
+* дλõʱдʧܶǸǣɵ÷
+*/
+class SharedRing {
+public:
+    struct Header {
+        std::atomic<uint64_t> write_pos;
+        std::atomic<uint64_t> read_pos;
+    };
 
-    ImVec2 size_;
+    static constexpr uint32_t kPadding = 0xFFFFFFFF;
 
-    ImGuiInputTextFlags flags_;
-};
+    SharedRing() {
+        header_ = nullptr;
+        data_ = nullptr;
+        capacity_ = 0;
+    }
 
-class Text : public Widget {
-public:
-    template<typename ... Args>
-    Text(const char* fmt, Args... args) : Widget(fmt) {
-        
+    static uint64_t GetBytes(uint64_t capacity) {
+        return sizeof(Header) + capacity;
     }
 
-    void Begin() {
-        Widget::Begin();
-        ImGui::Text(GetLabel().c_str());
+    // capacityΪ8ıinitΪtrueʱʼͷ
+    void Attach(char* memory, uint64_t capacity, bool init) {
+        header_ = (Header*)memory;
+        data_ = memory + sizeof(Header);
+        capacity_ = capacity;
+        if (init) {
+            new (&header_->write_pos) std::atomic<uint64_t>(0);
+            new (&header_->read_pos) std::atomic<uint64_t>(0);
+        }
     }
 
-    void End() {
-        Widget::End();
+    bool Write(uint32_t type, const void* data, uint32_t size) {
+        uint64_t need = Align(8 + (uint64_t)size);
+        uint64_t write = header_->write_pos.load(std::memory_order_relaxed);
+        uint64_t read = header_->read_pos.load(std::memory_order_acquire);
+        uint64_t offset = write % capacity_;
+        uint64_t tail = capacity_ - offset;
+        uint64_t total = tail < need ? need + tail : need;
+        if (write + total - read > capacity_) {
+            return false;
+        }
+        if (tail < need) {
+            uint32_t* padding = (uint32_t*)(data_ + offset);
+            padding[0] = (uint32_t)(tail - 8);
+            padding[1] = kPadding;
+            write += tail;
+            offset = 0;
+        }
+        uint32_t* head = (uint32_t*)(data_ + offset);
+        head[0] = size;
+        head[1] = type;
+        memcpy(data_ + offset + 8, data, size);
+        header_->write_pos.store(write + need, std::memory_order_release);
+        return true;
     }
 
+    bool Read(uint32_t* type, std::vector<char>* payload) {
+        for (;;) {
+            uint64_t read = header_->read_pos.load(std::memory_order_relaxed);
+            uint64_t write = header_->write_pos.load(std::memory_order_acquire);
+            if (read == write) {
+                return false;
+            }
+            uint64_t offset = read % capacity_;
+            const uint32_t* head = (const uint32_t*)(data_ + offset);
+            uint32_t size = head[0];
+            uint32_t message_type = head[1];
+            if (message_type != kPadding) {
+                payload->assign(data_ + offset + 8, data_ + offset + 8 + size);
+                *type = message_type;
+            }
+            header_->read_pos.store(read + Align(8 + (uint64_t)size), std::memory_order_release);
+            if (message_type != kPadding) {
+                return true;
+            }
+        }
+    }
 
-    std::string GetText() {
-        return GetLabel();
+    uint64_t GetCapacity() {
+        return capacity_;
     }
 
-    void SetText(const std::string& text) {
-        return SetLabel(text);
+private:
+    static uint64_t Align(uint64_t size) {
+        return (size + 7) & ~(uint64_t)7;
     }
 
 private:
-    std::string text_;
+    Header* header_;
+    char* data_;
+    uint64_t capacity_;
 };
 
-class SeparatorText : public Widget {
-public:
-    SeparatorText(const std::string& label) : Widget(label) {
-        
-    }
+static int64_t RemoteTimestamp() {
+    // steady_clockWindowsϻQPCԿ̱Ƚ
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
-    void Begin() {
-        Widget::Begin();
-        ImGui::SeparatorText(GetLabel().c_str());
-    }
+struct RemoteControl {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t frame_capacity;
+    uint64_t input_capacity;
+    std::atomic<uint32_t> resync;
+    uint32_t padding;
+};
 
-    void End() {
-        Widget::End();
-    }
+enum RemoteMessage : uint32_t {
+    kRemoteFrame,
+    kRemoteAtlas,
+    kRemoteInput,
+    kRemoteDisplaySize,
 };
 
-class BulletText : public Widget {
-public:
-    template<typename ... Args>
-    BulletText(const char* fmt, Args... args) : Widget(fmt) {
-        ImGui:;BulletText(fmt, args...);
-    }
+struct RemoteFrameHeader {
+    uint64_t frame;
+    int64_t timestamp;
+    uint32_t viewport_count;
+    uint32_t keyframe;
+};
 
-    void Begin() {
-        Widget::Begin();
-        ImGui::BulletText(GetLabel().c_str());
-    }
+// ÿӿڵбӿͷ֮
+struct RemoteViewportHeader {
+    uint32_t id;
+    uint32_t list_count;
+    float display_pos[2];
+    float display_size[2];
+    float framebuffer_scale[2];
+};
 
-    void End() {
-        Widget::End();
-    }
+// reuseΪ1ʱһ֡sourceб(ӿڵ˳)Я
+struct RemoteListHeader {
+    uint32_t reuse;
+    uint32_t source;
+    uint32_t cmd_count;
+    uint32_t vtx_count;
+    uint32_t idx_count;
+    uint32_t reserved;
 };
 
-class HelpMarker : public Widget {
-public:
-    HelpMarker(const std::string& title, const std::string& desc) : Widget(title), desc_(desc) {
-        
+// textureΪ0ʾͼ޷̴ݣ鿴˻
+struct RemoteCmd {
+    float clip_rect[4];
+    uint32_t texture;
+    uint32_t vtx_offset;
+    uint32_t idx_offset;
+    uint32_t elem_count;
+};
+
+struct RemoteAtlasHeader {
+    int32_t width;
+    int32_t height;
+};
+
+// ¼ļkRecordMagic
+static constexpr char kRemoteMagic[8] = { 'I', 'M', 'G', 'U', 'I', 'E', 'X', 'V' };
+static constexpr uint32_t kRemoteVersion = 2;
+
+static uint64_t GetRemoteBytes(uint64_t frame_capacity, uint64_t input_capacity) {
+    return sizeof(RemoteControl) + SharedRing::GetBytes(frame_capacity) + SharedRing::GetBytes(input_capacity);
+}
+} // namespace internal
+
+struct RemoteStats {
+    uint64_t frames;
+    uint64_t dropped_frames;
+    uint64_t keyframes;
+    uint64_t lists;
+    uint64_t reused_lists;
+    uint64_t bytes;
+    uint64_t max_frame_bytes;
+    // Ϊʱ鿴Ϊɵӳ٣λ
+    double total_time;
+    double max_time;
+};
+
+/*
+* Զ̽淢
+* ѭImGui::Render֮PublishѸӿڵImDrawDataбд빲ڴ棬ͼ仯ʱһ
+* һ֡ͬбֻãдʧ(鿴˸)ʱ֡һ֡ؼ֡
+* ѭImGui::NewFrame֮ǰPollInputѲ鿴˻ش¼ʾߴע뵱ǰ
+*/
+class RemotePublisher {
+public:
+    RemotePublisher() {
+        control_ = nullptr;
+        keyframe_interval_ = 0;
+        local_render_ = true;
+        frame_rate_ = 60.0;
+        next_frame_time_ = 0.0;
+        frame_ = 0;
+        last_keyframe_ = 0;
+        force_keyframe_ = true;
+        atlas_tex_id_ = (ImTextureID)0;
+        atlas_pixels_ = nullptr;
+        atlas_width_ = 0;
+        atlas_height_ = 0;
+        has_display_size_ = false;
+        stats_ = {};
     }
 
-    void Begin() {
-        Widget::Begin();
-        
-        ImGui::TextDisabled(GetLabel().c_str());
-        if (ImGui::BeginItemTooltip()) {
-            ImGui::PushTextWrapPos(ImGui::GetFontSize() * 35.0f);
-            ImGui::TextUnformatted(desc_.c_str());
-            ImGui::PopTextWrapPos();
-            ImGui::EndTooltip();
+    bool Create(const std::string& name, uint64_t frame_capacity = 32 << 20, uint64_t input_capacity = 256 << 10) {
+        frame_capacity = (frame_capacity + 7) & ~(uint64_t)7;
+        input_capacity = (input_capacity + 7) & ~(uint64_t)7;
+        if (!memory_.Create(name, internal::GetRemoteBytes(frame_capacity, input_capacity))) {
+            return false;
         }
+        char* base = memory_.GetData();
+        internal::RemoteControl* control = new (base) internal::RemoteControl();
+        memcpy(control->magic, internal::kRemoteMagic, sizeof(control->magic));
+        control->version = internal::kRemoteVersion;
+        control->frame_capacity = frame_capacity;
+        control->input_capacity = input_capacity;
+        control->resync.store(1);
+        control_ = control;
+        base += sizeof(internal::RemoteControl);
+        frame_ring_.Attach(base, frame_capacity, true);
+        input_ring_.Attach(base + internal::SharedRing::GetBytes(frame_capacity), input_capacity, true);
+        force_keyframe_ = true;
+        atlas_pixels_ = nullptr;
+        return true;
     }
 
-    void End() {
-        Widget::End();
+    void Close() {
+        memory_.Close();
+        control_ = nullptr;
     }
 
-private:
-    std::string desc_;
-};
-
-
-class CollapsingHeader : public Widget,
-                         public Expandable
-{
-public:
-    CollapsingHeader(const std::string& label) : Widget(label) {
-        
+    bool IsOpen() {
+        return memory_.GetData() != nullptr;
     }
 
-    void Begin() {
-        Widget::Begin();
-        expand_ = ImGui::CollapsingHeader(GetLabel().c_str());
+    // ÿinterval֡ǿƷ͹ؼ֡0ʾֻҪʱ
+    void SetKeyframeInterval(int interval) {
+        keyframe_interval_ = interval;
     }
 
-    void End() {
-        end_expand_ = expand_;
-        Widget::End();
+    // ΪfalseʱѭڱȾͳ
+    void SetLocalRender(bool local_render) {
+        local_render_ = local_render;
     }
 
-private:
-
-};
+    bool IsLocalRender() {
+        return local_render_;
+    }
 
-class TreeNode : public Widget,
-                 public Expandable
-{
-public:
-    TreeNode(const std::string& label) : Widget(label) {
-        end_expand_ = false;
-        expand_ = false;
+    // ڱسʱѭûдֱͬ٣Ϊ֡ʵWaitFrame
+    void SetFrameRate(double frame_rate) {
+        frame_rate_ = frame_rate;
     }
 
-    void Begin() {
-        Widget::Begin();
-        expand_ = ImGui::TreeNode(GetLabel().c_str());
+    // ȴһ֡ʱ㣬󳬹һ֡ʱ׷
+    void WaitFrame() {
+        SystemClock system;
+        Clock* clock = CurrentClock();
+        if (clock == nullptr) {
+            clock = &system;
+        }
+        double now = clock->Now();
+        if (next_frame_time_ > now) {
+            clock->Sleep(next_frame_time_ - now);
+            now = next_frame_time_;
+        }
+        next_frame_time_ = std::max(next_frame_time_, now) + (frame_rate_ > 0.0 ? 1.0 / frame_rate_ : 0.0);
     }
 
-    void End() {
-        if (expand_) {
-            ImGui::TreePop();
+    void PollInput() {
+        if (!IsOpen()) {
+            return;
+        }
+        ImGuiIO& io = ImGui::GetIO();
+        uint32_t type;
+        while (input_ring_.Read(&type, &message_)) {
+            if (type == internal::kRemoteInput && message_.size() == sizeof(internal::RecordEvent)) {
+                internal::RecordEvent event;
+                memcpy(&event, message_.data(), sizeof(event));
+                internal::DispatchRecordEvent(io, event);
+            }
+            else if (type == internal::kRemoteDisplaySize && message_.size() == sizeof(ImVec2)) {
+                memcpy(&display_size_, message_.data(), sizeof(ImVec2));
+                has_display_size_ = true;
+            }
+        }
+        if (has_display_size_) {
+            io.DisplaySize = display_size_;
         }
-        end_expand_ = expand_;
-        Widget::End();
     }
 
+    // ĬϷǰӿڣdraw_dataʱֻһ
+    void Publish(ImDrawData* draw_data = nullptr) {
+        if (!IsOpen()) {
+            return;
+        }
+        viewports_.clear();
+        if (draw_data != nullptr) {
+            if (draw_data->Valid) {
+                viewports_.emplace_back(0, draw_data);
+            }
+        }
+        else {
+            ImGuiPlatformIO& platform_io = ImGui::GetPlatformIO();
+            for (int i = 0; i < platform_io.Viewports.Size; i++) {
+                ImGuiViewport* viewport = platform_io.Viewports[i];
+                if (viewport->DrawData != nullptr && viewport->DrawData->Valid) {
+                    viewports_.emplace_back(viewport->ID, viewport->DrawData);
+                }
+            }
+        }
+        if (viewports_.empty()) {
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        if (control_->resync.exchange(0) != 0) {
+            force_keyframe_ = true;
+            atlas_pixels_ = nullptr;
+        }
+        frame_++;
+        bool keyframe = force_keyframe_ || (keyframe_interval_ > 0 && frame_ - last_keyframe_ >= (uint64_t)keyframe_interval_);
+        if (!PublishAtlas()) {
+            stats_.dropped_frames++;
+            force_keyframe_ = true;
+            return;
+        }
 
-    /*
-    * Event
-    */
-private:
-};
+        ImTextureID atlas = ImGui::GetIO().Fonts->TexID;
+        buffer_.clear();
+        internal::RemoteFrameHeader header = {};
+        header.frame = frame_;
+        header.timestamp = internal::RemoteTimestamp();
+        header.viewport_count = (uint32_t)viewports_.size();
+        header.keyframe = keyframe;
+        Append(&header, sizeof(header));
+
+        hashes_.clear();
+        uint64_t reused = 0;
+        for (auto& item : viewports_) {
+            ImDrawData* viewport_data = item.second;
+            internal::RemoteViewportHeader viewport = {};
+            viewport.id = item.first;
+            viewport.list_count = (uint32_t)viewport_data->CmdListsCount;
+            viewport.display_pos[0] = viewport_data->DisplayPos.x;
+            viewport.display_pos[1] = viewport_data->DisplayPos.y;
+            viewport.display_size[0] = viewport_data->DisplaySize.x;
+            viewport.display_size[1] = viewport_data->DisplaySize.y;
+            viewport.framebuffer_scale[0] = viewport_data->FramebufferScale.x;
+            viewport.framebuffer_scale[1] = viewport_data->FramebufferScale.y;
+            Append(&viewport, sizeof(viewport));
+            reused += AppendLists(viewport_data, keyframe, atlas);
+        }
 
-class CheckBox : public Widget {
-public:
-    CheckBox(const std::string& label, bool check = false) : Widget(label) {
-        end_check_ = false;
-        check_ = check;
+        if (!frame_ring_.Write(internal::kRemoteFrame, buffer_.data(), (uint32_t)buffer_.size())) {
+            // 鿴Ѿòһ֡Ϊ׼
+            stats_.dropped_frames++;
+            prev_hashes_.clear();
+            force_keyframe_ = true;
+            return;
+        }
+        prev_hashes_.clear();
+        for (size_t i = 0; i < hashes_.size(); i++) {
+            prev_hashes_.emplace(hashes_[i], (uint32_t)i);
+        }
+        if (keyframe) {
+            stats_.keyframes++;
+            last_keyframe_ = frame_;
+            force_keyframe_ = false;
+        }
+        stats_.frames++;
+        stats_.lists += hashes_.size();
+        stats_.reused_lists += reused;
+        stats_.bytes += buffer_.size();
+        stats_.max_frame_bytes = std::max<uint64_t>(stats_.max_frame_bytes, buffer_.size());
+        double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats_.total_time += time;
+        stats_.max_time = std::max(stats_.max_time, time);
     }
 
-    void Begin() {
-        Widget::Begin();
-        ImGui::Checkbox(GetLabel().c_str(), &check_);
+    const RemoteStats& GetStats() {
+        return stats_;
     }
 
-    void End() {
-        end_check_ = check_;
-        Widget::End();
+    void ResetStats() {
+        stats_ = {};
     }
 
-
-    /*
-    * Event
-    */
-    void CheckEvent(std::function<void()> event) {
-        if (end_check_ == false && check_ == true) {
-            event();
-        }
+private:
+    void Append(const void* data, size_t size) {
+        const char* bytes = (const char*)data;
+        buffer_.insert(buffer_.end(), bytes, bytes + size);
     }
 
-    void UncheckEvent(std::function<void()> event) {
-        if (end_check_ == true && check_ == false) {
-            event();
+    // ظõб
+    uint64_t AppendLists(ImDrawData* draw_data, bool keyframe, ImTextureID atlas) {
+        uint64_t reused = 0;
+        for (int i = 0; i < draw_data->CmdListsCount; i++) {
+            const ImDrawList* draw_list = draw_data->CmdLists[i];
+            uint64_t hash = internal::HashBytes64(draw_list->CmdBuffer.Data, draw_list->CmdBuffer.size_in_bytes(), 0);
+            hash = internal::HashBytes64(draw_list->VtxBuffer.Data, draw_list->VtxBuffer.size_in_bytes(), hash);
+            hash = internal::HashBytes64(draw_list->IdxBuffer.Data, draw_list->IdxBuffer.size_in_bytes(), hash);
+            hashes_.push_back(hash);
+
+            internal::RemoteListHeader list = {};
+            auto iter = keyframe ? prev_hashes_.end() : prev_hashes_.find(hash);
+            if (iter != prev_hashes_.end()) {
+                list.reuse = 1;
+                list.source = iter->second;
+                Append(&list, sizeof(list));
+                reused++;
+                continue;
+            }
+            size_t list_offset = buffer_.size();
+            Append(&list, sizeof(list));
+            uint32_t cmd_count = 0;
+            for (int j = 0; j < draw_list->CmdBuffer.Size; j++) {
+                const ImDrawCmd& cmd = draw_list->CmdBuffer[j];
+                if (cmd.UserCallback != nullptr || cmd.ElemCount == 0) {
+                    continue;
+                }
+                internal::RemoteCmd remote;
+                remote.clip_rect[0] = cmd.ClipRect.x;
+                remote.clip_rect[1] = cmd.ClipRect.y;
+                remote.clip_rect[2] = cmd.ClipRect.z;
+                remote.clip_rect[3] = cmd.ClipRect.w;
+                remote.texture = cmd.GetTexID() == atlas ? 0 : 1;
+                remote.vtx_offset = cmd.VtxOffset;
+                remote.idx_offset = cmd.IdxOffset;
+                remote.elem_count = cmd.ElemCount;
+                Append(&remote, sizeof(remote));
+                cmd_count++;
+            }
+            Append(draw_list->VtxBuffer.Data, draw_list->VtxBuffer.size_in_bytes());
+            Append(draw_list->IdxBuffer.Data, draw_list->IdxBuffer.size_in_bytes());
+            list.cmd_count = cmd_count;
+            list.vtx_count = (uint32_t)draw_list->VtxBuffer.Size;
+            list.idx_count = (uint32_t)draw_list->IdxBuffer.Size;
+            memcpy(buffer_.data() + list_offset, &list, sizeof(list));
         }
+        return reused;
     }
 
-    /*
-    * Control
-    */
-    void SetCheck(bool check) {
-        check_ = check;
+    bool PublishAtlas() {
+        ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+        unsigned char* pixels;
+        int width, height;
+        atlas->GetTexDataAsRGBA32(&pixels, &width, &height);
+        if (pixels == atlas_pixels_ && width == atlas_width_ && height == atlas_height_ && atlas->TexID == atlas_tex_id_) {
+            return true;
+        }
+        std::vector<char> message(sizeof(internal::RemoteAtlasHeader) + (size_t)width * height * 4);
+        internal::RemoteAtlasHeader header = { width, height };
+        memcpy(message.data(), &header, sizeof(header));
+        memcpy(message.data() + sizeof(header), pixels, (size_t)width * height * 4);
+        if (!frame_ring_.Write(internal::kRemoteAtlas, message.data(), (uint32_t)message.size())) {
+            return false;
+        }
+        atlas_pixels_ = pixels;
+        atlas_width_ = width;
+        atlas_height_ = height;
+        atlas_tex_id_ = atlas->TexID;
+        stats_.bytes += message.size();
+        return true;
     }
 
 private:
-    bool end_check_;
-    bool check_;
+    internal::SharedMemory memory_;
+    internal::RemoteControl* control_;
+    internal::SharedRing frame_ring_;
+    internal::SharedRing input_ring_;
+
+    int keyframe_interval_;
+    bool local_render_;
+    double frame_rate_;
+    double next_frame_time_;
+    uint64_t frame_;
+    uint64_t last_keyframe_;
+    bool force_keyframe_;
+
+    ImTextureID atlas_tex_id_;
+    unsigned char* atlas_pixels_;
+    int atlas_width_;
+    int atlas_height_;
+
+    ImVec2 display_size_;
+    bool has_display_size_;
+
+    std::vector<std::pair<ImGuiID, ImDrawData*>> viewports_;
+    std::vector<char> buffer_;
+    std::vector<char> message_;
+    std::vector<uint64_t> hashes_;
+    std::unordered_map<uint64_t, uint32_t> prev_hashes_;
+
+    RemoteStats stats_;
 };
 
-template<class Element = std::string>
-class ListBox : public Widget {
-public:
-    ListBox(const std::string& label) : Widget(label), size_(-FLT_MIN, -FLT_MIN) {
-        entry_ = false;
-        end_select_index_ = -1;
-        select_index_ = -1;
-    }
+inline RemotePublisher*& CurrentRemotePublisher() {
+    static thread_local RemotePublisher* publisher = nullptr;
+    return publisher;
+}
 
-    void Begin() {
-        Widget::Begin();
-        entry_ = ImGui::BeginListBox(GetLabel().c_str(), size_);
+static void SetRemotePublisher(RemotePublisher* publisher) {
+    CurrentRemotePublisher() = publisher;
+}
+
+/*
+* Զ̽鿴
+* Poll빲ڴе֡GetDrawDataؿֱӽȾ˵ImDrawDataÿӿһDisplayPosΪӿϵλ
+* ͼر仯ʱGetAtlasVersion鿴ϴͨSetAtlasTextureID
+*/
+class RemoteViewer {
+public:
+    RemoteViewer() {
+        control_ = nullptr;
+        atlas_texture_ = (ImTextureID)0;
+        atlas_width_ = 0;
+        atlas_height_ = 0;
+        atlas_version_ = 0;
+        last_frame_ = 0;
+        synced_ = false;
+        last_event_id_ = 0;
+        stats_ = {};
     }
 
-    void End() {
-        if (entry_) {
-            ImGui::EndListBox();
+    bool Open(const std::string& name) {
+        Close();
+        if (!memory_.Open(name, sizeof(internal::RemoteControl))) {
+            return false;
         }
-        Widget::End();
+        internal::RemoteControl* control = (internal::RemoteControl*)memory_.GetData();
+        if (memcmp(control->magic, internal::kRemoteMagic, sizeof(control->magic)) != 0 || control->version != internal::kRemoteVersion) {
+            memory_.Close();
+            return false;
+        }
+        uint64_t frame_capacity = control->frame_capacity;
+        uint64_t input_capacity = control->input_capacity;
+        if (!memory_.Open(name, internal::GetRemoteBytes(frame_capacity, input_capacity))) {
+            return false;
+        }
+        char* base = memory_.GetData();
+        control_ = (internal::RemoteControl*)base;
+        base += sizeof(internal::RemoteControl);
+        frame_ring_.Attach(base, frame_capacity, false);
+        input_ring_.Attach(base + internal::SharedRing::GetBytes(frame_capacity), input_capacity, false);
+        synced_ = false;
+        control_->resync.store(1);
+        return true;
     }
 
-    /*
-    * Update
-    */
-    void InsertUpdate(std::function<std::string(Element&)> insert) {
-        for (int i = 0; i < list_.size(); i++) {
-            const bool is_selected = (select_index_ == i);
-            auto temp = insert(list_[i]);
+    void Close() {
+        memory_.Close();
+        control_ = nullptr;
+        lists_.clear();
+        viewports_.clear();
+        viewport_ids_.clear();
+    }
 
-            if (temp.empty()) {
-                continue;
-            }
+    bool IsOpen() {
+        return control_ != nullptr;
+    }
 
-            if (ImGui::Selectable(temp.c_str(), is_selected)) {
-                select_index_ = i;
+    // Ƿ֡
+    bool Poll() {
+        if (!IsOpen()) {
+            return false;
+        }
+        bool updated = false;
+        uint32_t type;
+        while (frame_ring_.Read(&type, &message_)) {
+            if (type == internal::kRemoteAtlas) {
+                ReadAtlas();
             }
-
-            if (is_selected) {
-                ImGui::SetItemDefaultFocus();
+            else if (type == internal::kRemoteFrame) {
+                updated |= ReadFrame();
             }
         }
+        return updated;
     }
 
-    /*
-    * Event
-    */
-    void SelectEvent(std::function<void()> event) {
-        if (end_select_index_ != select_index_) {
-            event();
-        }
+    // 0Ϊӿ
+    ImDrawData* GetDrawData(int index = 0) {
+        return index >= 0 && index < (int)viewports_.size() ? &viewports_[index] : nullptr;
     }
 
-    /*
-    * Control
-    */
-    Element& GetSelectItem() {
-        return list_.at(select_index_);
+    int GetViewportCount() {
+        return (int)viewports_.size();
     }
 
-    int GetSelectIndex() {
-        return select_index_;
+    // ӿڵImGuiIDڲ鿴˶Ӧٴ
+    ImGuiID GetViewportId(int index) {
+        return viewport_ids_[index];
     }
 
-    int SetSelectIndex(int select_index) {
-        select_index_ = select_index;
+    const std::vector<unsigned char>& GetAtlasPixels() {
+        return atlas_pixels_;
     }
 
-    void SetSize(const ImVec2& size) {
-        size_ = size;
+    int GetAtlasWidth() {
+        return atlas_width_;
     }
 
-    ImVec2& GetSize() {
-        return size_;
+    int GetAtlasHeight() {
+        return atlas_height_;
     }
 
-    void SetList(std::vector<Element>&& list) {
-        list_ = std::move(list);
+    uint64_t GetAtlasVersion() {
+        return atlas_version_;
     }
 
-    std::vector<Element>& GetList() {
-        return list_;
+    void SetAtlasTexture(ImTextureID texture) {
+        atlas_texture_ = texture;
+        for (auto& list : lists_) {
+            for (int i = 0; i < list->CmdBuffer.Size; i++) {
+                list->CmdBuffer[i].TextureId = texture;
+            }
+        }
     }
 
-    void ClearList() {
-        list_.clear();
+    bool PostEvent(const internal::RecordEvent& event) {
+        if (!IsOpen()) {
+            return false;
+        }
+        return input_ring_.Write(internal::kRemoteInput, &event, sizeof(event));
     }
 
-private:
-    std::vector<Element> list_;
-
-    ImVec2 size_;
+    bool PostDisplaySize(const ImVec2& size) {
+        if (!IsOpen()) {
+            return false;
+        }
+        return input_ring_.Write(internal::kRemoteDisplaySize, &size, sizeof(size));
+    }
 
-    bool entry_;
+    // ת鿴ImGuiı֡¼ڲ鿴˺NewFrame֮
+    void ForwardInput() {
+        ImGuiContext& g = *GImGui;
+        for (int i = 0; i < g.InputEventsQueue.Size; i++) {
+            const ImGuiInputEvent& event = g.InputEventsQueue[i];
+            if (event.EventId <= last_event_id_) {
+                continue;
+            }
+            last_event_id_ = event.EventId;
+            internal::RecordEvent record;
+            if (internal::ToRecordEvent(event, &record)) {
+                PostEvent(record);
+            }
+        }
+    }
 
-    int end_select_index_;
-    int select_index_;
-};
+    const RemoteStats& GetStats() {
+        return stats_;
+    }
 
-class RadioButtonGroup : public Widget {
-public:
-    RadioButtonGroup(std::vector<std::string> label_list) : Widget(""), label_list_(label_list){
-        push_index_ = 0;
-        select_index_ = 0;
-        end_select_index_ = 0;
+    void ResetStats() {
+        stats_ = {};
     }
 
-    void Begin(std::function<void(size_t)> push) {
-        Widget::Begin();
-        push_index_ = 0;
-        for (size_t i = 0; i < label_list_.size(); i++) {
-            ImGui::RadioButton(label_list_[i].c_str(), &select_index_, push_index_++);
-            push(i);
+private:
+    void ReadAtlas() {
+        internal::RemoteAtlasHeader header;
+        if (message_.size() < sizeof(header)) {
+            return;
         }
+        memcpy(&header, message_.data(), sizeof(header));
+        atlas_width_ = header.width;
+        atlas_height_ = header.height;
+        atlas_pixels_.assign(message_.begin() + sizeof(header), message_.end());
+        atlas_version_++;
+        stats_.bytes += message_.size();
     }
 
-    void Begin() {
-        Begin([](size_t i) {});
+    bool ReadFrame() {
+        const char* cur = message_.data();
+        const char* end = cur + message_.size();
+        internal::RemoteFrameHeader header;
+        if (!Take(&cur, end, &header, sizeof(header))) {
+            return false;
+        }
+        if (!header.keyframe && (!synced_ || header.frame != last_frame_ + 1)) {
+            // ȱٲ׼ȴؼ֡
+            if (synced_) {
+                stats_.dropped_frames++;
+            }
+            synced_ = false;
+            control_->resync.store(1);
+            return false;
+        }
+
+        next_.clear();
+        next_viewports_.clear();
+        for (uint32_t v = 0; v < header.viewport_count; v++) {
+            internal::RemoteViewportHeader viewport;
+            if (!Take(&cur, end, &viewport, sizeof(viewport))) {
+                return Desync();
+            }
+            next_viewports_.push_back(viewport);
+            if (!ReadLists(&cur, end, viewport.list_count)) {
+                return Desync();
+            }
+        }
+        moved_.clear();
+        lists_.swap(next_);
+        next_.clear();
+
+        viewports_.resize(next_viewports_.size());
+        viewport_ids_.resize(next_viewports_.size());
+        size_t first = 0;
+        for (size_t v = 0; v < next_viewports_.size(); v++) {
+            const internal::RemoteViewportHeader& viewport = next_viewports_[v];
+            ImDrawData& draw_data = viewports_[v];
+            draw_data = ImDrawData();
+            draw_data.Valid = true;
+            draw_data.DisplayPos = ImVec2(viewport.display_pos[0], viewport.display_pos[1]);
+            draw_data.DisplaySize = ImVec2(viewport.display_size[0], viewport.display_size[1]);
+            draw_data.FramebufferScale = ImVec2(viewport.framebuffer_scale[0], viewport.framebuffer_scale[1]);
+            for (size_t i = first; i < first + viewport.list_count; i++) {
+                ImDrawList* list = lists_[i].get();
+                draw_data.CmdLists.push_back(list);
+                draw_data.TotalVtxCount += list->VtxBuffer.Size;
+                draw_data.TotalIdxCount += list->IdxBuffer.Size;
+            }
+            draw_data.CmdListsCount = draw_data.CmdLists.Size;
+            viewport_ids_[v] = viewport.id;
+            first += viewport.list_count;
+        }
+
+        synced_ = true;
+        last_frame_ = header.frame;
+        stats_.frames++;
+        stats_.keyframes += header.keyframe;
+        stats_.lists += lists_.size();
+        stats_.bytes += message_.size();
+        stats_.max_frame_bytes = std::max<uint64_t>(stats_.max_frame_bytes, message_.size());
+        double latency = (internal::RemoteTimestamp() - header.timestamp) / 1e9;
+        stats_.total_time += latency;
+        stats_.max_time = std::max(stats_.max_time, latency);
+        return true;
     }
 
-    void End() {
-        end_select_index_ = select_index_;
-        Widget::End();
+    // countб׷ӵnext_ʧʱɵDesync
+    bool ReadLists(const char** cur, const char* end, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++) {
+            internal::RemoteListHeader list;
+            if (!Take(cur, end, &list, sizeof(list))) {
+                return false;
+            }
+            if (list.reuse) {
+                if (list.source >= lists_.size()) {
+                    return false;
+                }
+                if (lists_[list.source]) {
+                    next_.push_back(std::move(lists_[list.source]));
+                }
+                else {
+                    // ͬһԴбöΣѾƳĸи
+                    const ImDrawList* source = FindMoved(list.source);
+                    if (source == nullptr) {
+                        return false;
+                    }
+                    std::unique_ptr<ImDrawList> copy(new ImDrawList(nullptr));
+                    copy->CmdBuffer = source->CmdBuffer;
+                    copy->VtxBuffer = source->VtxBuffer;
+                    copy->IdxBuffer = source->IdxBuffer;
+                    next_.push_back(std::move(copy));
+                }
+                moved_.push_back(std::make_pair(list.source, next_.back().get()));
+                stats_.reused_lists++;
+                continue;
+            }
+            std::unique_ptr<ImDrawList> draw_list(new ImDrawList(nullptr));
+            draw_list->CmdBuffer.resize(list.cmd_count);
+            for (uint32_t j = 0; j < list.cmd_count; j++) {
+                internal::RemoteCmd remote;
+                if (!Take(cur, end, &remote, sizeof(remote))) {
+                    return false;
+                }
+                ImDrawCmd& cmd = draw_list->CmdBuffer[j];
+                cmd = ImDrawCmd();
+                cmd.ClipRect = ImVec4(remote.clip_rect[0], remote.clip_rect[1], remote.clip_rect[2], remote.clip_rect[3]);
+                cmd.TextureId = atlas_texture_;
+                cmd.VtxOffset = remote.vtx_offset;
+                cmd.IdxOffset = remote.idx_offset;
+                // ͼ޷ڲ鿴ʹ
+                cmd.ElemCount = remote.texture == 0 ? remote.elem_count : 0;
+            }
+            draw_list->VtxBuffer.resize(list.vtx_count);
+            draw_list->IdxBuffer.resize(list.idx_count);
+            if (!Take(cur, end, draw_list->VtxBuffer.Data, draw_list->VtxBuffer.size_in_bytes()) ||
+                !Take(cur, end, draw_list->IdxBuffer.Data, draw_list->IdxBuffer.size_in_bytes())) {
+                return false;
+            }
+            next_.push_back(std::move(draw_list));
+        }
+        return true;
     }
 
+    static bool Take(const char** cur, const char* end, void* out, size_t size) {
+        if ((size_t)(end - *cur) < size) {
+            return false;
+        }
+        if (size > 0) {
+            memcpy(out, *cur, size);
+        }
+        *cur += size;
+        return true;
+    }
 
-    void SelectEvent(std::function<void()> event) {
-        if (end_select_index_ != select_index_) {
-            event();
+    const ImDrawList* FindMoved(uint32_t source) {
+        for (auto& item : moved_) {
+            if (item.first == source) {
+                return item.second;
+            }
         }
+        return nullptr;
+    }
+
+    bool Desync() {
+        // ƳбѾǰȴؼ֡
+        moved_.clear();
+        next_.clear();
+        lists_.clear();
+        viewports_.clear();
+        viewport_ids_.clear();
+        synced_ = false;
+        control_->resync.store(1);
+        stats_.dropped_frames++;
+        return false;
     }
 
 private:
-    std::vector<std::string> label_list_;
+    internal::SharedMemory memory_;
+    internal::RemoteControl* control_;
+    internal::SharedRing frame_ring_;
+    internal::SharedRing input_ring_;
+
+    std::vector<char> message_;
+    std::vector<std::unique_ptr<ImDrawList>> lists_;
+    std::vector<std::unique_ptr<ImDrawList>> next_;
+    std::vector<std::pair<uint32_t, const ImDrawList*>> moved_;
+    std::vector<internal::RemoteViewportHeader> next_viewports_;
+    std::vector<ImDrawData> viewports_;
+    std::vector<ImGuiID> viewport_ids_;
+
+    ImTextureID atlas_texture_;
+    std::vector<unsigned char> atlas_pixels_;
+    int atlas_width_;
+    int atlas_height_;
+    uint64_t atlas_version_;
+
+    uint64_t last_frame_;
+    bool synced_;
+    unsigned int last_event_id_;
+
+    RemoteStats stats_;
+};
 
-    int push_index_;
-    int end_select_index_;
-    int select_index_;
+struct RemoteBenchmarkCase {
+    // ˱ʱ鿴˴ӷɵӳ٣λ
+    double encode_ms;
+    double max_encode_ms;
+    double latency_ms;
+    double max_latency_ms;
+    double bytes_per_frame;
+    // ϼƵ
+    double megabytes_per_second;
+    uint64_t dropped_frames;
+};
+
+struct RemoteBenchmark {
+    // 󲿷бһֻ֡ͬһı仯
+    RemoteBenchmarkCase typical;
+    // ÿ֡ǹؼ֡еı仯
+    RemoteBenchmarkCase worst_case;
 };
 
+/*
+* ͬһͨΪnameĹڴRemotePublisherRemoteViewerHeadlessContextÿ֡row_countıframe_count֡
+* ֱıʱӳٺ
+*/
+static RemoteBenchmark BenchmarkRemote(int row_count, int frame_count, const std::string& name = "imgui_ex_remote_benchmark") {
+    ImFontAtlas atlas;
+    atlas.AddFontDefault();
+    unsigned char* pixels;
+    int width, height;
+    atlas.GetTexDataAsRGBA32(&pixels, &width, &height);
+    atlas.SetTexID((ImTextureID)(intptr_t)1);
+
+    auto run = [&](bool worst_case) {
+        RemoteBenchmarkCase result = {};
+        HeadlessContext context(&atlas);
+        RemotePublisher publisher;
+        RemoteViewer viewer;
+        if (!publisher.Create(name) || !viewer.Open(name)) {
+            return result;
+        }
+        publisher.SetKeyframeInterval(worst_case ? 1 : 0);
+        std::chrono::steady_clock::duration transfer{};
+        for (int frame = 0; frame < frame_count; frame++) {
+            ImDrawData* draw_data = context.Frame([&]() {
+                ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f), ImGuiCond_Always);
+                ImGui::SetNextWindowSize(ImVec2(1280.0f, 800.0f), ImGuiCond_Always);
+                ImGui::Begin("Remote");
+                ImGui::Text("frame %d", frame);
+                ImGui::End();
+                ImGui::Begin("Rows");
+                for (int row = 0; row < row_count; row++) {
+                    ImGui::Text("row %d value %d", row, worst_case ? frame + row : row);
+                }
+                ImGui::End();
+            });
+            auto start = std::chrono::steady_clock::now();
+            publisher.Publish(draw_data);
+            viewer.Poll();
+            transfer += std::chrono::steady_clock::now() - start;
+        }
+        double seconds = std::chrono::duration<double>(transfer).count();
+        const RemoteStats& sent = publisher.GetStats();
+        const RemoteStats& received = viewer.GetStats();
+        if (sent.frames > 0) {
+            result.encode_ms = sent.total_time * 1000.0 / sent.frames;
+            result.bytes_per_frame = (double)sent.bytes / sent.frames;
+        }
+        if (received.frames > 0) {
+            result.latency_ms = received.total_time * 1000.0 / received.frames;
+        }
+        result.max_encode_ms = sent.max_time * 1000.0;
+        result.max_latency_ms = received.max_time * 1000.0;
+        result.megabytes_per_second = seconds > 0.0 ? (double)sent.bytes / seconds / (1024.0 * 1024.0) : 0.0;
+        result.dropped_frames = sent.dropped_frames + received.dropped_frames;
+        return result;
+    };
+
+    RemoteBenchmark result;
+    result.typical = run(false);
+    result.worst_case = run(true);
+    return result;
+}
+
 
 namespace layout {
     static void Indent() {